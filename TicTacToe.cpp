@@ -27,7 +27,7 @@
  * @param parent The parent widget.
  */
 TicTacToe::TicTacToe(QString gameMode, QString difficulty, int gridSize, QWidget *parent)
-    : QMainWindow(parent), gameMode(gameMode), difficulty(difficulty), gridSize(gridSize), isHumanTurn(true) {
+    : QMainWindow(parent), gameMode(gameMode), difficulty(difficulty), gridSize(gridSize), isHumanTurn(true), board(gridSize) {
     tictactoesound = new QMediaPlayer;
     audioOutput = new QAudioOutput;
     tictactoesound->setAudioOutput(audioOutput);
@@ -50,7 +50,6 @@ TicTacToe::TicTacToe(QString gameMode, QString difficulty, int gridSize, QWidget
     QGridLayout* layout = new QGridLayout(centralWidget);
     layout->setSpacing(10);
 
-    board.resize(gridSize, std::vector<char>(gridSize, Player::NONE));
     buttons.resize(gridSize, std::vector<QPushButton*>(gridSize));
 
     for (int i = 0; i < gridSize; ++i) {
@@ -223,7 +222,7 @@ void TicTacToe::updateWinLose() {
  */
 void TicTacToe::buttonClicked(int x, int y) {
     buttonSoundEffect->play();
-    if (board[x][y] != Player::NONE) return;
+    if (!board.isEmpty(x, y)) return;
 
     QString playerSymbol;
     QString colorStyle;
@@ -234,7 +233,7 @@ void TicTacToe::buttonClicked(int x, int y) {
         playerSymbol = isHumanTurn ? "X" : "O";
         colorStyle = isHumanTurn ? "color: blue;" : "color: red;";
 
-        board[x][y] = isHumanTurn ? Player::HUMAN : Player::Machine;
+        board.place(x, y, isHumanTurn ? Player::HUMAN : Player::Machine);
         buttons[x][y]->setStyleSheet(colorStyle + QString(" font-size: %1pt;").arg(fontSize));
         buttons[x][y]->setText(playerSymbol);
         buttons[x][y]->setDisabled(true);
@@ -256,7 +255,7 @@ void TicTacToe::buttonClicked(int x, int y) {
     } else {
         playerSymbol = "X";
         colorStyle = "color: blue;";
-        board[x][y] = Player::HUMAN;
+        board.place(x, y, Player::HUMAN);
         buttons[x][y]->setStyleSheet(colorStyle + QString(" font-size: %1pt;").arg(fontSize));
         buttons[x][y]->setText(playerSymbol);
         buttons[x][y]->setDisabled(true);
@@ -286,12 +285,12 @@ void TicTacToe::buttonClicked(int x, int y) {
  */
 void TicTacToe::playTheBest() {
     int fontSize = static_cast<int>(buttons[0][0]->height() * 0.8 / 1.33);
-    if (difficulty == "Easy" || gridSize >3) {
+    if (difficulty == "Easy") {
         // Make a random or less optimal move
         std::vector<std::pair<int, int>> availableMoves;
         for (int i = 0; i < gridSize; ++i) {
             for (int j = 0; j < gridSize; ++j) {
-                if (board[i][j] == Player::NONE) {
+                if (board.isEmpty(i, j)) {
                     availableMoves.push_back({i, j});
                 }
             }
@@ -302,38 +301,24 @@ void TicTacToe::playTheBest() {
             buttonSoundEffect->play();
             int moveIndex = rand() % availableMoves.size();
             auto [row, col] = availableMoves[moveIndex];
-            board[row][col] = Player::Machine;
+            board.place(row, col, Player::Machine);
             buttons[row][col]->setText("O");
             QString colorStyle = "color: red;";
             buttons[row][col]->setStyleSheet(colorStyle + QString(" font-size: %1pt;").arg(fontSize));
             buttons[row][col]->setDisabled(true);
         }
         statusLabel->setText("Player X's turn");
-    } else if (difficulty == "Hard" && gridSize <4) {
-        // Use miniMax algorithm to find the best move
-        int bestScore = INT_MIN;
-        std::pair<int, int> bestMove(-1, -1);
-
-        for (int i = 0; i < gridSize; ++i) {
-            for (int j = 0; j < gridSize; ++j) {
-                if (board[i][j] == Player::NONE) {
-                    board[i][j] = Player::Machine;
-                    int score = miniMax(board, 0, false); // Assuming false means it's the AI's turn in your implementation
-                    board[i][j] = Player::NONE;
-                    if (score > bestScore) {
-                        bestScore = score;
-                        bestMove = {i, j};
-                    }
-                }
-            }
-        }
-
-        if (bestMove.first != -1) {
-            board[bestMove.first][bestMove.second] = Player::Machine;
-            buttons[bestMove.first][bestMove.second]->setText("O");
-            buttons[bestMove.first][bestMove.second]->setDisabled(true);
+    } else {
+        // Search for the best move, the fastest win or the slowest loss, within the time budget
+        int cell = search.bestMove(board, Player::Machine);
+        if (cell >= 0) {
+            int row = cell / TicTacToeBoard::MaxSize;
+            int col = cell % TicTacToeBoard::MaxSize;
+            board.place(row, col, Player::Machine);
+            buttons[row][col]->setText("O");
+            buttons[row][col]->setDisabled(true);
             QString colorStyle = "color: red;";
-            buttons[bestMove.first][bestMove.second]->setStyleSheet(colorStyle + QString(" font-size: %1pt;").arg(fontSize));
+            buttons[row][col]->setStyleSheet(colorStyle + QString(" font-size: %1pt;").arg(fontSize));
         }
         buttonSoundEffect->play();
         statusLabel->setText("Player X's turn");
@@ -355,64 +340,14 @@ void TicTacToe::playTheBest() {
     }
 }
 
-/**
- * @brief Implements the minimax algorithm to determine the best move for the machine.
- * @param gameBoard The current state of the game board.
- * @param depth The current depth of the recursion.
- * @param isMachine Flag indicating if it's the machine's turn.
- * @return The score of the board configuration.
- */
-int TicTacToe::miniMax(std::vector<std::vector<char>> gameBoard,
-                       int depth,
-                       bool isMachine) const
-{
-    int topScore  {0};
-    int bestScore {0};
-    if (isGameOver(gameBoard))
-        return (int) calculateScore(gameBoard);
-
-    bestScore = (isMachine) ? INT_MIN : INT_MAX;
-    for(auto &row: gameBoard)
-        for(char &item: row)
-            if (item == Player::NONE) {
-                item = (isMachine) ? Player::Machine : Player::HUMAN;
-                topScore = miniMax(gameBoard, depth + 1, !isMachine);
-                item = Player::NONE;
-                bestScore = (isMachine)                        ?
-                                std::max(topScore, bestScore) :
-                                std::min(topScore, bestScore) ;
-            }
-    return bestScore;
-}
-
-/**
- * @brief Calculates the score for the current game board.
- * @param gameBoard The game board to evaluate.
- * @return The state of the game from the human player's perspective (win, lose, tie).
- */
-HumanState TicTacToe::calculateScore(std::vector<std::vector<char>> gameBoard) const
-{
-    return (checkWin(Player::HUMAN, gameBoard)) ?
-               HumanState::WIN                      :
-               (checkWin(Player::Machine, gameBoard))?
-                   HumanState::LOSE                     :
-                   HumanState::TIE                      ;
-}
-
 /**
  * @brief Checks if the game is over based on the current board state.
  * @param gameBoard The current game board.
  * @return True if the game is over, otherwise false.
  */
-bool TicTacToe::isGameOver(std::vector<std::vector<char>> gameBoard) const
+bool TicTacToe::isGameOver(const TicTacToeBoard &gameBoard) const
 {
-    if (checkWin(Player::HUMAN, gameBoard) || checkWin(Player::Machine, gameBoard)) return true;
-    for (const auto &row : gameBoard) {
-        for (char cell : row) {
-            if (cell == Player::NONE) return false; // Game is not over if any cell is empty
-        }
-    }
-    return true; // No empty cells, game is over
+    return gameBoard.isGameOver();
 }
 
 /**
@@ -421,52 +356,8 @@ bool TicTacToe::isGameOver(std::vector<std::vector<char>> gameBoard) const
  * @param gameBoard The game board to check.
  * @return True if the specified player has won, otherwise false.
  */
-bool TicTacToe::checkWin(Player player, const std::vector<std::vector<char>>& gameBoard) const {
-    char symbol = static_cast<char>(player);
-    bool win;
-
-    // Check rows and columns
-    for (int i = 0; i < gridSize; ++i) {
-        win = true;
-        for (int j = 0; j < gridSize; ++j) {
-            if (gameBoard[i][j] != symbol) {
-                win = false;
-                break;
-            }
-        }
-        if (win) return true; // Winner found in a row
-
-        win = true;
-        for (int j = 0; j < gridSize; ++j) {
-            if (gameBoard[j][i] != symbol) {
-                win = false;
-                break;
-            }
-        }
-        if (win) return true; // Winner found in a column
-    }
-
-    // Check main diagonal (\)
-    win = true;
-    for (int i = 0; i < gridSize; ++i) {
-        if (gameBoard[i][i] != symbol) {
-            win = false;
-            break;
-        }
-    }
-    if (win) return true;
-
-    // Check secondary diagonal (/)
-    win = true;
-    for (int i = 0; i < gridSize; ++i) {
-        if (gameBoard[i][gridSize - 1 - i] != symbol) {
-            win = false;
-            break;
-        }
-    }
-    if (win) return true;
-
-    return false; // No winner found
+bool TicTacToe::checkWin(Player player, const TicTacToeBoard &gameBoard) const {
+    return gameBoard.checkWin(player);
 }
 
 /**
@@ -505,9 +396,9 @@ void TicTacToe::on_actionNew_Game_triggered(){
     updateWinLose();
     statusLabel->setText("Player X's turn");
     // Reset the game to its initial state, considering gridSize and gameMode
+    board.reset();
     for (int i = 0; i < gridSize; ++i) {
         for (int j = 0; j < gridSize; ++j) {
-            board[i][j] = Player::NONE;
             buttons[i][j]->setText(" ");
             buttons[i][j]->setEnabled(true);
         }
@@ -534,50 +425,17 @@ void TicTacToe::on_actionExit_triggered(){
  */
 void TicTacToe::on_actionGet_Hint_triggered() {
     buttonSoundEffect->play();
-    if (gridSize == 3) {
-        // gridSize is 3, use the miniMax function to find the best move
-        int bestScore = INT_MIN;
-        std::pair<int, int> bestMove(-1, -1);
-
-        for (int i = 0; i < gridSize; ++i) {
-            for (int j = 0; j < gridSize; ++j) {
-                if (board[i][j] == Player::NONE) {
-                    board[i][j] = Player::HUMAN;
-                    int score = miniMax(board, 0, false); // Assuming false is for the machine's turn
-                    board[i][j] = Player::NONE;
-                    if (score > bestScore) {
-                        bestScore = score;
-                        bestMove = {i, j};
-                    }
-                }
-            }
-        }
-
-        // Highlight the best move found by miniMax
-        if (bestMove.first != -1) {
-            buttons[bestMove.first][bestMove.second]->setStyleSheet("background-color: yellow;");
-            buttons[bestMove.first][bestMove.second]->setDisabled(true);
-            QTimer::singleShot(300, [this, bestMove]() { buttons[bestMove.first][bestMove.second]->setStyleSheet(""); buttons[bestMove.first][bestMove.second]->setDisabled(false); });
-        }
-    } else {
-        // gridSize is larger than 3, make a random or less optimal move
-        std::vector<std::pair<int, int>> availableMoves;
-        for (int i = 0; i < gridSize; ++i) {
-            for (int j = 0; j < gridSize; ++j) {
-                if (board[i][j] == Player::NONE) {
-                    availableMoves.push_back({i, j});
-                }
-            }
-        }
-
-        if (!availableMoves.empty()) {
-            int moveIndex = rand() % availableMoves.size();
-            auto [row, col] = availableMoves[moveIndex];
-            // Highlight the selected move
-            buttons[row][col]->setStyleSheet("background-color: yellow;");
-            buttons[row][col]->setDisabled(true);
-            QTimer::singleShot(300, [this, row, col]() { buttons[row][col]->setStyleSheet(""); buttons[row][col]->setDisabled(false); });
-        }
+    // In Player vs Player the hint is for whoever's turn it is
+    Player player = (gameMode == "PVP" && !isHumanTurn) ? Player::Machine : Player::HUMAN;
+    int cell = search.bestMove(board, player);
+
+    // Highlight the best move found by the search
+    if (cell >= 0) {
+        int row = cell / TicTacToeBoard::MaxSize;
+        int col = cell % TicTacToeBoard::MaxSize;
+        buttons[row][col]->setStyleSheet("background-color: yellow;");
+        buttons[row][col]->setDisabled(true);
+        QTimer::singleShot(300, [this, row, col]() { buttons[row][col]->setStyleSheet(""); buttons[row][col]->setDisabled(false); });
     }
 }
 
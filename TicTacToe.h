@@ -20,19 +20,8 @@
 #include <QLabel>
 #include <QMediaPlayer>
 #include <QSoundEffect>
-
-// Enumeration for human game state outcomes.
-enum class HumanState : int {
-    LOSE =  1,
-    TIE  =  0,
-    WIN  = -1
-};
-
-enum Player  {
-    Machine = 'O',
-    HUMAN = 'X',
-    NONE  = ' '
-};
+#include "tictactoeboard.h"
+#include "tictactoesearch.h"
 
 /**
  * @class TicTacToe
@@ -85,7 +74,8 @@ private:
 
     bool isHumanTurn;
 
-    std::vector<std::vector<char>> board;
+    TicTacToeBoard board;
+    TicTacToeSearch search;
     std::vector<std::vector<QPushButton*>> buttons;
 
     QPushButton *highScoreButton;
@@ -100,8 +90,6 @@ private:
     QSoundEffect *buttonSoundEffect;
 
     //Function
-    HumanState calculateScore(std::vector<std::vector<char>> gameBoard) const;
-
     void updateAndSaveStats(bool player1Win, bool player2Win, bool tie);
     void initializeGame();
     void playTheBest();
@@ -115,10 +103,8 @@ private:
     void showHelp();
     void musicStateChanged(QMediaPlayer::MediaStatus status);
 
-    int miniMax(std::vector<std::vector<char>> gameBoard, int depth, bool isMachine) const;
-
-    bool isGameOver(std::vector<std::vector<char>> gameBoard) const;
-    bool checkWin(Player player, const std::vector<std::vector<char>>& gameBoard) const;
+    bool isGameOver(const TicTacToeBoard &gameBoard) const;
+    bool checkWin(Player player, const TicTacToeBoard &gameBoard) const;
 };
 
 #endif // TICTACTOE_H
@@ -0,0 +1,120 @@
+/**
+ * @file aibench2048.cpp
+ * @brief Command-line benchmark measuring how the 2048 expectimax search scales with threads.
+ *
+ * A fixed set of positions is recorded from a seeded game, then searched once per thread count.
+ * The tool reports the time, node rate and speedup of each run and checks that every thread count
+ * picks the same moves as the single-threaded search.
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+#include "board2048.h"
+#include "rng2048.h"
+#include "expectimax2048.h"
+
+/**
+ * @brief Records positions from a game played by a shallow search.
+ * @param count The number of positions to record.
+ * @param seed The seed of the game.
+ * @return The recorded positions.
+ */
+static QVector<Board2048> recordPositions(int count, quint64 seed)
+{
+    QVector<Board2048> positions;
+    Rng2048 rng(seed);
+    Expectimax2048 player(2, 1);
+    Board2048 board;
+    board.spawnTile(rng);
+    board.spawnTile(rng);
+
+    // Skip the opening so the positions have a realistic number of tiles
+    int skip = 50;
+    Board2048::Direction direction;
+    while (positions.size() < count) {
+        if (!player.bestMove(board, direction)) {
+            board.clear();
+            board.spawnTile(rng);
+            board.spawnTile(rng);
+            continue;
+        }
+        if (skip > 0) {
+            --skip;
+        } else {
+            positions.append(board);
+        }
+        board.move(direction);
+        board.spawnTile(rng);
+    }
+    return positions;
+}
+
+/**
+ * @brief Main function.
+ * @param argc Number of command line arguments.
+ * @param argv Array of command line arguments.
+ * @return Exit status.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("aibench2048");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures the thread scaling of the 2048 expectimax search.");
+    parser.addHelpOption();
+    parser.addOption({ "depth", "Search depth.", "depth", "6" });
+    parser.addOption({ "positions", "Number of positions to search.", "count", "20" });
+    parser.addOption({ "max-threads", "Largest thread count to try.", "threads", QString::number(QThread::idealThreadCount()) });
+    parser.addOption({ "seed", "Seed of the recorded game.", "seed", "2048" });
+    parser.process(app);
+
+    int depth = parser.value("depth").toInt();
+    int maxThreads = qMax(1, parser.value("max-threads").toInt());
+    QVector<Board2048> positions = recordPositions(parser.value("positions").toInt(), parser.value("seed").toULongLong());
+
+    QTextStream out(stdout);
+    out << "depth " << depth << ", " << positions.size() << " positions\n";
+    out << "threads        ms     Mnodes/s   speedup  same moves\n";
+
+    QVector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.append(threads);
+    }
+    threadCounts.append(maxThreads);
+
+    QVector<Board2048::Direction> reference;
+    double baseline = 0.0;
+    for (int threads : threadCounts) {
+        // A fresh search per run, so no run profits from a table warmed up by the previous one
+        Expectimax2048 search(depth, threads);
+        QVector<Board2048::Direction> moves;
+        uint64_t nodes = 0;
+
+        QElapsedTimer timer;
+        timer.start();
+        for (const Board2048 &board : positions) {
+            Board2048::Direction direction = Board2048::Up;
+            search.bestMove(board, direction);
+            moves.append(direction);
+            nodes += search.nodeCount();
+        }
+        double ms = timer.nsecsElapsed() / 1e6;
+
+        if (threads == 1) {
+            reference = moves;
+            baseline = ms;
+        }
+        out << QString("%1 %2 %3 %4x  %5\n")
+                   .arg(threads, 7)
+                   .arg(ms, 9, 'f', 1)
+                   .arg(nodes / ms / 1000.0, 12, 'f', 2)
+                   .arg(baseline / ms, 8, 'f', 2)
+                   .arg(moves == reference ? "yes" : "NO");
+        out.flush();
+    }
+    return 0;
+}
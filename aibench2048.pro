@@ -0,0 +1,24 @@
+# Command-line benchmark for the thread scaling of the 2048 expectimax search.
+
+QT = core concurrent
+
+CONFIG += c++20 console
+CONFIG -= app_bundle
+
+TARGET = aibench2048
+
+HEADERS += \
+    board2048.h \
+    rng2048.h \
+    expectimax2048.h \
+    heuristic2048.h \
+    ntuple2048.h \
+    transpositiontable2048.h
+
+SOURCES += \
+    aibench2048.cpp \
+    board2048.cpp \
+    expectimax2048.cpp \
+    heuristic2048.cpp \
+    ntuple2048.cpp \
+    transpositiontable2048.cpp
@@ -0,0 +1,123 @@
+/**
+ * @file analysisdialog2048.cpp
+ * @brief Implementation of the AnalysisDialog2048 game review window.
+ */
+#include "analysisdialog2048.h"
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include <algorithm>
+
+namespace {
+
+const char *const DirectionNames[] = { "Up", "Down", "Left", "Right" };
+
+} // namespace
+
+/**
+ * @brief Constructs the dialog and starts following an analysis.
+ * @param reviews The future receiving the reviews; reviews already reported are shown at once.
+ * @param moveCount The number of moves being reviewed.
+ * @param valuesInPoints True if the losses are expected points, false for heuristic units.
+ * @param parent The parent widget.
+ */
+AnalysisDialog2048::AnalysisDialog2048(const QFuture<GameAnalysis2048::MoveReview> &reviews, int moveCount,
+                                       bool valuesInPoints, QWidget *parent)
+    : QDialog(parent), moveCount(moveCount), unit(valuesInPoints ? "points" : "heuristic units")
+{
+    setWindowTitle("Game Analysis");
+    resize(420, 520);
+
+    summaryLabel = new QLabel(this);
+    blundersLabel = new QLabel(this);
+    blundersLabel->setWordWrap(true);
+
+    table = new QTableWidget(0, 4, this);
+    table->setHorizontalHeaderLabels({ "Move", "Played", "Best", "Loss" });
+    table->verticalHeader()->hide();
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(summaryLabel);
+    layout->addWidget(blundersLabel);
+    layout->addWidget(table);
+    layout->addWidget(buttons);
+
+    // Connect before setFuture(), which replays the reviews reported so far
+    connect(&watcher, &QFutureWatcher<GameAnalysis2048::MoveReview>::resultsReadyAt, this, &AnalysisDialog2048::addReviews);
+    connect(&watcher, &QFutureWatcher<GameAnalysis2048::MoveReview>::finished, this, &AnalysisDialog2048::updateSummary);
+    updateSummary();
+    watcher.setFuture(reviews);
+}
+
+/**
+ * @brief Appends a batch of new reviews to the table and the summary.
+ * @param begin The index of the first new review.
+ * @param end The index past the last new review.
+ */
+void AnalysisDialog2048::addReviews(int begin, int end)
+{
+    table->setUpdatesEnabled(false);
+    for (int i = begin; i < end; ++i) {
+        GameAnalysis2048::MoveReview review = watcher.resultAt(i);
+        int row = table->rowCount();
+        table->insertRow(row);
+        table->setItem(row, 0, new QTableWidgetItem(QString::number(review.move + 1)));
+        table->setItem(row, 1, new QTableWidgetItem(DirectionNames[review.played]));
+        table->setItem(row, 2, new QTableWidgetItem(DirectionNames[review.best]));
+        table->setItem(row, 3, new QTableWidgetItem(QString::number(review.loss, 'f', 1)));
+
+        ++reviewed;
+        totalLoss += review.loss;
+        // Keep the largest losses, largest first; the earlier move wins a tie
+        if (review.loss > 0.0f
+            && (blunders.size() < BlunderCount || review.loss > blunders.last().loss)) {
+            auto position = std::upper_bound(blunders.begin(), blunders.end(), review,
+                                             [](const GameAnalysis2048::MoveReview &a, const GameAnalysis2048::MoveReview &b) {
+                                                 return a.loss > b.loss;
+                                             });
+            blunders.insert(position, review);
+            if (blunders.size() > BlunderCount) {
+                blunders.removeLast();
+            }
+        }
+    }
+    table->setUpdatesEnabled(true);
+    updateSummary();
+}
+
+/**
+ * @brief Refreshes the progress and summary text.
+ */
+void AnalysisDialog2048::updateSummary()
+{
+    QString progress = watcher.isFinished() && reviewed > 0
+                           ? QString("%1 moves analysed").arg(reviewed)
+                           : QString("Analysing... %1 of %2 moves").arg(reviewed).arg(moveCount);
+    if (watcher.isCanceled()) {
+        progress = QString("Analysis stopped after %1 of %2 moves").arg(reviewed).arg(moveCount);
+    }
+    summaryLabel->setText(QString("%1\nTotal loss: %2 %3 (%4 per move)")
+                              .arg(progress)
+                              .arg(totalLoss, 0, 'f', 1)
+                              .arg(unit)
+                              .arg(reviewed > 0 ? totalLoss / reviewed : 0.0, 0, 'f', 2));
+
+    QString text = "Biggest blunders:";
+    if (blunders.isEmpty()) {
+        text += " none so far";
+    }
+    for (const GameAnalysis2048::MoveReview &blunder : blunders) {
+        text += QString("\n  move %1: %2 instead of %3, -%4")
+                    .arg(blunder.move + 1)
+                    .arg(DirectionNames[blunder.played])
+                    .arg(DirectionNames[blunder.best])
+                    .arg(blunder.loss, 0, 'f', 1);
+    }
+    blundersLabel->setText(text);
+}
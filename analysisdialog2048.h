@@ -0,0 +1,63 @@
+/**
+ * @file analysisdialog2048.h
+ * @brief Declares the AnalysisDialog2048 class, the window that shows the review of a 2048 game.
+ */
+#ifndef ANALYSISDIALOG2048_H
+#define ANALYSISDIALOG2048_H
+
+#include <QDialog>
+#include <QFutureWatcher>
+#include <QLabel>
+#include <QTableWidget>
+#include <QVector>
+#include "gameanalysis2048.h"
+
+/**
+ * @class AnalysisDialog2048
+ * @brief The AnalysisDialog2048 class lists how much each move of a game lost, as the reviews arrive.
+ *
+ * The dialog watches the future of a GameAnalysis2048 and appends each batch of reviews to its
+ * table as soon as it is reported, so it can be opened while the analysis is still running. It
+ * also keeps a summary of the total loss and the few largest losses, the blunders.
+ */
+class AnalysisDialog2048 : public QDialog {
+    Q_OBJECT
+
+public:
+    static constexpr int BlunderCount = 5;    ///< Largest losses listed in the summary.
+
+    /**
+     * @brief Constructs the dialog and starts following an analysis.
+     * @param reviews The future receiving the reviews; reviews already reported are shown at once.
+     * @param moveCount The number of moves being reviewed.
+     * @param valuesInPoints True if the losses are expected points, false for heuristic units.
+     * @param parent The parent widget.
+     */
+    AnalysisDialog2048(const QFuture<GameAnalysis2048::MoveReview> &reviews, int moveCount, bool valuesInPoints,
+                       QWidget *parent = nullptr);
+
+private slots:
+    /**
+     * @brief Appends a batch of new reviews to the table and the summary.
+     * @param begin The index of the first new review.
+     * @param end The index past the last new review.
+     */
+    void addReviews(int begin, int end);
+    /**
+     * @brief Refreshes the progress and summary text.
+     */
+    void updateSummary();
+
+private:
+    QFutureWatcher<GameAnalysis2048::MoveReview> watcher;
+    QLabel *summaryLabel;
+    QLabel *blundersLabel;
+    QTableWidget *table;
+    QVector<GameAnalysis2048::MoveReview> blunders;
+    int moveCount;
+    int reviewed = 0;
+    double totalLoss = 0.0;
+    QString unit;
+};
+
+#endif // ANALYSISDIALOG2048_H
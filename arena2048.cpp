@@ -0,0 +1,161 @@
+/**
+ * @file arena2048.cpp
+ * @brief Implementation of the Arena2048 background games.
+ */
+#include "arena2048.h"
+#include "expectimax2048.h"
+#include "greedy2048.h"
+#include "rng2048.h"
+#include <QThread>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+const uint64_t RngSeed = 0xA2E4A;    ///< Base seed of the worker streams.
+const int CacheBits = 16;            ///< log2 of the cache entries of each worker's search, 1 MB.
+
+} // namespace
+
+/**
+ * @brief Constructs an idle arena.
+ * @param gameCount The number of games played at once.
+ * @param depth The search depth of the AI; 1 plays the greedy one-move policy.
+ * @param threads The number of worker threads, or 0 for one per core.
+ */
+Arena2048::Arena2048(int gameCount, int depth, int threads)
+    : games(std::max(1, gameCount)),
+      searchDepth(std::max(1, depth)),
+      workerCount(std::min(games, threads > 0 ? threads : QThread::idealThreadCount())),
+      slots(new Slot[games])
+{
+    pool.setMaxThreadCount(workerCount);
+    // The workers run flat out, so let the GUI thread preempt them
+    pool.setThreadPriority(QThread::LowPriority);
+}
+
+/**
+ * @brief Stops and joins the workers.
+ */
+Arena2048::~Arena2048()
+{
+    stop();
+}
+
+/**
+ * @brief Makes the AI score positions with a trained network instead of the static heuristic.
+ * @param evaluator The network, or nullptr for the heuristic.
+ */
+void Arena2048::setEvaluator(const NTuple2048 *evaluator)
+{
+    network = evaluator != nullptr && evaluator->isLoaded() ? evaluator : nullptr;
+}
+
+/**
+ * @brief Starts new games in every slot and lets the workers play them.
+ */
+void Arena2048::start()
+{
+    stop();
+    moves.store(0, std::memory_order_relaxed);
+    finished.store(0, std::memory_order_relaxed);
+    bestTileValue.store(0, std::memory_order_relaxed);
+    stopping.store(false, std::memory_order_relaxed);
+    running = true;
+    for (int worker = 0; worker < workerCount; ++worker) {
+        pool.start([this, worker]() { work(worker); });
+    }
+}
+
+/**
+ * @brief Stops the workers and waits for them; the snapshots keep the last positions.
+ */
+void Arena2048::stop()
+{
+    stopping.store(true, std::memory_order_relaxed);
+    pool.waitForDone();
+    running = false;
+}
+
+/**
+ * @brief Returns the latest published state of a game. Never waits for the workers.
+ * @param game The index of the game.
+ * @return The snapshot of the game.
+ */
+Arena2048::Snapshot Arena2048::snapshot(int game) const
+{
+    Snapshot snapshot;
+    snapshot.board = slots[game].board.load(std::memory_order_relaxed);
+    uint64_t progress = slots[game].progress.load(std::memory_order_relaxed);
+    snapshot.score = static_cast<int>(progress & 0xFFFFFFFF);
+    snapshot.finished = static_cast<int>(progress >> 32);
+    return snapshot;
+}
+
+/**
+ * @brief Plays the games of one worker until stop() is called.
+ * @param worker The index of the worker.
+ */
+void Arena2048::work(int worker)
+{
+    Rng2048 rng = Rng2048::stream(RngSeed, worker);
+    // The search runs on this low-priority worker itself, with a table sized for one game at a time
+    std::unique_ptr<Expectimax2048> search;
+    if (searchDepth > 1) {
+        search = std::make_unique<Expectimax2048>(searchDepth, 1, CacheBits);
+        search->setEvaluator(network);
+    }
+
+    struct Game {
+        Slot *slot;
+        Board2048 board;
+        uint32_t score;
+        uint32_t finished;
+    };
+    std::vector<Game> owned;
+    for (int game = worker; game < games; game += workerCount) {
+        owned.push_back({ &slots[game], Board2048(), 0, 0 });
+    }
+    for (Game &game : owned) {
+        game.board.spawnTile(rng);
+        game.board.spawnTile(rng);
+        game.slot->board.store(game.board.bits(), std::memory_order_relaxed);
+        game.slot->progress.store(0, std::memory_order_relaxed);
+    }
+
+    while (!stopping.load(std::memory_order_relaxed)) {
+        uint64_t played = 0;
+        for (Game &game : owned) {
+            Board2048::Direction direction = Board2048::Up;
+            bool found = false;
+            if (search != nullptr) {
+                found = search->bestMove(game.board, direction);
+            } else {
+                Greedy2048::Move move;
+                found = Greedy2048::choose(game.board.bits(), move, network);
+                direction = move.direction;
+            }
+            if (found) {
+                int addedScore = 0;
+                game.board.move(direction, &addedScore);
+                game.board.spawnTile(rng);
+                game.score += static_cast<uint32_t>(addedScore);
+                ++played;
+            } else {
+                int tile = game.board.maxTile();
+                int best = bestTileValue.load(std::memory_order_relaxed);
+                while (tile > best && !bestTileValue.compare_exchange_weak(best, tile, std::memory_order_relaxed)) {
+                }
+                finished.fetch_add(1, std::memory_order_relaxed);
+                ++game.finished;
+                game.score = 0;
+                game.board.clear();
+                game.board.spawnTile(rng);
+                game.board.spawnTile(rng);
+            }
+            game.slot->board.store(game.board.bits(), std::memory_order_relaxed);
+            game.slot->progress.store(static_cast<uint64_t>(game.finished) << 32 | game.score, std::memory_order_relaxed);
+        }
+        moves.fetch_add(played, std::memory_order_relaxed);
+    }
+}
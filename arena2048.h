@@ -0,0 +1,138 @@
+/**
+ * @file arena2048.h
+ * @brief Declares the Arena2048 class, many AI games of 2048 played side by side on worker threads.
+ *
+ * The games are dealt out to the workers round-robin, and each worker plays one move of each of
+ * its games in turn, so all games advance at the same pace. When a game is lost it is counted and
+ * a new one starts in its slot.
+ *
+ * The workers never wait for a reader. After each move they publish the packed board of the game
+ * with a single atomic store, and its score and game count with another, each slot on its own cache
+ * line. A reader such as the SpectatorWall2048 loads them whenever it likes and always gets a
+ * whole board, at worst one move older than the score beside it. The move count is added to a
+ * shared counter once per round rather than once per move, so the workers do not fight over it.
+ */
+#ifndef ARENA2048_H
+#define ARENA2048_H
+
+#include <QThreadPool>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "board2048.h"
+#include "ntuple2048.h"
+
+/**
+ * @class Arena2048
+ * @brief The Arena2048 class plays a fixed number of AI games of 2048 as fast as the cores allow.
+ */
+class Arena2048 {
+public:
+    static constexpr int DefaultGameCount = 64;    ///< Games played at once.
+
+    /**
+     * @brief Latest published state of one game.
+     */
+    struct Snapshot {
+        uint64_t board = 0;     ///< Packed board.
+        int score = 0;          ///< Score of the running game.
+        int finished = 0;       ///< Games lost so far in this slot.
+    };
+
+    /**
+     * @brief Constructs an idle arena.
+     * @param gameCount The number of games played at once.
+     * @param depth The search depth of the AI; 1 plays the greedy one-move policy.
+     * @param threads The number of worker threads, or 0 for one per core.
+     */
+    explicit Arena2048(int gameCount = DefaultGameCount, int depth = 1, int threads = 0);
+    /**
+     * @brief Stops and joins the workers.
+     */
+    ~Arena2048();
+    Arena2048(const Arena2048 &) = delete;
+    Arena2048 &operator=(const Arena2048 &) = delete;
+
+    /**
+     * @brief Makes the AI score positions with a trained network instead of the static heuristic.
+     *
+     * Must not be called while the arena is running. The network must outlive the arena.
+     * @param evaluator The network, or nullptr for the heuristic.
+     */
+    void setEvaluator(const NTuple2048 *evaluator);
+    /**
+     * @brief Starts new games in every slot and lets the workers play them.
+     */
+    void start();
+    /**
+     * @brief Stops the workers and waits for them; the snapshots keep the last positions.
+     */
+    void stop();
+    /**
+     * @brief Checks if the workers are playing.
+     * @return True between start() and stop(), false otherwise.
+     */
+    bool isRunning() const { return running; }
+
+    /**
+     * @brief Returns the number of games played at once.
+     * @return The game count.
+     */
+    int gameCount() const { return games; }
+    /**
+     * @brief Returns the latest published state of a game. Never waits for the workers.
+     * @param game The index of the game.
+     * @return The snapshot of the game.
+     */
+    Snapshot snapshot(int game) const;
+    /**
+     * @brief Returns the latest published board of a game. Never waits for the workers.
+     * @param game The index of the game.
+     * @return The packed board.
+     */
+    uint64_t board(int game) const { return slots[game].board.load(std::memory_order_relaxed); }
+    /**
+     * @brief Returns the number of moves played in all games since start().
+     * @return The move count, at most one round of each worker behind.
+     */
+    uint64_t moveCount() const { return moves.load(std::memory_order_relaxed); }
+    /**
+     * @brief Returns the number of games lost since start().
+     * @return The count of finished games.
+     */
+    uint64_t finishedCount() const { return finished.load(std::memory_order_relaxed); }
+    /**
+     * @brief Returns the largest tile reached by a finished game since start().
+     * @return The tile value, or 0 before the first game ends.
+     */
+    int bestTile() const { return bestTileValue.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * @brief Published state of one game, alone on its cache line.
+     */
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> board{ 0 };       ///< Packed board.
+        std::atomic<uint64_t> progress{ 0 };    ///< Finished games in the high half, score in the low half.
+    };
+
+    /**
+     * @brief Plays the games of one worker until stop() is called.
+     * @param worker The index of the worker.
+     */
+    void work(int worker);
+
+    int games;
+    int searchDepth;
+    int workerCount;
+    bool running = false;
+    const NTuple2048 *network = nullptr;
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<bool> stopping{ false };
+    std::atomic<uint64_t> moves{ 0 };
+    std::atomic<uint64_t> finished{ 0 };
+    std::atomic<int> bestTileValue{ 0 };
+    QThreadPool pool;
+};
+
+#endif // ARENA2048_H
@@ -1,18 +1,47 @@
 QT += widgets
 QT += core gui widgets testlib
 QT += multimedia
+QT += concurrent
 
 //QT += core gui multimedia
 
 CONFIG += c++20
 
+# The 3x3 Tic Tac Toe table (tictactoeperfect.cpp) is solved at compile time; give the compilers
+# with a low default constexpr budget enough steps for it
+msvc: QMAKE_CXXFLAGS += /constexpr:steps10000000
+clang: QMAKE_CXXFLAGS += -fconstexpr-steps=100000000
+
 HEADERS += \
     fifteenpuzzle.h \
     mainmenu.h \
     settingswindow.h \
     snakegame.h \
     TicTacToe.h \
+    tictactoeboard.h \
+    tictactoesearch.h \
+    tictactoetable.h \
+    tictactoeperfect.h \
     game2048.h \
+    board2048.h \
+    gridboard2048.h \
+    historyring2048.h \
+    boardview2048.h \
+    rng2048.h \
+    expectimax2048.h \
+    heuristic2048.h \
+    greedy2048.h \
+    ntuple2048.h \
+    exactsolver2048.h \
+    evilspawner2048.h \
+    winestimator2048.h \
+    gameanalysis2048.h \
+    analysisdialog2048.h \
+    arena2048.h \
+    spectatorwall2048.h \
+    lineboard2048.h \
+    variantgame2048.h \
+    transpositiontable2048.h \
     tictactoesetting.h
 
 SOURCES += \
@@ -22,7 +51,29 @@ SOURCES += \
     settingswindow.cpp \
     snakegame.cpp \
     TicTacToe.cpp \
+    tictactoeboard.cpp \
+    tictactoesearch.cpp \
+    tictactoetable.cpp \
+    tictactoeperfect.cpp \
     game2048.cpp \
+    board2048.cpp \
+    gridboard2048.cpp \
+    historyring2048.cpp \
+    boardview2048.cpp \
+    expectimax2048.cpp \
+    heuristic2048.cpp \
+    greedy2048.cpp \
+    ntuple2048.cpp \
+    exactsolver2048.cpp \
+    evilspawner2048.cpp \
+    winestimator2048.cpp \
+    gameanalysis2048.cpp \
+    analysisdialog2048.cpp \
+    arena2048.cpp \
+    spectatorwall2048.cpp \
+    lineboard2048.cpp \
+    variantgame2048.cpp \
+    transpositiontable2048.cpp \
     tictactoesetting.cpp
 
 
@@ -0,0 +1,274 @@
+/**
+ * @file batch2048.cpp
+ * @brief Implementation of the Batch2048 structure-of-arrays move kernel.
+ */
+#include "batch2048.h"
+#include <cstring>
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+// The kernel is compiled for AVX2 whatever the target flags and only called on CPUs that have it
+#define BATCH2048_AVX2_KERNEL
+#define BATCH2048_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+namespace {
+
+#if defined(BATCH2048_AVX2_KERNEL)
+
+/**
+ * @brief Checks once whether the CPU running the program supports AVX2.
+ * @return True if the AVX2 kernel can run, false otherwise.
+ */
+bool cpuHasAvx2()
+{
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+/**
+ * @brief Cells of each line for each direction, in the order the tiles slide towards.
+ */
+struct LineOrder {
+    uint8_t cells[4][Board2048::Size][Board2048::Size];
+
+    LineOrder()
+    {
+        for (int line = 0; line < Board2048::Size; ++line) {
+            for (int i = 0; i < Board2048::Size; ++i) {
+                int last = Board2048::Size - 1 - i;
+                cells[Board2048::Up][line][i] = static_cast<uint8_t>(i * Board2048::Size + line);
+                cells[Board2048::Down][line][i] = static_cast<uint8_t>(last * Board2048::Size + line);
+                cells[Board2048::Left][line][i] = static_cast<uint8_t>(line * Board2048::Size + i);
+                cells[Board2048::Right][line][i] = static_cast<uint8_t>(line * Board2048::Size + last);
+            }
+        }
+    }
+};
+
+/**
+ * @brief Returns the line order, built on first use.
+ * @return The line order.
+ */
+const LineOrder &lineOrder()
+{
+    static const LineOrder order;
+    return order;
+}
+
+/**
+ * @brief Moves the non-empty cells of a line to its front, on every board at once.
+ *
+ * An empty cell takes the value of the next one, which is cleared; the sweeps shrink by one cell
+ * each because every sweep carries one hole to the end of the line.
+ * @param line The four cells of the line, one board per byte.
+ */
+BATCH2048_TARGET_AVX2 inline void compactLine(__m256i line[Board2048::Size])
+{
+    const __m256i zero = _mm256_setzero_si256();
+    for (int end = Board2048::Size - 1; end > 0; --end) {
+        for (int i = 0; i < end; ++i) {
+            __m256i empty = _mm256_cmpeq_epi8(line[i], zero);
+            line[i] = _mm256_blendv_epi8(line[i], line[i + 1], empty);
+            line[i + 1] = _mm256_andnot_si256(empty, line[i + 1]);
+        }
+    }
+}
+
+#endif
+
+} // namespace
+
+/**
+ * @brief Constructs a batch of empty boards.
+ */
+Batch2048::Batch2048()
+{
+    std::memset(cells, 0, sizeof(cells));
+}
+
+/**
+ * @brief Stores a board in the batch.
+ * @param index The index of the board, in [0, Width).
+ * @param board The board.
+ */
+void Batch2048::setBoard(int index, const Board2048 &board)
+{
+    uint64_t bits = board.bits();
+    for (int c = 0; c < Board2048::CellCount; ++c) {
+        cells[c][index] = static_cast<uint8_t>((bits >> (4 * c)) & 0xF);
+    }
+}
+
+/**
+ * @brief Returns a board of the batch.
+ * @param index The index of the board, in [0, Width).
+ * @return The board.
+ */
+Board2048 Batch2048::board(int index) const
+{
+    uint64_t bits = 0;
+    for (int c = 0; c < Board2048::CellCount; ++c) {
+        bits |= static_cast<uint64_t>(cells[c][index]) << (4 * c);
+    }
+    return Board2048(bits);
+}
+
+/**
+ * @brief Stores packed boards in the first slots of the batch and empties the others.
+ * @param boards The packed boards.
+ * @param count The number of boards, at most Width.
+ */
+void Batch2048::load(const uint64_t *boards, int count)
+{
+    for (int b = 0; b < Width; ++b) {
+        setBoard(b, Board2048(b < count ? boards[b] : 0));
+    }
+}
+
+/**
+ * @brief Reads the first boards of the batch in packed form.
+ * @param boards Receives the packed boards.
+ * @param count The number of boards, at most Width.
+ */
+void Batch2048::store(uint64_t *boards, int count) const
+{
+    for (int b = 0; b < count; ++b) {
+        boards[b] = board(b).bits();
+    }
+}
+
+/**
+ * @brief Slides and merges the tiles of every board in the given direction.
+ *
+ * Runs the AVX2 kernel when the CPU supports it, or moveScalar() otherwise.
+ * @param direction The direction of the move.
+ * @param result Receives which boards moved and merged, and the score each one gained.
+ */
+void Batch2048::move(Board2048::Direction direction, MoveResult &result)
+{
+#if defined(BATCH2048_AVX2_KERNEL)
+    if (cpuHasAvx2()) {
+        moveAvx2(direction, result);
+        return;
+    }
+#endif
+    moveScalar(direction, result);
+}
+
+/**
+ * @brief Slides and merges the tiles of every board with the scalar engine, one board at a time.
+ * @param direction The direction of the move.
+ * @param result Receives which boards moved and merged, and the score each one gained.
+ */
+void Batch2048::moveScalar(Board2048::Direction direction, MoveResult &result)
+{
+    // The 65536-entry row tables beat any byte-wise kernel without SIMD, so each board is packed
+    // and moved by the engine
+    result.moved = 0;
+    result.merged = 0;
+    for (int b = 0; b < Width; ++b) {
+        uint64_t bits = board(b).bits();
+        int addedScore = 0;
+        uint64_t next = Board2048::slide(bits, direction, addedScore);
+        // Every merge scores at least 4, so a score tells that something merged
+        result.scores[b] = addedScore;
+        if (next != bits) {
+            result.moved |= 1u << b;
+            setBoard(b, Board2048(next));
+        }
+        if (addedScore > 0) {
+            result.merged |= 1u << b;
+        }
+    }
+}
+
+#if defined(BATCH2048_AVX2_KERNEL)
+/**
+ * @brief Slides and merges the tiles of every board with the AVX2 kernel.
+ *
+ * Each line is gathered into four registers in slide order, compacted, merged pair by pair from
+ * the front (a merged tile is cleared behind its partner, so it cannot merge again) and compacted
+ * again, exactly like GridBoard2048::slideRow(). The value of every new tile is looked up as two
+ * bytes with pshufb and summed per board in 16-bit lanes, at half its value so that the two merges
+ * a line can make never overflow them.
+ * @param direction The direction of the move.
+ * @param result Receives which boards moved and merged, and the score each one gained.
+ */
+BATCH2048_TARGET_AVX2 void Batch2048::moveAvx2(Board2048::Direction direction, MoveResult &result)
+{
+    const uint8_t (*lines)[Board2048::Size] = lineOrder().cells[direction];
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i capped = _mm256_set1_epi8(Board2048::MaxExponent);
+    // Half the value of the tile of each exponent, split in low and high bytes
+    const __m256i halfLow = _mm256_setr_epi8(0, 1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0,
+                                             0, 1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i halfHigh = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 4, 8, 16, 32, 64,
+                                              0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 4, 8, 16, 32, 64);
+
+    __m256i changed = zero;
+    __m256i mergedAny = zero;
+    // Boards 0-3 and 16-19, 4-7 and 20-23, 8-11 and 24-27, 12-15 and 28-31
+    __m256i halfScores[4] = { zero, zero, zero, zero };
+    for (int l = 0; l < Board2048::Size; ++l) {
+        __m256i before[Board2048::Size];
+        __m256i line[Board2048::Size];
+        for (int i = 0; i < Board2048::Size; ++i) {
+            before[i] = _mm256_load_si256(reinterpret_cast<const __m256i *>(cells[lines[l][i]]));
+            line[i] = before[i];
+        }
+
+        compactLine(line);
+        // Boards 0-7 and 16-23, then 8-15 and 24-31; half values keep a line's sum below 2^16
+        __m256i lineWords[2] = { zero, zero };
+        __m256i lineMerged = zero;
+        for (int i = 0; i < Board2048::Size - 1; ++i) {
+            __m256i merge = _mm256_and_si256(_mm256_cmpeq_epi8(line[i], line[i + 1]),
+                                             _mm256_andnot_si256(_mm256_cmpeq_epi8(line[i], zero),
+                                                                 _mm256_cmpgt_epi8(capped, line[i])));
+            // merge is -1 where the pair merges, so subtracting it increments the exponent
+            line[i] = _mm256_sub_epi8(line[i], merge);
+            line[i + 1] = _mm256_andnot_si256(merge, line[i + 1]);
+            __m256i low = _mm256_and_si256(_mm256_shuffle_epi8(halfLow, line[i]), merge);
+            __m256i high = _mm256_and_si256(_mm256_shuffle_epi8(halfHigh, line[i]), merge);
+            lineWords[0] = _mm256_add_epi16(lineWords[0], _mm256_unpacklo_epi8(low, high));
+            lineWords[1] = _mm256_add_epi16(lineWords[1], _mm256_unpackhi_epi8(low, high));
+            lineMerged = _mm256_or_si256(lineMerged, merge);
+        }
+
+        if (!_mm256_testz_si256(lineMerged, lineMerged)) {
+            compactLine(line);
+            mergedAny = _mm256_or_si256(mergedAny, lineMerged);
+            halfScores[0] = _mm256_add_epi32(halfScores[0], _mm256_unpacklo_epi16(lineWords[0], zero));
+            halfScores[1] = _mm256_add_epi32(halfScores[1], _mm256_unpackhi_epi16(lineWords[0], zero));
+            halfScores[2] = _mm256_add_epi32(halfScores[2], _mm256_unpacklo_epi16(lineWords[1], zero));
+            halfScores[3] = _mm256_add_epi32(halfScores[3], _mm256_unpackhi_epi16(lineWords[1], zero));
+        }
+
+        for (int i = 0; i < Board2048::Size; ++i) {
+            changed = _mm256_or_si256(changed, _mm256_xor_si256(before[i], line[i]));
+            _mm256_store_si256(reinterpret_cast<__m256i *>(cells[lines[l][i]]), line[i]);
+        }
+    }
+
+    result.moved = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(changed, zero)));
+    result.merged = static_cast<uint32_t>(_mm256_movemask_epi8(mergedAny));
+    __m256i *scores = reinterpret_cast<__m256i *>(result.scores);
+    _mm256_storeu_si256(scores, _mm256_slli_epi32(_mm256_permute2x128_si256(halfScores[0], halfScores[1], 0x20), 1));
+    _mm256_storeu_si256(scores + 1, _mm256_slli_epi32(_mm256_permute2x128_si256(halfScores[2], halfScores[3], 0x20), 1));
+    _mm256_storeu_si256(scores + 2, _mm256_slli_epi32(_mm256_permute2x128_si256(halfScores[0], halfScores[1], 0x31), 1));
+    _mm256_storeu_si256(scores + 3, _mm256_slli_epi32(_mm256_permute2x128_si256(halfScores[2], halfScores[3], 0x31), 1));
+}
+#endif
+
+/**
+ * @brief Tells whether move() uses the AVX2 kernel.
+ * @return True if the kernel was built and the CPU supports AVX2, false if every board is moved on its own.
+ */
+bool Batch2048::isVectorized()
+{
+#if defined(BATCH2048_AVX2_KERNEL)
+    return cpuHasAvx2();
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,104 @@
+/**
+ * @file batch2048.h
+ * @brief Declares the Batch2048 class, which moves 32 independent 2048 boards at once.
+ *
+ * Self-play, rollouts and training step thousands of boards that have nothing to do with each
+ * other. Batch2048 stores 32 of them as a structure of arrays: one byte per board for each of the
+ * 16 cells, so cell c of every board fits in a single 256-bit register. A move then runs the same
+ * compact-merge-compact steps as GridBoard2048::slideRow() on four such registers per line, which
+ * handles all 32 boards with one instruction per step. The AVX2 kernel is built on x86 GCC and Clang
+ * whatever the target flags and chosen at run time when the CPU supports it; otherwise every board
+ * is packed and moved with Board2048::slide(), so both paths follow exactly the rules of the 4x4
+ * engine.
+ */
+#ifndef BATCH2048_H
+#define BATCH2048_H
+
+#include <cstdint>
+#include "board2048.h"
+
+/**
+ * @class Batch2048
+ * @brief The Batch2048 class applies the same move to a batch of 4x4 boards.
+ *
+ * Byte b of cell row (row * 4 + col) holds the exponent of that cell on board b. Boards that are
+ * not used can be left empty; they never move.
+ */
+class Batch2048 {
+public:
+    static constexpr int Width = 32;    ///< Number of boards in a batch.
+
+    /**
+     * @brief Outcome of a move for every board of the batch.
+     */
+    struct MoveResult {
+        uint32_t moved = 0;           ///< Bit b set if board b changed.
+        uint32_t merged = 0;          ///< Bit b set if two tiles merged on board b.
+        int32_t scores[Width] = {};   ///< Score gained by the merges on each board.
+    };
+
+    /**
+     * @brief Constructs a batch of empty boards.
+     */
+    Batch2048();
+
+    /**
+     * @brief Stores a board in the batch.
+     * @param index The index of the board, in [0, Width).
+     * @param board The board.
+     */
+    void setBoard(int index, const Board2048 &board);
+    /**
+     * @brief Returns a board of the batch.
+     * @param index The index of the board, in [0, Width).
+     * @return The board.
+     */
+    Board2048 board(int index) const;
+    /**
+     * @brief Stores packed boards in the first slots of the batch and empties the others.
+     * @param boards The packed boards.
+     * @param count The number of boards, at most Width.
+     */
+    void load(const uint64_t *boards, int count);
+    /**
+     * @brief Reads the first boards of the batch in packed form.
+     * @param boards Receives the packed boards.
+     * @param count The number of boards, at most Width.
+     */
+    void store(uint64_t *boards, int count) const;
+
+    /**
+     * @brief Slides and merges the tiles of every board in the given direction.
+     *
+     * Runs the AVX2 kernel when the CPU supports it, or moveScalar() otherwise.
+     * @param direction The direction of the move.
+     * @param result Receives which boards moved and merged, and the score each one gained.
+     */
+    void move(Board2048::Direction direction, MoveResult &result);
+    /**
+     * @brief Slides and merges the tiles of every board with the scalar engine, one board at a time.
+     * @param direction The direction of the move.
+     * @param result Receives which boards moved and merged, and the score each one gained.
+     */
+    void moveScalar(Board2048::Direction direction, MoveResult &result);
+
+    /**
+     * @brief Tells whether move() uses the AVX2 kernel.
+     * @return True if the kernel was built and the CPU supports AVX2, false if every board is moved on its own.
+     */
+    static bool isVectorized();
+
+private:
+    /**
+     * @brief Slides and merges the tiles of every board with the AVX2 kernel.
+     *
+     * Only built for x86 GCC and Clang, and only called when the CPU supports AVX2.
+     * @param direction The direction of the move.
+     * @param result Receives which boards moved and merged, and the score each one gained.
+     */
+    void moveAvx2(Board2048::Direction direction, MoveResult &result);
+
+    alignas(32) uint8_t cells[Board2048::CellCount][Width];
+};
+
+#endif // BATCH2048_H
@@ -0,0 +1,22 @@
+# Qt Test benchmarks for the 2048 engine hot path.
+
+QT = core testlib
+
+CONFIG += c++20 console testcase
+CONFIG -= app_bundle
+
+TARGET = bench2048
+
+HEADERS += \
+    batch2048.h \
+    board2048.h \
+    gridboard2048.h \
+    lineboard2048.h \
+    rng2048.h
+
+SOURCES += \
+    tst_bench2048.cpp \
+    batch2048.cpp \
+    board2048.cpp \
+    gridboard2048.cpp \
+    lineboard2048.cpp
@@ -0,0 +1,436 @@
+/**
+ * @file board2048.cpp
+ * @brief Implementation of the Board2048 bitboard engine.
+ */
+#include "board2048.h"
+#include "rng2048.h"
+#include <bit>
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+// The pdep select is compiled for BMI2 whatever the target flags and only called on CPUs that have it
+#define BOARD2048_BMI2_SELECT
+#define BOARD2048_TARGET_BMI2 __attribute__((target("bmi2")))
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/**
+ * @brief Lookup tables holding the result of a move for every possible 16-bit row.
+ *
+ * The score gained by a row does not depend on the slide direction: a run of k equal tiles always
+ * produces k / 2 merges, so one score table serves both left and right.
+ */
+struct RowTables {
+    uint16_t left[65536];
+    uint16_t right[65536];
+    uint32_t score[65536];
+
+    RowTables()
+    {
+        for (int row = 0; row < 65536; ++row) {
+            int line[4] = { row & 0xF, (row >> 4) & 0xF, (row >> 8) & 0xF, (row >> 12) & 0xF };
+
+            // Compact the tiles towards column 0, merging each equal pair once
+            int result[4] = { 0, 0, 0, 0 };
+            int count = 0;
+            uint32_t gained = 0;
+            bool mergeable = false;
+            for (int i = 0; i < 4; ++i) {
+                if (line[i] == 0) {
+                    continue;
+                }
+                if (mergeable && result[count - 1] == line[i] && line[i] < Board2048::MaxExponent) {
+                    ++result[count - 1];
+                    gained += 1u << result[count - 1];
+                    mergeable = false;
+                } else {
+                    result[count++] = line[i];
+                    mergeable = true;
+                }
+            }
+
+            left[row] = static_cast<uint16_t>(result[0] | (result[1] << 4) | (result[2] << 8) | (result[3] << 12));
+            score[row] = gained;
+
+            // The right move is the left move of the mirrored row
+            int reversed = ((row & 0xF) << 12) | ((row & 0xF0) << 4) | ((row & 0xF00) >> 4) | ((row & 0xF000) >> 12);
+            right[reversed] = static_cast<uint16_t>(((left[row] & 0xF) << 12) | ((left[row] & 0xF0) << 4)
+                                                    | ((left[row] & 0xF00) >> 4) | ((left[row] & 0xF000) >> 12));
+        }
+    }
+};
+
+/**
+ * @brief Returns the shared row tables, building them on first use.
+ * @return The row tables.
+ */
+const RowTables &rowTables()
+{
+    static const RowTables tables;
+    return tables;
+}
+
+/**
+ * @brief Applies a row table to each of the four rows of a packed board.
+ * @param bits The packed board.
+ * @param table The row table to apply.
+ * @param addedScore Accumulates the score gained by the merges.
+ * @return The packed board after the move.
+ */
+inline uint64_t applyRows(uint64_t bits, const uint16_t *table, int &addedScore)
+{
+    const RowTables &tables = rowTables();
+    uint64_t result = 0;
+    for (int r = 0; r < 4; ++r) {
+        uint16_t row = static_cast<uint16_t>(bits >> (16 * r));
+        result |= static_cast<uint64_t>(table[row]) << (16 * r);
+        addedScore += static_cast<int>(tables.score[row]);
+    }
+    return result;
+}
+
+/**
+ * @brief Returns a mask with the lowest bit of every non-empty nibble set.
+ * @param bits The packed board.
+ * @return The occupancy mask.
+ */
+inline uint64_t occupiedNibbles(uint64_t bits)
+{
+    bits |= bits >> 2;
+    bits |= bits >> 1;
+    return bits & 0x1111111111111111ULL;
+}
+
+/**
+ * @brief Returns the position of the k-th set bit of a mask.
+ * @param mask The mask, with more than k bits set.
+ * @param k The zero-based rank of the bit.
+ * @return The bit position.
+ */
+inline int selectBitScalar(uint32_t mask, int k)
+{
+    // Narrow down the byte, nibble, pair and bit holding the k-th set bit
+    int position = 0;
+    int count = std::popcount(mask & 0xFF);
+    if (k >= count) {
+        k -= count;
+        position += 8;
+    }
+    count = std::popcount((mask >> position) & 0xF);
+    if (k >= count) {
+        k -= count;
+        position += 4;
+    }
+    count = std::popcount((mask >> position) & 0x3);
+    if (k >= count) {
+        k -= count;
+        position += 2;
+    }
+    count = (mask >> position) & 0x1;
+    if (k >= count) {
+        position += 1;
+    }
+    return position;
+}
+
+#if defined(BOARD2048_BMI2_SELECT)
+
+/**
+ * @brief Checks once whether the CPU running the program supports BMI2.
+ * @return True if pdep can run, false otherwise.
+ */
+bool cpuHasBmi2()
+{
+    static const bool supported = __builtin_cpu_supports("bmi2");
+    return supported;
+}
+
+/**
+ * @brief Returns the position of the k-th set bit of a mask with one pdep.
+ * @param mask The mask, with more than k bits set.
+ * @param k The zero-based rank of the bit.
+ * @return The bit position.
+ */
+BOARD2048_TARGET_BMI2 inline int selectBitBmi2(uint32_t mask, int k)
+{
+    return std::countr_zero(_pdep_u32(1u << k, mask));
+}
+
+#endif
+
+/**
+ * @brief Returns the position of the k-th set bit of a mask, with pdep when the CPU has BMI2.
+ * @param mask The mask, with more than k bits set.
+ * @param k The zero-based rank of the bit.
+ * @return The bit position.
+ */
+inline int selectBit(uint32_t mask, int k)
+{
+#if defined(BOARD2048_BMI2_SELECT)
+    if (cpuHasBmi2()) {
+        return selectBitBmi2(mask, k);
+    }
+#endif
+    return selectBitScalar(mask, k);
+}
+
+} // namespace
+
+/**
+ * @brief Constructs an empty board.
+ */
+Board2048::Board2048()
+    : board(0)
+{
+}
+
+/**
+ * @brief Constructs a board from its packed representation.
+ * @param bits The packed board.
+ */
+Board2048::Board2048(uint64_t bits)
+    : board(bits)
+{
+}
+
+/**
+ * @brief Returns the tile value stored in a cell.
+ * @param row The row index.
+ * @param col The column index.
+ * @return The tile value, or 0 if the cell is empty.
+ */
+int Board2048::cell(int row, int col) const
+{
+    int e = exponent(row, col);
+    return e == 0 ? 0 : 1 << e;
+}
+
+/**
+ * @brief Returns the exponent stored in a cell.
+ * @param row The row index.
+ * @param col The column index.
+ * @return The exponent of the tile value, or 0 if the cell is empty.
+ */
+int Board2048::exponent(int row, int col) const
+{
+    return static_cast<int>((board >> (4 * (row * 4 + col))) & 0xF);
+}
+
+/**
+ * @brief Stores a tile value in a cell.
+ * @param row The row index.
+ * @param col The column index.
+ * @param value The tile value (a power of two), or 0 to empty the cell.
+ */
+void Board2048::setCell(int row, int col, int value)
+{
+    uint64_t e = 0;
+    while (value > 1 && e < MaxExponent) {
+        value >>= 1;
+        ++e;
+    }
+    int shift = 4 * (row * 4 + col);
+    board = (board & ~(0xFULL << shift)) | (e << shift);
+}
+
+/**
+ * @brief Empties every cell of the board.
+ */
+void Board2048::clear()
+{
+    board = 0;
+}
+
+/**
+ * @brief Slides and merges the tiles in the given direction.
+ * @param direction The direction of the move.
+ * @param addedScore If not null, receives the score gained by the merges.
+ * @return True if any tile moved or merged, false otherwise.
+ */
+bool Board2048::move(Direction direction, int *addedScore)
+{
+    int gained = 0;
+    uint64_t next = slide(board, direction, gained);
+    if (addedScore) {
+        *addedScore = gained;
+    }
+    if (next == board) {
+        return false;
+    }
+    board = next;
+    return true;
+}
+
+/**
+ * @brief Checks whether a move in the given direction would change the board.
+ * @param direction The direction to test.
+ * @return True if the move is legal, false otherwise.
+ */
+bool Board2048::canMove(Direction direction) const
+{
+    int gained = 0;
+    return slide(board, direction, gained) != board;
+}
+
+/**
+ * @brief Places a 2 (90%) or a 4 (10%) on an empty cell chosen uniformly at random.
+ * @param rng The generator of the game.
+ * @return True if a tile was placed, false if the board is full.
+ */
+bool Board2048::spawnTile(Rng2048 &rng)
+{
+    uint64_t next = spawn(board, rng.next());
+    if (next == board) {
+        return false;
+    }
+    board = next;
+    return true;
+}
+
+/**
+ * @brief Places a tile on an empty cell chosen by 64 random bits.
+ * @param bits The packed board.
+ * @param random The random bits: the high half picks the cell, the low half the value.
+ * @return The packed board with the new tile, or the same board if it is full.
+ */
+uint64_t Board2048::spawn(uint64_t bits, uint64_t random)
+{
+    uint32_t empty = Board2048(bits).emptyMask();
+    if (empty == 0) {
+        return bits;
+    }
+    uint32_t count = static_cast<uint32_t>(std::popcount(empty));
+    int k = static_cast<int>(((random >> 32) * count) >> 32);
+    uint64_t exponent = static_cast<uint32_t>(random) % 10 < 9 ? 1 : 2;
+    return bits | (exponent << (4 * selectBit(empty, k)));
+}
+
+/**
+ * @brief Checks if there are equal non-empty tiles next to each other.
+ * @return True if adjacent duplicates are found, false otherwise.
+ */
+bool Board2048::hasAdjacentDuplicates() const
+{
+    uint64_t occupied = occupiedNibbles(board);
+
+    // Horizontal neighbours: compare each nibble with the one to its right (columns 0-2 only)
+    uint64_t horizontal = ~occupiedNibbles(board ^ (board >> 4)) & occupied & (occupied >> 4) & 0x0111011101110111ULL;
+    // Vertical neighbours: compare each nibble with the one below it (rows 0-2 only)
+    uint64_t vertical = ~occupiedNibbles(board ^ (board >> 16)) & occupied & (occupied >> 16) & 0x0000111111111111ULL;
+    return (horizontal | vertical) != 0;
+}
+
+/**
+ * @brief Counts the empty cells of the board.
+ * @return The number of empty cells.
+ */
+int Board2048::emptyCount() const
+{
+    return 16 - std::popcount(occupiedNibbles(board));
+}
+
+/**
+ * @brief Returns a mask with bit (row * 4 + col) set for every empty cell.
+ * @return The 16-bit empty-cell mask.
+ */
+uint16_t Board2048::emptyMask() const
+{
+    // Gather the flag bits spaced four apart into 16 consecutive bits
+    uint64_t m = ~occupiedNibbles(board) & 0x1111111111111111ULL;
+    m = (m | (m >> 3)) & 0x0303030303030303ULL;
+    m = (m | (m >> 6)) & 0x000F000F000F000FULL;
+    m = (m | (m >> 12)) & 0x000000FF000000FFULL;
+    m = m | (m >> 24);
+    return static_cast<uint16_t>(m);
+}
+
+/**
+ * @brief Checks if the board holds a 2048 tile.
+ * @return True if the game has been won, false otherwise.
+ */
+bool Board2048::checkWin() const
+{
+    // 2048 is exponent 11 (0xB): look for a nibble equal to 0xB
+    return (~occupiedNibbles(board ^ 0xBBBBBBBBBBBBBBBBULL) & 0x1111111111111111ULL) != 0;
+}
+
+/**
+ * @brief Checks if no move is possible anymore.
+ * @return True if the game has been lost, false otherwise.
+ */
+bool Board2048::checkLose() const
+{
+    if (emptyMask() != 0) {
+        return false;
+    }
+
+    // On a full board a row can only change through a merge, which the left table already reports
+    const RowTables &tables = rowTables();
+    uint64_t transposed = transpose(board);
+    for (int r = 0; r < 4; ++r) {
+        uint16_t row = static_cast<uint16_t>(board >> (16 * r));
+        uint16_t col = static_cast<uint16_t>(transposed >> (16 * r));
+        if (tables.left[row] != row || tables.left[col] != col) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Returns the largest tile on the board.
+ * @return The largest tile value, or 0 for an empty board.
+ */
+int Board2048::maxTile() const
+{
+    int best = 0;
+    for (int i = 0; i < CellCount; ++i) {
+        int e = static_cast<int>((board >> (4 * i)) & 0xF);
+        if (e > best) {
+            best = e;
+        }
+    }
+    return best == 0 ? 0 : 1 << best;
+}
+
+/**
+ * @brief Applies a move to a packed board without touching any object state.
+ * @param bits The packed board.
+ * @param direction The direction of the move.
+ * @param addedScore Receives the score gained by the merges.
+ * @return The packed board after the move.
+ */
+uint64_t Board2048::slide(uint64_t bits, Direction direction, int &addedScore)
+{
+    const RowTables &tables = rowTables();
+    addedScore = 0;
+    switch (direction) {
+    case Left:
+        return applyRows(bits, tables.left, addedScore);
+    case Right:
+        return applyRows(bits, tables.right, addedScore);
+    case Up:
+        return transpose(applyRows(transpose(bits), tables.left, addedScore));
+    case Down:
+        return transpose(applyRows(transpose(bits), tables.right, addedScore));
+    }
+    return bits;
+}
+
+/**
+ * @brief Transposes a packed board so that columns become rows.
+ * @param bits The packed board.
+ * @return The transposed packed board.
+ */
+uint64_t Board2048::transpose(uint64_t bits)
+{
+    // Swap the off-diagonal nibbles of each 2x2 block, then swap the off-diagonal 2x2 blocks
+    uint64_t a1 = bits & 0xF0F00F0FF0F00F0FULL;
+    uint64_t a2 = bits & 0x0000F0F00000F0F0ULL;
+    uint64_t a3 = bits & 0x0F0F00000F0F0000ULL;
+    uint64_t a = a1 | (a2 << 12) | (a3 >> 12);
+    uint64_t b1 = a & 0xFF00FF0000FF00FFULL;
+    uint64_t b2 = a & 0x00FF00FF00000000ULL;
+    uint64_t b3 = a & 0x00000000FF00FF00ULL;
+    return b1 | (b2 >> 24) | (b3 << 24);
+}
@@ -0,0 +1,161 @@
+/**
+ * @file board2048.h
+ * @brief Declares the Board2048 class, a headless bitboard engine for the 2048 game.
+ *
+ * The board is packed into a single 64-bit integer holding one 4-bit exponent per cell, so a board
+ * can be copied, hashed and compared as a plain integer. Moves are resolved with precomputed
+ * 65536-entry row tables; vertical moves transpose the board and reuse the same tables.
+ * The engine has no dependency on Qt widgets and can be used by tools and AI code alike.
+ */
+#ifndef BOARD2048_H
+#define BOARD2048_H
+
+#include <cstdint>
+
+class Rng2048;
+
+/**
+ * @class Board2048
+ * @brief The Board2048 class stores a 4x4 2048 board and applies moves to it.
+ *
+ * Cell (row, col) is stored in the nibble at bit offset 4 * (row * 4 + col). A nibble holds the
+ * exponent of the tile value (0 for an empty cell, 1 for 2, 2 for 4, ...), which caps tiles at
+ * 32768; two 32768 tiles never merge.
+ */
+class Board2048 {
+public:
+    /**
+     * @brief Directions in which the tiles can be slid.
+     */
+    enum Direction { Up, Down, Left, Right };
+
+    static constexpr int Size = 4;            ///< Number of rows and columns.
+    static constexpr int CellCount = 16;      ///< Number of cells on the board.
+    static constexpr int MaxExponent = 15;    ///< Largest exponent that fits in a nibble.
+
+    /**
+     * @brief Constructs an empty board.
+     */
+    Board2048();
+    /**
+     * @brief Constructs a board from its packed representation.
+     * @param bits The packed board.
+     */
+    explicit Board2048(uint64_t bits);
+
+    /**
+     * @brief Returns the packed representation of the board.
+     * @return The 64-bit packed board.
+     */
+    uint64_t bits() const { return board; }
+    /**
+     * @brief Returns the tile value stored in a cell.
+     * @param row The row index.
+     * @param col The column index.
+     * @return The tile value, or 0 if the cell is empty.
+     */
+    int cell(int row, int col) const;
+    /**
+     * @brief Returns the exponent stored in a cell.
+     * @param row The row index.
+     * @param col The column index.
+     * @return The exponent of the tile value, or 0 if the cell is empty.
+     */
+    int exponent(int row, int col) const;
+    /**
+     * @brief Stores a tile value in a cell.
+     * @param row The row index.
+     * @param col The column index.
+     * @param value The tile value (a power of two), or 0 to empty the cell.
+     */
+    void setCell(int row, int col, int value);
+    /**
+     * @brief Empties every cell of the board.
+     */
+    void clear();
+
+    /**
+     * @brief Slides and merges the tiles in the given direction.
+     * @param direction The direction of the move.
+     * @param addedScore If not null, receives the score gained by the merges.
+     * @return True if any tile moved or merged, false otherwise.
+     */
+    bool move(Direction direction, int *addedScore = nullptr);
+    /**
+     * @brief Checks whether a move in the given direction would change the board.
+     * @param direction The direction to test.
+     * @return True if the move is legal, false otherwise.
+     */
+    bool canMove(Direction direction) const;
+
+    /**
+     * @brief Places a 2 (90%) or a 4 (10%) on an empty cell chosen uniformly at random.
+     *
+     * The cell is picked straight from the empty-cell mask and every spawn consumes exactly one draw
+     * of the generator, so a game is fully determined by the seed of its generator.
+     * @param rng The generator of the game.
+     * @return True if a tile was placed, false if the board is full.
+     */
+    bool spawnTile(Rng2048 &rng);
+    /**
+     * @brief Places a tile on an empty cell chosen by 64 random bits.
+     * @param bits The packed board.
+     * @param random The random bits: the high half picks the cell, the low half the value.
+     * @return The packed board with the new tile, or the same board if it is full.
+     */
+    static uint64_t spawn(uint64_t bits, uint64_t random);
+
+    /**
+     * @brief Checks if there are equal non-empty tiles next to each other.
+     * @return True if adjacent duplicates are found, false otherwise.
+     */
+    bool hasAdjacentDuplicates() const;
+    /**
+     * @brief Counts the empty cells of the board.
+     * @return The number of empty cells.
+     */
+    int emptyCount() const;
+    /**
+     * @brief Returns a mask with bit (row * 4 + col) set for every empty cell.
+     * @return The 16-bit empty-cell mask.
+     */
+    uint16_t emptyMask() const;
+    /**
+     * @brief Checks if the board holds a 2048 tile.
+     * @return True if the game has been won, false otherwise.
+     */
+    bool checkWin() const;
+    /**
+     * @brief Checks if no move is possible anymore.
+     * @return True if the game has been lost, false otherwise.
+     */
+    bool checkLose() const;
+    /**
+     * @brief Returns the largest tile on the board.
+     * @return The largest tile value, or 0 for an empty board.
+     */
+    int maxTile() const;
+
+    /**
+     * @brief Applies a move to a packed board without touching any object state.
+     * @param bits The packed board.
+     * @param direction The direction of the move.
+     * @param addedScore Receives the score gained by the merges.
+     * @return The packed board after the move.
+     */
+    static uint64_t slide(uint64_t bits, Direction direction, int &addedScore);
+    /**
+     * @brief Transposes a packed board so that columns become rows.
+     * @param bits The packed board.
+     * @return The transposed packed board.
+     */
+    static uint64_t transpose(uint64_t bits);
+
+    bool operator==(const Board2048 &other) const { return board == other.board; }
+    bool operator!=(const Board2048 &other) const { return board != other.board; }
+
+private:
+    uint64_t board;
+};
+
+#endif // BOARD2048_H
@@ -0,0 +1,411 @@
+/**
+ * @file boardview2048.cpp
+ * @brief Implementation of the BoardView2048 widget.
+ */
+#include "boardview2048.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <bit>
+
+/**
+ * @brief Constructs an empty board view.
+ * @param parent The parent widget.
+ */
+BoardView2048::BoardView2048(QWidget *parent)
+    : QWidget(parent)
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+
+    animationTimer.setTimerType(Qt::PreciseTimer);
+    animationTimer.setInterval(FrameInterval);
+    connect(&animationTimer, &QTimer::timeout, this, &BoardView2048::advanceAnimation);
+}
+
+/**
+ * @brief Shows a board, repainting only the cells that changed.
+ * @param board The board to show.
+ */
+void BoardView2048::setBoard(const GridBoard2048 &board)
+{
+    if (board.size() != shown.size()) {
+        // Every cell moves when the board size changes
+        animationTimer.stop();
+        motionCount = 0;
+        shown = board;
+        updateCellSize();
+        update();
+        return;
+    }
+    if (isAnimating()) {
+        // The sliding tiles are drawn all over the board, so repaint all of it
+        animationTimer.stop();
+        motionCount = 0;
+        shown = board;
+        update(animationRect());
+        return;
+    }
+
+    int n = shown.size();
+    for (int row = 0; row < n; ++row) {
+        uint64_t changed = shown.row(row) ^ board.row(row);
+        for (int col = 0; changed != 0; ++col, changed >>= 8) {
+            if (changed & 0xFF) {
+                update(cellRect(row, col));
+            }
+        }
+    }
+    shown = board;
+}
+
+/**
+ * @brief Animates the tiles of a move, then shows the board after the move.
+ * @param before The board before the move.
+ * @param direction The direction of the move.
+ * @param after The board after the move, including any spawned tile.
+ */
+void BoardView2048::animateMove(const GridBoard2048 &before, Board2048::Direction direction, const GridBoard2048 &after)
+{
+    finishAnimation();
+    if (before == after || after.size() != shown.size()) {
+        setBoard(after);
+        return;
+    }
+
+    // The final board is shown as soon as the last frame is reached or the animation is cut short
+    shown = after;
+    motionCount = before.traceMove(direction, motions);
+
+    // A tile of the final board that no motion lands on was spawned after the move
+    uint64_t destinations = 0;
+    mergedCells = 0;
+    for (int i = 0; i < motionCount; ++i) {
+        uint64_t bit = uint64_t(1) << motions[i].toCell;
+        destinations |= bit;
+        if (motions[i].merged) {
+            mergedCells |= bit;
+        }
+    }
+    spawnedCells = 0;
+    int n = after.size();
+    for (int row = 0; row < n; ++row) {
+        for (int col = 0; col < n; ++col) {
+            uint64_t bit = uint64_t(1) << (row * GridBoard2048::MaxSize + col);
+            if (after.exponent(row, col) != 0 && !(destinations & bit)) {
+                spawnedCells |= bit;
+            }
+        }
+    }
+    frame = 0;
+    animationTimer.start();
+    update(animationRect());
+}
+
+/**
+ * @brief Jumps to the end of the running animation, if any.
+ */
+void BoardView2048::finishAnimation()
+{
+    if (isAnimating()) {
+        animationTimer.stop();
+        motionCount = 0;
+        update(animationRect());
+    }
+}
+
+/**
+ * @brief Advances the animation by one frame.
+ */
+void BoardView2048::advanceAnimation()
+{
+    if (++frame >= FrameCount + PopFrameCount) {
+        finishAnimation();
+    } else {
+        update(animationRect());
+    }
+}
+
+/**
+ * @brief Sets the background color of the tiles.
+ * @param color The tile color.
+ */
+void BoardView2048::setTileColor(const QColor &color)
+{
+    tileColor = color;
+    dropSprites();
+    update();
+}
+
+/**
+ * @brief Sets the color of the numbers on the tiles.
+ * @param color The text color.
+ */
+void BoardView2048::setTextColor(const QColor &color)
+{
+    textColor = color;
+    dropSprites();
+    update();
+}
+
+/**
+ * @brief Highlights the row or column at the edge the tiles would slide towards.
+ * @param direction The direction to highlight.
+ */
+void BoardView2048::setHighlight(Board2048::Direction direction)
+{
+    clearHighlight();
+    highlightActive = true;
+    highlightDirection = direction;
+    updateHighlightedCells();
+}
+
+/**
+ * @brief Removes the highlight set by setHighlight().
+ */
+void BoardView2048::clearHighlight()
+{
+    if (highlightActive) {
+        updateHighlightedCells();
+        highlightActive = false;
+    }
+}
+
+/**
+ * @brief Returns the preferred size of the view.
+ * @return The size of a 4x4 board with 120-pixel cells, whatever the board size.
+ */
+QSize BoardView2048::sizeHint() const
+{
+    return QSize(BoardSide, BoardSide);
+}
+
+/**
+ * @brief Paints the cells inside the exposed region from the cached sprites.
+ * @param event The paint event.
+ */
+void BoardView2048::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    int n = shown.size();
+    const QRegion &region = event->region();
+
+    if (isAnimating() && frame < FrameCount) {
+        // Empty cells first, then every tile at its interpolated position (ease-out)
+        const QPixmap &empty = sprite(0, false);
+        for (int row = 0; row < n; ++row) {
+            for (int col = 0; col < n; ++col) {
+                painter.drawPixmap(cellRect(row, col).topLeft(), empty);
+            }
+        }
+        qreal t = static_cast<qreal>(frame) / FrameCount;
+        t = 1.0 - (1.0 - t) * (1.0 - t);
+        for (int i = 0; i < motionCount; ++i) {
+            const GridBoard2048::TileMotion &motion = motions[i];
+            QPointF from = cellRect(motion.fromCell / GridBoard2048::MaxSize, motion.fromCell % GridBoard2048::MaxSize).topLeft();
+            QPointF to = cellRect(motion.toCell / GridBoard2048::MaxSize, motion.toCell % GridBoard2048::MaxSize).topLeft();
+            painter.drawPixmap(from + (to - from) * t, sprite(motion.exponent, false));
+        }
+        return;
+    }
+
+    if (isAnimating()) {
+        // The final board, then merged tiles swelling and back and spawned tiles growing in on top
+        qreal t = static_cast<qreal>(frame - FrameCount + 1) / PopFrameCount;
+        uint64_t popping = mergedCells | spawnedCells;
+        for (int row = 0; row < n; ++row) {
+            for (int col = 0; col < n; ++col) {
+                bool pops = (popping >> (row * GridBoard2048::MaxSize + col)) & 1;
+                painter.drawPixmap(cellRect(row, col).topLeft(), sprite(pops ? 0 : shown.exponent(row, col), false));
+            }
+        }
+        for (uint64_t cells = mergedCells; cells != 0; cells &= cells - 1) {
+            drawScaledTile(painter, std::countr_zero(cells), 1.0 + PopSwell * (1.0 - qAbs(2.0 * t - 1.0)));
+        }
+        for (uint64_t cells = spawnedCells; cells != 0; cells &= cells - 1) {
+            drawScaledTile(painter, std::countr_zero(cells), t);
+        }
+        return;
+    }
+
+    for (int row = 0; row < n; ++row) {
+        for (int col = 0; col < n; ++col) {
+            QRect rect = cellRect(row, col);
+            if (!region.intersects(rect)) {
+                continue;
+            }
+            painter.drawPixmap(rect.topLeft(), sprite(shown.exponent(row, col), isHighlighted(row, col)));
+        }
+    }
+}
+
+/**
+ * @brief Recomputes the cell size and drops the sprites rendered for the old size.
+ * @param event The resize event.
+ */
+void BoardView2048::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    updateCellSize();
+}
+
+/**
+ * @brief Recomputes the cell size from the widget size and the board size.
+ */
+void BoardView2048::updateCellSize()
+{
+    int n = shown.size();
+    int size = qMax(1, (qMin(width(), height()) - (n - 1) * Spacing) / n);
+    if (size != cellSize) {
+        cellSize = size;
+        dropSprites();
+    }
+}
+
+/**
+ * @brief Returns the rectangle covered by a cell.
+ * @param row The row index.
+ * @param col The column index.
+ * @return The cell rectangle in widget coordinates.
+ */
+QRect BoardView2048::cellRect(int row, int col) const
+{
+    int n = shown.size();
+    int side = n * cellSize + (n - 1) * Spacing;
+    int left = (width() - side) / 2;
+    int top = (height() - side) / 2;
+    return QRect(left + col * (cellSize + Spacing), top + row * (cellSize + Spacing), cellSize, cellSize);
+}
+
+/**
+ * @brief Returns the rectangle covered by the whole board.
+ * @return The board rectangle in widget coordinates.
+ */
+QRect BoardView2048::boardRect() const
+{
+    int last = shown.size() - 1;
+    return cellRect(0, 0).united(cellRect(last, last));
+}
+
+/**
+ * @brief Returns the rectangle an animation may paint, the board plus the overhang of a popping tile.
+ * @return The animated rectangle in widget coordinates.
+ */
+QRect BoardView2048::animationRect() const
+{
+    int margin = static_cast<int>(cellSize * PopSwell / 2.0) + 1;
+    return boardRect().adjusted(-margin, -margin, margin, margin);
+}
+
+/**
+ * @brief Checks if a cell lies on the highlighted edge.
+ * @param row The row index.
+ * @param col The column index.
+ * @return True if the cell is highlighted, false otherwise.
+ */
+bool BoardView2048::isHighlighted(int row, int col) const
+{
+    if (!highlightActive) {
+        return false;
+    }
+    switch (highlightDirection) {
+    case Board2048::Up:
+        return row == 0;
+    case Board2048::Down:
+        return row == shown.size() - 1;
+    case Board2048::Left:
+        return col == 0;
+    case Board2048::Right:
+        return col == shown.size() - 1;
+    }
+    return false;
+}
+
+/**
+ * @brief Drops the sprites rendered for the old cell size or colors.
+ */
+void BoardView2048::dropSprites()
+{
+    for (int e = 0; e <= GridBoard2048::MaxExponent; ++e) {
+        sprites[e] = QPixmap();
+        highlightSprites[e] = QPixmap();
+    }
+}
+
+/**
+ * @brief Returns the sprite of a tile value, rendering it on first use.
+ * @param exponent The exponent of the tile value, or 0 for an empty cell.
+ * @param highlighted True for the highlighted variant.
+ * @return The tile sprite.
+ */
+const QPixmap &BoardView2048::sprite(int exponent, bool highlighted)
+{
+    QPixmap &pixmap = highlighted ? highlightSprites[exponent] : sprites[exponent];
+    if (pixmap.isNull()) {
+        pixmap = renderTile(exponent, highlighted ? QColor(Qt::yellow) : tileColor);
+    }
+    return pixmap;
+}
+
+/**
+ * @brief Renders one tile into a pixmap.
+ * @param exponent The exponent of the tile value, or 0 for an empty cell.
+ * @param fill The background color of the tile.
+ * @return The tile pixmap.
+ */
+QPixmap BoardView2048::renderTile(int exponent, const QColor &fill) const
+{
+    qreal ratio = devicePixelRatioF();
+    QPixmap pixmap(QSize(cellSize, cellSize) * ratio);
+    pixmap.setDevicePixelRatio(ratio);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(fill);
+    painter.drawRoundedRect(QRectF(0, 0, cellSize, cellSize), cellSize / 12.0, cellSize / 12.0);
+
+    if (exponent > 0) {
+        QString text = QString::number(1 << exponent);
+        QFont font = this->font();
+        font.setBold(true);
+        // Shrink the glyphs as the number gets longer so that it always fits the tile
+        font.setPixelSize(qMax(1, static_cast<int>(cellSize * (text.size() <= 2 ? 0.45 : 1.1 / text.size()))));
+        painter.setFont(font);
+        painter.setPen(textColor);
+        painter.drawText(QRectF(0, 0, cellSize, cellSize), Qt::AlignCenter, text);
+    }
+    return pixmap;
+}
+
+/**
+ * @brief Draws a tile scaled about the center of its cell.
+ * @param painter The painter of the widget.
+ * @param cell The cell index, row * GridBoard2048::MaxSize + col.
+ * @param scale The scale of the tile, 1 for its normal size.
+ */
+void BoardView2048::drawScaledTile(QPainter &painter, int cell, qreal scale)
+{
+    int row = cell / GridBoard2048::MaxSize;
+    int col = cell % GridBoard2048::MaxSize;
+    QRectF rect = cellRect(row, col);
+    qreal side = cellSize * scale;
+    QRectF target(rect.center().x() - side / 2.0, rect.center().y() - side / 2.0, side, side);
+    const QPixmap &pixmap = sprite(shown.exponent(row, col), false);
+    painter.drawPixmap(target, pixmap, QRectF(pixmap.rect()));
+}
+
+/**
+ * @brief Schedules a repaint of the highlighted edge.
+ */
+void BoardView2048::updateHighlightedCells()
+{
+    int n = shown.size();
+    for (int row = 0; row < n; ++row) {
+        for (int col = 0; col < n; ++col) {
+            if (isHighlighted(row, col)) {
+                update(cellRect(row, col));
+            }
+        }
+    }
+}
@@ -0,0 +1,174 @@
+/**
+ * @file boardview2048.h
+ * @brief Declares the BoardView2048 class, a custom-painted widget showing a 2048 board of any size.
+ */
+#ifndef BOARDVIEW2048_H
+#define BOARDVIEW2048_H
+
+#include <QWidget>
+#include <QColor>
+#include <QPainter>
+#include <QPixmap>
+#include <QTimer>
+#include "gridboard2048.h"
+
+/**
+ * @class BoardView2048
+ * @brief The BoardView2048 class paints a 2048 board with QPainter from cached tile sprites.
+ *
+ * Each tile value is rendered once into a sprite pixmap for the current cell size and colors, the
+ * first time it is shown.
+ * setBoard() compares the new board with the one on screen and only schedules a repaint of the
+ * cells whose value changed, so a move costs a handful of pixmap blits instead of a text, layout
+ * and stylesheet update on a grid of buttons.
+ *
+ * animateMove() slides the tiles of a move from their source to their destination cells, then pops
+ * the merged tiles up and back and grows the spawned tile from the center of its cell. Frames
+ * advance on a fixed 16 ms clock and interpolate between precomputed motions stored in a fixed
+ * array, so no frame allocates. A new move or board finishes the running animation at once.
+ */
+class BoardView2048 : public QWidget {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs an empty board view.
+     * @param parent The parent widget.
+     */
+    explicit BoardView2048(QWidget *parent = nullptr);
+
+    /**
+     * @brief Shows a board, repainting only the cells that changed.
+     * @param board The board to show.
+     */
+    void setBoard(const GridBoard2048 &board);
+    /**
+     * @brief Animates the tiles of a move, then shows the board after the move.
+     * @param before The board before the move.
+     * @param direction The direction of the move.
+     * @param after The board after the move, including any spawned tile.
+     */
+    void animateMove(const GridBoard2048 &before, Board2048::Direction direction, const GridBoard2048 &after);
+    /**
+     * @brief Jumps to the end of the running animation, if any.
+     */
+    void finishAnimation();
+    /**
+     * @brief Checks if an animation is running.
+     * @return True while tiles are sliding or popping, false otherwise.
+     */
+    bool isAnimating() const { return motionCount > 0; }
+    /**
+     * @brief Sets the background color of the tiles.
+     * @param color The tile color.
+     */
+    void setTileColor(const QColor &color);
+    /**
+     * @brief Sets the color of the numbers on the tiles.
+     * @param color The text color.
+     */
+    void setTextColor(const QColor &color);
+    /**
+     * @brief Highlights the row or column at the edge the tiles would slide towards.
+     * @param direction The direction to highlight.
+     */
+    void setHighlight(Board2048::Direction direction);
+    /**
+     * @brief Removes the highlight set by setHighlight().
+     */
+    void clearHighlight();
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    static constexpr int Spacing = 6;           ///< Gap between two cells, in pixels.
+    static constexpr int FrameInterval = 16;    ///< Animation clock period, in milliseconds.
+    static constexpr int FrameCount = 6;        ///< Number of frames a slide lasts.
+    static constexpr int PopFrameCount = 4;     ///< Number of frames the merge and spawn pop lasts, after the slide.
+    static constexpr qreal PopSwell = 0.2;      ///< Growth of a merged tile at the peak of its pop, as a fraction of its side.
+    static constexpr int BoardSide = 4 * 120 + 3 * Spacing;    ///< Preferred side of the board, in pixels.
+
+    /**
+     * @brief Advances the animation by one frame.
+     */
+    void advanceAnimation();
+    /**
+     * @brief Returns the rectangle covered by the whole board.
+     * @return The board rectangle in widget coordinates.
+     */
+    QRect boardRect() const;
+    /**
+     * @brief Returns the rectangle an animation may paint, the board plus the overhang of a popping tile.
+     * @return The animated rectangle in widget coordinates.
+     */
+    QRect animationRect() const;
+
+    /**
+     * @brief Returns the rectangle covered by a cell.
+     * @param row The row index.
+     * @param col The column index.
+     * @return The cell rectangle in widget coordinates.
+     */
+    QRect cellRect(int row, int col) const;
+    /**
+     * @brief Checks if a cell lies on the highlighted edge.
+     * @param row The row index.
+     * @param col The column index.
+     * @return True if the cell is highlighted, false otherwise.
+     */
+    bool isHighlighted(int row, int col) const;
+    /**
+     * @brief Recomputes the cell size from the widget size and the board size.
+     */
+    void updateCellSize();
+    /**
+     * @brief Drops the sprites rendered for the old cell size or colors.
+     */
+    void dropSprites();
+    /**
+     * @brief Returns the sprite of a tile value, rendering it on first use.
+     * @param exponent The exponent of the tile value, or 0 for an empty cell.
+     * @param highlighted True for the highlighted variant.
+     * @return The tile sprite.
+     */
+    const QPixmap &sprite(int exponent, bool highlighted);
+    /**
+     * @brief Renders one tile into a pixmap.
+     * @param exponent The exponent of the tile value, or 0 for an empty cell.
+     * @param fill The background color of the tile.
+     * @return The tile pixmap.
+     */
+    QPixmap renderTile(int exponent, const QColor &fill) const;
+    /**
+     * @brief Schedules a repaint of the highlighted edge.
+     */
+    void updateHighlightedCells();
+    /**
+     * @brief Draws a tile scaled about the center of its cell.
+     * @param painter The painter of the widget.
+     * @param cell The cell index, row * GridBoard2048::MaxSize + col.
+     * @param scale The scale of the tile, 1 for its normal size.
+     */
+    void drawScaledTile(QPainter &painter, int cell, qreal scale);
+
+    GridBoard2048 shown;
+    int cellSize = 0;
+    bool highlightActive = false;
+    Board2048::Direction highlightDirection = Board2048::Up;
+    QColor tileColor = QColor(0xD4, 0x99, 0x87);
+    QColor textColor = QColor(0x8E, 0x75, 0x3D);
+    QPixmap sprites[GridBoard2048::MaxExponent + 1];
+    QPixmap highlightSprites[GridBoard2048::MaxExponent + 1];
+    QTimer animationTimer;
+    GridBoard2048::TileMotion motions[GridBoard2048::MaxSize * GridBoard2048::MaxSize];
+    int motionCount = 0;
+    uint64_t mergedCells = 0;     ///< Destination cells of merges, bit row * MaxSize + col.
+    uint64_t spawnedCells = 0;    ///< Cells of the tiles spawned after the move.
+    int frame = 0;
+};
+
+#endif // BOARDVIEW2048_H
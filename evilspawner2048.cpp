@@ -0,0 +1,200 @@
+/**
+ * @file evilspawner2048.cpp
+ * @brief Implementation of the EvilSpawner2048 adversarial spawn search.
+ */
+#include "evilspawner2048.h"
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace {
+
+const float Infinity = std::numeric_limits<float>::infinity();
+const float LostValue = -std::numeric_limits<float>::max();    ///< Value of a position with no legal move.
+
+} // namespace
+
+/**
+ * @brief Constructs a spawner with the given depth.
+ * @param depth The number of player moves to look ahead at most.
+ */
+EvilSpawner2048::EvilSpawner2048(int depth)
+{
+    setDepth(depth);
+}
+
+/**
+ * @brief Sets the number of player moves to look ahead at most.
+ * @param depth The search depth, clamped to [1, 8].
+ */
+void EvilSpawner2048::setDepth(int depth)
+{
+    searchDepth = std::clamp(depth, 1, 8);
+}
+
+/**
+ * @brief Scores the positions with a set of tuned weights instead of the default ones.
+ * @param heuristic The heuristic, or nullptr to go back to the default weights.
+ */
+void EvilSpawner2048::setHeuristic(const Heuristic2048 *heuristic)
+{
+    staticHeuristic = heuristic != nullptr ? heuristic : &Heuristic2048::standard();
+}
+
+/**
+ * @brief Finds the spawn that leaves the player the worst position, within a time limit.
+ * @param bits The packed board after the player's move.
+ * @param timeLimitMs The time limit, in milliseconds.
+ * @return The packed board with the new tile, or the same board if it is full.
+ */
+uint64_t EvilSpawner2048::worstSpawn(uint64_t bits, int timeLimitMs)
+{
+    nodes = 0;
+    completedDepth = 0;
+    stopping = false;
+    deadline = QDeadlineTimer(timeLimitMs, Qt::PreciseTimer);
+
+    uint64_t children[MaxSpawns];
+    float values[MaxSpawns];
+    int count = orderedSpawns(bits, children);
+    if (count == 0) {
+        return bits;
+    }
+
+    uint64_t worst = children[0];
+    for (int depth = 1; depth <= searchDepth; ++depth) {
+        float beta = Infinity;
+        int worstIndex = 0;
+        for (int i = 0; i < count && !stopping; ++i) {
+            // A child cut off by beta only gets a lower bound, which still ranks it behind the worst
+            values[i] = moveNode(children[i], depth, -Infinity, beta);
+            if (values[i] < beta) {
+                beta = values[i];
+                worstIndex = i;
+            }
+        }
+        if (stopping) {
+            break;
+        }
+        worst = children[worstIndex];
+        completedDepth = depth;
+        // A forced loss cannot get any worse for the player
+        if (beta == LostValue || deadline.hasExpired()) {
+            break;
+        }
+
+        // Search the spawns that hurt most in this iteration first in the next one
+        for (int i = 1; i < count; ++i) {
+            uint64_t child = children[i];
+            float value = values[i];
+            int j = i;
+            for (; j > 0 && values[j - 1] > value; --j) {
+                children[j] = children[j - 1];
+                values[j] = values[j - 1];
+            }
+            children[j] = child;
+            values[j] = value;
+        }
+    }
+    return worst;
+}
+
+/**
+ * @brief Lists every spawn of a position, ordered by static value.
+ * @param bits The packed board.
+ * @param children Receives the packed boards with the new tile, lowest value first.
+ * @return The number of spawns.
+ */
+int EvilSpawner2048::orderedSpawns(uint64_t bits, uint64_t children[MaxSpawns]) const
+{
+    float values[MaxSpawns];
+    int count = 0;
+    for (uint32_t empty = Board2048(bits).emptyMask(); empty != 0; empty &= empty - 1) {
+        uint64_t tile = 1ULL << (4 * std::countr_zero(empty));
+        for (uint64_t spawned : { bits | tile, bits | (tile << 1) }) {
+            float value = staticHeuristic->evaluate(spawned);
+            int j = count++;
+            for (; j > 0 && values[j - 1] > value; --j) {
+                children[j] = children[j - 1];
+                values[j] = values[j - 1];
+            }
+            children[j] = spawned;
+            values[j] = value;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Scores a position where the adversary is about to place a tile.
+ * @param bits The packed board.
+ * @param depthLeft The number of player moves left to search.
+ * @param alpha The value the player is already sure of.
+ * @param beta The value the adversary is already sure of.
+ * @return The value of the worst spawn for the player.
+ */
+float EvilSpawner2048::spawnNode(uint64_t bits, int depthLeft, float alpha, float beta)
+{
+    if (depthLeft == 0) {
+        return staticHeuristic->evaluate(bits);
+    }
+    uint64_t children[MaxSpawns];
+    int count = orderedSpawns(bits, children);
+    float worst = Infinity;
+    for (int i = 0; i < count; ++i) {
+        worst = std::min(worst, moveNode(children[i], depthLeft, alpha, beta));
+        beta = std::min(beta, worst);
+        if (alpha >= beta) {
+            break;
+        }
+    }
+    return count > 0 ? worst : staticHeuristic->evaluate(bits);
+}
+
+/**
+ * @brief Scores a position where the player is to move.
+ * @param bits The packed board.
+ * @param depthLeft The number of player moves left to search.
+ * @param alpha The value the player is already sure of.
+ * @param beta The value the adversary is already sure of.
+ * @return The value of the best move, lower than any position if the game is lost.
+ */
+float EvilSpawner2048::moveNode(uint64_t bits, int depthLeft, float alpha, float beta)
+{
+    // Depth 1 always completes, so there is a spawn to fall back on
+    if ((++nodes & 0xFF) == 0 && completedDepth > 0 && deadline.hasExpired()) {
+        stopping = true;
+    }
+    if (stopping) {
+        return 0.0f;
+    }
+
+    uint64_t moves[4];
+    float values[4];
+    int count = 0;
+    for (int d = 0; d < 4; ++d) {
+        int addedScore = 0;
+        uint64_t next = Board2048::slide(bits, static_cast<Board2048::Direction>(d), addedScore);
+        if (next == bits) {
+            continue;
+        }
+        float value = staticHeuristic->evaluate(next);
+        int j = count++;
+        for (; j > 0 && values[j - 1] < value; --j) {
+            moves[j] = moves[j - 1];
+            values[j] = values[j - 1];
+        }
+        moves[j] = next;
+        values[j] = value;
+    }
+
+    float best = LostValue;
+    for (int i = 0; i < count; ++i) {
+        best = std::max(best, spawnNode(moves[i], depthLeft - 1, alpha, beta));
+        alpha = std::max(alpha, best);
+        if (alpha >= beta) {
+            break;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file evilspawner2048.h
+ * @brief Declares the EvilSpawner2048 class, an adversary that places the 2048 tiles where they hurt most.
+ *
+ * In hard mode the new tile is not random: the spawner searches every empty cell receiving a 2 or
+ * a 4, up to 30 options, and places the one that leaves the player the worst position. Spawn nodes
+ * minimise and move nodes maximise the player's heuristic value, so the search is a plain minimax
+ * with alpha-beta pruning on packed Board2048 positions.
+ *
+ * Alpha-beta only pays off when the best reply is searched first, so the children of every node
+ * are ordered by their static value: lowest first for spawns, highest first for moves. The root
+ * spawns are reordered by the values of the previous iteration. worstSpawn() deepens one ply at a
+ * time until a deadline of a few milliseconds, so a spawn always fits in a frame of the game, and
+ * keeps the spawn of the deepest iteration that finished.
+ */
+#ifndef EVILSPAWNER2048_H
+#define EVILSPAWNER2048_H
+
+#include "board2048.h"
+#include "heuristic2048.h"
+#include <QDeadlineTimer>
+#include <cstdint>
+
+/**
+ * @class EvilSpawner2048
+ * @brief The EvilSpawner2048 class picks the worst new tile for the player of a 2048 position.
+ */
+class EvilSpawner2048 {
+public:
+    static constexpr int DefaultDepth = 4;      ///< Deepest iteration, in player moves.
+    static constexpr int DefaultTimeMs = 8;     ///< Time limit of a spawn, half a frame.
+    static constexpr int MaxSpawns = 2 * Board2048::CellCount;    ///< A 2 or a 4 on each cell.
+
+    /**
+     * @brief Constructs a spawner with the given depth.
+     * @param depth The number of player moves to look ahead at most.
+     */
+    explicit EvilSpawner2048(int depth = DefaultDepth);
+
+    /**
+     * @brief Sets the number of player moves to look ahead at most.
+     * @param depth The search depth, clamped to [1, 8].
+     */
+    void setDepth(int depth);
+    /**
+     * @brief Returns the number of player moves looked ahead at most.
+     * @return The search depth.
+     */
+    int depth() const { return searchDepth; }
+    /**
+     * @brief Scores the positions with a set of tuned weights instead of the default ones.
+     *
+     * The heuristic must outlive the spawner.
+     * @param heuristic The heuristic, or nullptr to go back to the default weights.
+     */
+    void setHeuristic(const Heuristic2048 *heuristic);
+
+    /**
+     * @brief Finds the spawn that leaves the player the worst position, within a time limit.
+     *
+     * Depth 1 always completes, so a spawn is found however short the limit.
+     * @param bits The packed board after the player's move.
+     * @param timeLimitMs The time limit, in milliseconds.
+     * @return The packed board with the new tile, or the same board if it is full.
+     */
+    uint64_t worstSpawn(uint64_t bits, int timeLimitMs = DefaultTimeMs);
+    /**
+     * @brief Returns the number of positions visited by the last search.
+     * @return The node count.
+     */
+    uint64_t nodeCount() const { return nodes; }
+    /**
+     * @brief Returns the depth of the deepest iteration the last search finished.
+     * @return The reached depth.
+     */
+    int reachedDepth() const { return completedDepth; }
+
+private:
+    /**
+     * @brief Lists every spawn of a position, ordered by static value.
+     * @param bits The packed board.
+     * @param children Receives the packed boards with the new tile, lowest value first.
+     * @return The number of spawns.
+     */
+    int orderedSpawns(uint64_t bits, uint64_t children[MaxSpawns]) const;
+    /**
+     * @brief Scores a position where the adversary is about to place a tile.
+     * @param bits The packed board.
+     * @param depthLeft The number of player moves left to search.
+     * @param alpha The value the player is already sure of.
+     * @param beta The value the adversary is already sure of.
+     * @return The value of the worst spawn for the player.
+     */
+    float spawnNode(uint64_t bits, int depthLeft, float alpha, float beta);
+    /**
+     * @brief Scores a position where the player is to move.
+     * @param bits The packed board.
+     * @param depthLeft The number of player moves left to search.
+     * @param alpha The value the player is already sure of.
+     * @param beta The value the adversary is already sure of.
+     * @return The value of the best move, lower than any position if the game is lost.
+     */
+    float moveNode(uint64_t bits, int depthLeft, float alpha, float beta);
+
+    int searchDepth;
+    int completedDepth = 0;
+    uint64_t nodes = 0;
+    bool stopping = false;
+    QDeadlineTimer deadline;
+    const Heuristic2048 *staticHeuristic = &Heuristic2048::standard();
+};
+
+#endif // EVILSPAWNER2048_H
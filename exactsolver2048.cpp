@@ -0,0 +1,547 @@
+/**
+ * @file exactsolver2048.cpp
+ * @brief Implementation of the ExactSolver2048 small-board solver.
+ */
+#include "exactsolver2048.h"
+#include <QSaveFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+const char Magic[8] = { 'E', 'X', 'C', 'T', '2', '0', '4', '8' };
+const uint32_t FileVersion = 1;
+const qsizetype ChunkSize = 1 << 16;    ///< Positions per parallel work item.
+
+// Layout of a table entry: the position, then its optimal move, then its value in fixed point
+const int StateBits = 4 * ExactSolver2048::MaxSide * ExactSolver2048::MaxSide;
+const uint64_t StateMask = (1ULL << StateBits) - 1;
+const int MoveShift = StateBits;             ///< 2 bits of direction.
+const uint64_t HasMoveBit = 1ULL << (StateBits + 2);
+const int ValueShift = StateBits + 3;        ///< 25 bits of value.
+const double ValueScale = 256.0;             ///< Value units per point of score.
+
+/**
+ * @brief Packs a solved position into a table entry.
+ * @param state The packed canonical position.
+ * @param move The optimal direction, or -1 if the game is lost.
+ * @param value The expected score.
+ * @return The entry.
+ */
+uint64_t makeEntry(uint64_t state, int move, double value)
+{
+    uint64_t entry = state | (static_cast<uint64_t>(std::llround(value * ValueScale)) << ValueShift);
+    if (move >= 0) {
+        entry |= HasMoveBit | (static_cast<uint64_t>(move) << MoveShift);
+    }
+    return entry;
+}
+
+/**
+ * @brief A slice of a layer processed by one work item, and the positions it reached.
+ */
+struct LayerChunk {
+    qsizetype begin;
+    qsizetype end;
+    QVector<uint64_t> next[2];    ///< Positions one and two layers further, after a 2 and a 4 spawned.
+};
+
+/**
+ * @brief Splits a layer into work items.
+ * @param size The number of positions in the layer.
+ * @return The work items.
+ */
+QVector<LayerChunk> chunksFor(qsizetype size)
+{
+    QVector<LayerChunk> chunks;
+    for (qsizetype begin = 0; begin < size; begin += ChunkSize) {
+        LayerChunk chunk;
+        chunk.begin = begin;
+        chunk.end = std::min(size, begin + ChunkSize);
+        chunks.append(chunk);
+    }
+    return chunks;
+}
+
+/**
+ * @brief Sorts positions and drops the duplicates.
+ * @param states The positions.
+ */
+void sortUnique(QVector<uint64_t> &states)
+{
+    std::sort(states.begin(), states.end());
+    states.erase(std::unique(states.begin(), states.end()), states.end());
+    states.squeeze();
+}
+
+} // namespace
+
+/**
+ * @brief Constructs an empty solver for the given board shape.
+ * @param rows The number of rows, clamped to [MinSide, MaxSide].
+ * @param columns The number of columns, clamped to [MinSide, MaxSide].
+ */
+ExactSolver2048::ExactSolver2048(int rows, int columns)
+    : rowCount(std::clamp(rows, MinSide, MaxSide)),
+      columnCount(std::clamp(columns, MinSide, MaxSide)),
+      cellCount(rowCount * columnCount)
+{
+    // Cells of each line, starting from the edge the tiles slide towards
+    for (int line = 0; line < MaxSide; ++line) {
+        for (int i = 0; i < MaxSide; ++i) {
+            int row = std::min(line, rowCount - 1);
+            int col = std::min(i, columnCount - 1);
+            lineCells[Board2048::Left][line][i] = row * columnCount + col;
+            lineCells[Board2048::Right][line][i] = row * columnCount + (columnCount - 1 - col);
+            row = std::min(i, rowCount - 1);
+            col = std::min(line, columnCount - 1);
+            lineCells[Board2048::Up][line][i] = row * columnCount + col;
+            lineCells[Board2048::Down][line][i] = (rowCount - 1 - row) * columnCount + col;
+        }
+    }
+
+    // Rotations and reflections: optionally swap rows and columns, then mirror either axis. Only
+    // square boards can swap; each also maps the direction vector of a move
+    symmetryCount = 0;
+    for (int swap = 0; swap < (rowCount == columnCount ? 2 : 1); ++swap) {
+        for (int flip = 0; flip < 4; ++flip) {
+            uint8_t *cells = symmetryCells[symmetryCount];
+            for (int row = 0; row < rowCount; ++row) {
+                for (int col = 0; col < columnCount; ++col) {
+                    int r = swap ? col : row;
+                    int c = swap ? row : col;
+                    r = (flip & 1) ? rowCount - 1 - r : r;
+                    c = (flip & 2) ? columnCount - 1 - c : c;
+                    cells[row * columnCount + col] = r * columnCount + c;
+                }
+            }
+            const int vectors[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+            for (int d = 0; d < 4; ++d) {
+                int dr = swap ? vectors[d][1] : vectors[d][0];
+                int dc = swap ? vectors[d][0] : vectors[d][1];
+                dr = (flip & 1) ? -dr : dr;
+                dc = (flip & 2) ? -dc : dc;
+                for (int m = 0; m < 4; ++m) {
+                    if (vectors[m][0] == dr && vectors[m][1] == dc) {
+                        symmetryMoves[symmetryCount][d] = m;
+                    }
+                }
+            }
+            ++symmetryCount;
+        }
+    }
+
+    // Each row of a position moved by each symmetry, so that a variant costs one lookup per row
+    int rowStates = 1 << (4 * columnCount);
+    for (int k = 0; k < symmetryCount; ++k) {
+        for (int row = 0; row < rowCount; ++row) {
+            symmetryRows[k][row].resize(rowStates);
+            for (int bits = 0; bits < rowStates; ++bits) {
+                uint64_t moved = 0;
+                for (int col = 0; col < columnCount; ++col) {
+                    uint64_t e = (bits >> (4 * col)) & 0xF;
+                    moved |= e << (4 * symmetryCells[k][row * columnCount + col]);
+                }
+                symmetryRows[k][row][bits] = moved;
+            }
+        }
+    }
+
+    // Slide of every line of every length towards its first cell
+    for (int length = MinSide; length <= MaxSide; ++length) {
+        int lineCount = 1 << (4 * length);
+        slidLines[length].resize(lineCount);
+        lineScores[length].resize(lineCount);
+        for (int line = 0; line < lineCount; ++line) {
+            int tiles[MaxSide];
+            int tileCount = 0;
+            for (int i = 0; i < length; ++i) {
+                int e = (line >> (4 * i)) & 0xF;
+                if (e != 0) {
+                    tiles[tileCount++] = e;
+                }
+            }
+            int result = 0;
+            int placed = 0;
+            int score = 0;
+            for (int i = 0; i < tileCount; ++i) {
+                int e = tiles[i];
+                if (i + 1 < tileCount && tiles[i + 1] == e && e < Board2048::MaxExponent) {
+                    ++e;
+                    score += 1 << e;
+                    ++i;
+                }
+                result |= e << (4 * placed++);
+            }
+            slidLines[length][line] = static_cast<uint16_t>(result);
+            lineScores[length][line] = score;
+        }
+    }
+}
+
+/**
+ * @brief Enumerates and values every reachable position.
+ * @param threads The number of worker threads, or 0 for one per core.
+ */
+void ExactSolver2048::solve(int threads)
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads > 0 ? threads : QThread::idealThreadCount());
+    int symmetry;
+
+    // Layer index is half the tile sum: a move stays in its layer, a spawn goes 1 or 2 layers on
+    QVector<QVector<uint64_t>> layers;
+    auto addToLayer = [&layers](qsizetype index, const QVector<uint64_t> &states) {
+        if (index >= layers.size()) {
+            layers.resize(index + 1);
+        }
+        layers[index] += states;
+    };
+    forEachSpawn(0, [&](uint64_t one, int firstExponent, double) {
+        forEachSpawn(one, [&](uint64_t two, int secondExponent, double) {
+            addToLayer(((1 << firstExponent) + (1 << secondExponent)) / 2, { canonical(two, symmetry) });
+        });
+    });
+
+    // Forwards: each layer is complete once every earlier layer has been expanded
+    count = 0;
+    for (qsizetype index = 0; index < layers.size(); ++index) {
+        QVector<uint64_t> &layer = layers[index];
+        sortUnique(layer);
+        count += layer.size();
+        QVector<LayerChunk> chunks = chunksFor(layer.size());
+        QtConcurrent::blockingMap(&pool, chunks, [this, &layer](LayerChunk &chunk) {
+            for (qsizetype i = chunk.begin; i < chunk.end; ++i) {
+                for (int d = 0; d < 4; ++d) {
+                    int addedScore = 0;
+                    uint64_t after = slide(layer[i], static_cast<Board2048::Direction>(d), addedScore);
+                    if (after == layer[i]) {
+                        continue;
+                    }
+                    forEachSpawn(after, [this, &chunk](uint64_t next, int exponent, double) {
+                        int nextSymmetry;
+                        chunk.next[exponent - 1].append(canonical(next, nextSymmetry));
+                    });
+                }
+            }
+            sortUnique(chunk.next[0]);
+            sortUnique(chunk.next[1]);
+        });
+        for (const LayerChunk &chunk : chunks) {
+            for (int k = 0; k < 2; ++k) {
+                if (!chunk.next[k].isEmpty()) {
+                    addToLayer(index + 1 + k, chunk.next[k]);
+                }
+            }
+        }
+    }
+
+    // The table is filled layer by layer, at most three quarters full
+    capacity = 2;
+    while (capacity * 3 < static_cast<uint64_t>(count) * 4) {
+        capacity *= 2;
+    }
+    mapped.close();
+    owned.fill(0, capacity);
+    entries = owned.constData();
+
+    // Backwards: a position is valued from the two layers after it, which are already valued. Only
+    // those keep their exact values; earlier layers are dropped once in the table
+    QVector<QVector<double>> values(layers.size());
+    for (qsizetype index = layers.size() - 1; index >= 0; --index) {
+        const QVector<uint64_t> &layer = layers[index];
+        QVector<double> &layerValues = values[index];
+        layerValues.resize(layer.size());
+        QVector<uint64_t> layerEntries(layer.size());
+        QVector<LayerChunk> chunks = chunksFor(layer.size());
+        QtConcurrent::blockingMap(&pool, chunks, [&, index](LayerChunk &chunk) {
+            for (qsizetype i = chunk.begin; i < chunk.end; ++i) {
+                double best = 0.0;
+                int bestMove = -1;
+                for (int d = 0; d < 4; ++d) {
+                    int addedScore = 0;
+                    uint64_t after = slide(layer[i], static_cast<Board2048::Direction>(d), addedScore);
+                    if (after == layer[i]) {
+                        continue;
+                    }
+                    double expected = addedScore;
+                    forEachSpawn(after, [&](uint64_t next, int exponent, double probability) {
+                        int nextSymmetry;
+                        uint64_t state = canonical(next, nextSymmetry);
+                        const QVector<uint64_t> &nextLayer = layers[index + exponent];
+                        qsizetype at = std::lower_bound(nextLayer.begin(), nextLayer.end(), state) - nextLayer.begin();
+                        expected += probability * values[index + exponent][at];
+                    });
+                    if (bestMove < 0 || expected > best) {
+                        best = expected;
+                        bestMove = d;
+                    }
+                }
+                layerValues[i] = best;
+                layerEntries[i] = makeEntry(layer[i], bestMove, best);
+            }
+        });
+
+        for (uint64_t entry : layerEntries) {
+            uint64_t slot = slotFor(entry & StateMask);
+            while (owned[slot] != 0) {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            owned[slot] = entry;
+        }
+        if (index + 2 < layers.size()) {
+            layers[index + 2] = QVector<uint64_t>();
+            values[index + 2] = QVector<double>();
+        }
+    }
+
+    expectedStart = 0.0;
+    forEachSpawn(0, [&](uint64_t one, int, double firstProbability) {
+        forEachSpawn(one, [&](uint64_t two, int, double secondProbability) {
+            float expected = 0.0f;
+            value(two, expected);
+            expectedStart += firstProbability * secondProbability * expected;
+        });
+    });
+}
+
+/**
+ * @brief Writes the solved table to a file, replacing the old file only once the new one is complete.
+ * @param path The table file.
+ * @return True on success, false otherwise.
+ */
+bool ExactSolver2048::save(const QString &path) const
+{
+    if (entries == nullptr) {
+        return false;
+    }
+    // A partial file would later be mapped as a valid table, so it only replaces the old one when complete
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = FileVersion;
+    header.rows = rowCount;
+    header.columns = columnCount;
+    header.capacity = capacity;
+    header.count = count;
+    header.startValue = expectedStart;
+    const qint64 entryBytes = static_cast<qint64>(capacity * sizeof(uint64_t));
+    if (file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != sizeof(header)
+        || file.write(reinterpret_cast<const char *>(entries), entryBytes) != entryBytes) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+/**
+ * @brief Maps a solved table file read-only into memory.
+ * @param path The table file.
+ * @return True if the file holds a table for this board shape, false otherwise.
+ */
+bool ExactSolver2048::load(const QString &path)
+{
+    mapped.close();
+    owned.clear();
+    entries = nullptr;
+
+    mapped.setFileName(path);
+    FileHeader header;
+    if (!mapped.open(QIODevice::ReadOnly)
+        || mapped.read(reinterpret_cast<char *>(&header), sizeof(header)) != sizeof(header)
+        || std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != FileVersion
+        || header.rows != static_cast<uint32_t>(rowCount) || header.columns != static_cast<uint32_t>(columnCount)
+        || header.capacity < 2 || (header.capacity & (header.capacity - 1)) != 0
+        || mapped.size() != static_cast<qint64>(sizeof(header) + header.capacity * sizeof(uint64_t))) {
+        mapped.close();
+        return false;
+    }
+    uchar *data = mapped.map(0, mapped.size());
+    if (data == nullptr) {
+        mapped.close();
+        return false;
+    }
+    entries = reinterpret_cast<const uint64_t *>(data + sizeof(FileHeader));
+    capacity = header.capacity;
+    count = static_cast<qint64>(header.count);
+    expectedStart = header.startValue;
+    return true;
+}
+
+/**
+ * @brief Returns the expected score optimal play still earns from a position.
+ * @param state The packed position, with the player to move.
+ * @param expected Receives the expected score.
+ * @return True if the position is in the table, false if it is unreachable.
+ */
+bool ExactSolver2048::value(uint64_t state, float &expected) const
+{
+    int symmetry;
+    uint64_t entry = find(state, symmetry);
+    if (entry == 0) {
+        return false;
+    }
+    expected = static_cast<float>((entry >> ValueShift) / ValueScale);
+    return true;
+}
+
+/**
+ * @brief Finds the optimal move of a position.
+ * @param state The packed position, with the player to move.
+ * @param direction Receives the optimal direction.
+ * @return True if the position has a legal move and is in the table, false otherwise.
+ */
+bool ExactSolver2048::bestMove(uint64_t state, Board2048::Direction &direction) const
+{
+    int symmetry;
+    uint64_t entry = find(state, symmetry);
+    if ((entry & HasMoveBit) == 0) {
+        return false;
+    }
+    // The move is stored for the canonical position; map it back through the symmetry
+    int move = static_cast<int>((entry >> MoveShift) & 3);
+    for (int d = 0; d < 4; ++d) {
+        if (symmetryMoves[symmetry][d] == move) {
+            direction = static_cast<Board2048::Direction>(d);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Slides the tiles of a packed position.
+ * @param state The packed position.
+ * @param direction The direction of the move.
+ * @param addedScore Accumulates the score gained by merges.
+ * @return The packed position after the move, equal to state if nothing moved.
+ */
+uint64_t ExactSolver2048::slide(uint64_t state, Board2048::Direction direction, int &addedScore) const
+{
+    bool horizontal = direction == Board2048::Left || direction == Board2048::Right;
+    int lines = horizontal ? rowCount : columnCount;
+    int length = horizontal ? columnCount : rowCount;
+    const QVector<uint16_t> &slid = slidLines[length];
+    const QVector<int32_t> &scores = lineScores[length];
+
+    uint64_t result = 0;
+    for (int l = 0; l < lines; ++l) {
+        const uint8_t *cells = lineCells[direction][l];
+        int line = 0;
+        for (int i = 0; i < length; ++i) {
+            line |= static_cast<int>((state >> (4 * cells[i])) & 0xF) << (4 * i);
+        }
+        addedScore += scores[line];
+        uint64_t out = slid[line];
+        for (int i = 0; i < length; ++i) {
+            result |= ((out >> (4 * i)) & 0xF) << (4 * cells[i]);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Packs a game board of the same shape.
+ * @param board The board.
+ * @param state Receives the packed position.
+ * @return True if the board has this shape and no tile above 2^15, false otherwise.
+ */
+bool ExactSolver2048::pack(const GridBoard2048 &board, uint64_t &state) const
+{
+    if (board.size() != rowCount || board.size() != columnCount) {
+        return false;
+    }
+    state = 0;
+    for (int row = 0; row < rowCount; ++row) {
+        for (int col = 0; col < columnCount; ++col) {
+            int e = board.exponent(row, col);
+            if (e > Board2048::MaxExponent) {
+                return false;
+            }
+            state |= static_cast<uint64_t>(e) << (4 * (row * columnCount + col));
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Maps a position to the representative of its rotations and reflections.
+ * @param state The packed position.
+ * @param symmetry Receives the index of the symmetry that maps state to the result.
+ * @return The smallest packed variant of the position.
+ */
+uint64_t ExactSolver2048::canonical(uint64_t state, int &symmetry) const
+{
+    uint64_t best = state;
+    symmetry = 0;
+    const uint64_t rowMask = (1ULL << (4 * columnCount)) - 1;
+    for (int k = 1; k < symmetryCount; ++k) {
+        uint64_t variant = 0;
+        for (int row = 0; row < rowCount; ++row) {
+            variant |= symmetryRows[k][row][(state >> (4 * columnCount * row)) & rowMask];
+        }
+        if (variant < best) {
+            best = variant;
+            symmetry = k;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Returns the slot where the search for a position starts.
+ * @param state The packed canonical position.
+ * @return The slot index.
+ */
+uint64_t ExactSolver2048::slotFor(uint64_t state) const
+{
+    return ((state ^ (state >> 29)) * 0x9E3779B97F4A7C15ULL >> 32) & (capacity - 1);
+}
+
+/**
+ * @brief Finds the entry of a position.
+ * @param state The packed position.
+ * @param symmetry Receives the index of the symmetry that maps state to the stored position.
+ * @return The entry, or 0 if the position is not in the table.
+ */
+uint64_t ExactSolver2048::find(uint64_t state, int &symmetry) const
+{
+    if (entries == nullptr || state == 0) {
+        return 0;
+    }
+    state = canonical(state, symmetry);
+    for (uint64_t slot = slotFor(state);; slot = (slot + 1) & (capacity - 1)) {
+        if (entries[slot] == 0 || (entries[slot] & StateMask) == state) {
+            return entries[slot];
+        }
+    }
+}
+
+/**
+ * @brief Calls a function for each spawn on a position.
+ * @param state The packed position.
+ * @param visit Called with the position after the spawn, the exponent of the new tile and the
+ * probability of the spawn.
+ */
+template <typename Visit>
+void ExactSolver2048::forEachSpawn(uint64_t state, Visit visit) const
+{
+    int empty[MaxSide * MaxSide];
+    int emptyCount = 0;
+    for (int cell = 0; cell < cellCount; ++cell) {
+        if (((state >> (4 * cell)) & 0xF) == 0) {
+            empty[emptyCount++] = cell;
+        }
+    }
+    for (int i = 0; i < emptyCount; ++i) {
+        visit(state | (1ULL << (4 * empty[i])), 1, 0.9 / emptyCount);
+        visit(state | (2ULL << (4 * empty[i])), 2, 0.1 / emptyCount);
+    }
+}
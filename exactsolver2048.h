@@ -0,0 +1,188 @@
+/**
+ * @file exactsolver2048.h
+ * @brief Declares the ExactSolver2048 class, which solves 2048 exactly on boards of up to 3x3 cells.
+ *
+ * Every position reachable from the start is enumerated, and each gets the expected score that
+ * optimal play still earns from it. A move keeps the sum of the tiles and a spawn adds 2 or 4, so
+ * the positions split into layers by tile sum and every move leads to a later layer. The layers
+ * are enumerated forwards from the start, then valued backwards from the last one (retrograde
+ * analysis), each layer split over all cores. Positions are packed at 4 bits per cell and only
+ * one position of each set of rotations and reflections is kept, which shrinks the 389 million
+ * reachable 3x3 positions about eightfold.
+ *
+ * The solved positions are saved as an open-addressing hash table of 8-byte entries (position,
+ * optimal move and value in fixed point) that load() maps into memory, so value() and bestMove()
+ * cost a few probes whatever the size of the table. The 3x3 table takes about 512 MB.
+ */
+#ifndef EXACTSOLVER2048_H
+#define EXACTSOLVER2048_H
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <cstdint>
+#include "board2048.h"
+#include "gridboard2048.h"
+
+/**
+ * @class ExactSolver2048
+ * @brief The ExactSolver2048 class computes and queries the optimal play of a small 2048 board.
+ *
+ * Cell (row, col) is stored in nibble row * columns + col of a packed state.
+ */
+class ExactSolver2048 {
+public:
+    static constexpr int MinSide = 2;    ///< Fewest rows or columns.
+    static constexpr int MaxSide = 3;    ///< Most rows or columns.
+
+    /**
+     * @brief Constructs an empty solver for the given board shape.
+     * @param rows The number of rows, clamped to [MinSide, MaxSide].
+     * @param columns The number of columns, clamped to [MinSide, MaxSide].
+     */
+    explicit ExactSolver2048(int rows = MaxSide, int columns = MaxSide);
+    ExactSolver2048(const ExactSolver2048 &) = delete;
+    ExactSolver2048 &operator=(const ExactSolver2048 &) = delete;
+
+    /**
+     * @brief Returns the number of rows.
+     * @return The row count.
+     */
+    int rows() const { return rowCount; }
+    /**
+     * @brief Returns the number of columns.
+     * @return The column count.
+     */
+    int columns() const { return columnCount; }
+
+    /**
+     * @brief Enumerates and values every reachable position.
+     * @param threads The number of worker threads, or 0 for one per core.
+     */
+    void solve(int threads = 0);
+    /**
+     * @brief Writes the solved table to a file, replacing the old file only once the new one is complete.
+     * @param path The table file.
+     * @return True on success, false otherwise.
+     */
+    bool save(const QString &path) const;
+    /**
+     * @brief Maps a solved table file read-only into memory.
+     * @param path The table file.
+     * @return True if the file holds a table for this board shape, false otherwise.
+     */
+    bool load(const QString &path);
+    /**
+     * @brief Checks if a solved table is available.
+     * @return True after solve() or a successful load(), false otherwise.
+     */
+    bool isSolved() const { return entries != nullptr; }
+    /**
+     * @brief Returns the number of solved positions.
+     * @return The position count.
+     */
+    qint64 stateCount() const { return count; }
+    /**
+     * @brief Returns the expected score of a new game under optimal play.
+     * @return The expected score, over the random starting tiles.
+     */
+    double startValue() const { return expectedStart; }
+
+    /**
+     * @brief Returns the expected score optimal play still earns from a position.
+     * @param state The packed position, with the player to move.
+     * @param expected Receives the expected score.
+     * @return True if the position is in the table, false if it is unreachable.
+     */
+    bool value(uint64_t state, float &expected) const;
+    /**
+     * @brief Finds the optimal move of a position.
+     * @param state The packed position, with the player to move.
+     * @param direction Receives the optimal direction.
+     * @return True if the position has a legal move and is in the table, false otherwise.
+     */
+    bool bestMove(uint64_t state, Board2048::Direction &direction) const;
+    /**
+     * @brief Slides the tiles of a packed position.
+     * @param state The packed position.
+     * @param direction The direction of the move.
+     * @param addedScore Accumulates the score gained by merges.
+     * @return The packed position after the move, equal to state if nothing moved.
+     */
+    uint64_t slide(uint64_t state, Board2048::Direction direction, int &addedScore) const;
+    /**
+     * @brief Packs a game board of the same shape.
+     * @param board The board.
+     * @param state Receives the packed position.
+     * @return True if the board has this shape and no tile above 2^15, false otherwise.
+     */
+    bool pack(const GridBoard2048 &board, uint64_t &state) const;
+
+private:
+    static constexpr int MaxSymmetries = 8;    ///< Rotations and reflections of a square board.
+
+    /**
+     * @brief Layout of the header that precedes the entries in a file.
+     */
+    struct FileHeader {
+        char magic[8];             ///< "EXCT2048".
+        uint32_t version;          ///< Format version, currently 1.
+        uint32_t rows;
+        uint32_t columns;
+        uint32_t reserved;         ///< Always 0.
+        uint64_t capacity;         ///< Number of slots, a power of two.
+        uint64_t count;            ///< Number of positions.
+        double startValue;
+        uint8_t padding[16];
+    };
+    static_assert(sizeof(FileHeader) == 64, "the entries must start 64-byte aligned");
+
+    /**
+     * @brief Maps a position to the representative of its rotations and reflections.
+     * @param state The packed position.
+     * @param symmetry Receives the index of the symmetry that maps state to the result.
+     * @return The smallest packed variant of the position.
+     */
+    uint64_t canonical(uint64_t state, int &symmetry) const;
+    /**
+     * @brief Returns the slot where the search for a position starts.
+     * @param state The packed canonical position.
+     * @return The slot index.
+     */
+    uint64_t slotFor(uint64_t state) const;
+    /**
+     * @brief Finds the entry of a position.
+     * @param state The packed position.
+     * @param symmetry Receives the index of the symmetry that maps state to the stored position.
+     * @return The entry, or 0 if the position is not in the table.
+     */
+    uint64_t find(uint64_t state, int &symmetry) const;
+    /**
+     * @brief Calls a function for each spawn on a position.
+     * @param state The packed position.
+     * @param visit Called with the position after the spawn, the exponent of the new tile and the
+     * probability of the spawn.
+     */
+    template <typename Visit>
+    void forEachSpawn(uint64_t state, Visit visit) const;
+
+    int rowCount;
+    int columnCount;
+    int cellCount;
+    uint8_t lineCells[4][MaxSide][MaxSide];    ///< Cells of each line, in the order they slide.
+    QVector<uint16_t> slidLines[MaxSide + 1];  ///< Line after a slide towards its first cell, by length.
+    QVector<int32_t> lineScores[MaxSide + 1];  ///< Score gained by that slide, by length.
+    int symmetryCount;
+    uint8_t symmetryCells[MaxSymmetries][MaxSide * MaxSide];    ///< Cell each cell goes to.
+    uint8_t symmetryMoves[MaxSymmetries][4];    ///< Direction each direction becomes.
+    QVector<uint64_t> symmetryRows[MaxSymmetries][MaxSide];    ///< Cells of a row, moved.
+
+    QFile mapped;
+    QVector<uint64_t> owned;
+    const uint64_t *entries = nullptr;
+    uint64_t capacity = 0;
+    qint64 count = 0;
+    double expectedStart = 0.0;
+};
+
+#endif // EXACTSOLVER2048_H
@@ -0,0 +1,377 @@
+/**
+ * @file expectimax2048.cpp
+ * @brief Implementation of the Expectimax2048 move search.
+ */
+#include "expectimax2048.h"
+#include <QtConcurrent>
+#include <QVector>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace {
+
+const int BudgetScale = 4;                 ///< Probability budget units per halving of probability.
+const int RootBudget = 53;                 ///< Budget of the root, about a 0.0001 probability.
+
+/**
+ * @brief Budget spent by each spawn, indexed by the number of empty cells.
+ *
+ * A spawn of probability p costs round(BudgetScale * log2(1 / p)), so a branch runs out of budget
+ * once its probability drops below about 2^(-RootBudget / BudgetScale).
+ */
+struct SpawnCosts {
+    int two[17];
+    int four[17];
+
+    SpawnCosts()
+    {
+        for (int n = 1; n <= 16; ++n) {
+            two[n] = static_cast<int>(std::lround(BudgetScale * std::log2(n / 0.9)));
+            four[n] = static_cast<int>(std::lround(BudgetScale * std::log2(n / 0.1)));
+        }
+    }
+};
+
+/**
+ * @brief Returns the shared spawn cost table, building it on first use.
+ * @return The spawn costs.
+ */
+const SpawnCosts &spawnCosts()
+{
+    static const SpawnCosts costs;
+    return costs;
+}
+
+} // namespace
+
+/**
+ * @brief Constructs a search with the given depth.
+ * @param depth The number of moves to look ahead.
+ * @param threads The number of worker threads, 0 for one per core, or 1 to search on the calling thread.
+ * @param cacheBits log2 of the number of transposition table entries.
+ */
+Expectimax2048::Expectimax2048(int depth, int threads, int cacheBits)
+    : table(cacheBits)
+{
+    setDepth(depth);
+    setThreadCount(threads);
+}
+
+/**
+ * @brief Sets the number of moves to look ahead.
+ * @param depth The search depth, clamped to [1, 8].
+ */
+void Expectimax2048::setDepth(int depth)
+{
+    searchDepth = std::clamp(depth, 1, 8);
+}
+
+/**
+ * @brief Sets the number of worker threads used by the search.
+ * @param threads The number of threads, 0 for one per core, or 1 to search on the calling thread.
+ */
+void Expectimax2048::setThreadCount(int threads)
+{
+    pool.setMaxThreadCount(threads > 0 ? threads : QThread::idealThreadCount());
+}
+
+/**
+ * @brief Scores the leaves with a trained network instead of the static heuristic.
+ * @param evaluator The network, or nullptr to go back to the heuristic.
+ */
+void Expectimax2048::setEvaluator(const NTuple2048 *evaluator)
+{
+    if (evaluator != nullptr && !evaluator->isLoaded()) {
+        evaluator = nullptr;
+    }
+    if (evaluator != network) {
+        // Cached values were scored by the other evaluator
+        network = evaluator;
+        table.clear();
+    }
+}
+
+/**
+ * @brief Scores the leaves with a set of tuned weights instead of the default ones.
+ * @param heuristic The heuristic, or nullptr to go back to the default weights.
+ */
+void Expectimax2048::setHeuristic(const Heuristic2048 *heuristic)
+{
+    if (heuristic == nullptr) {
+        heuristic = &Heuristic2048::standard();
+    }
+    if (heuristic != staticHeuristic) {
+        staticHeuristic = heuristic;
+        if (network == nullptr) {
+            table.clear();
+        }
+    }
+}
+
+/**
+ * @brief Finds the move with the highest expected heuristic value.
+ * @param board The position to search.
+ * @param direction Receives the best direction.
+ * @param token The cancelToken() read before the search was launched, or CurrentToken.
+ * @return True if a legal move exists, false if the game is lost.
+ */
+bool Expectimax2048::bestMove(const Board2048 &board, Board2048::Direction &direction, uint64_t token)
+{
+    beginSearch(-1, token);
+
+    const int order[4] = { 0, 1, 2, 3 };
+    bool legal[4];
+    float values[4];
+    bool complete[4];
+    searchRoot(board.bits(), searchDepth, order, legal, values, complete);
+    completedDepth = searchDepth;
+    return pickBest(legal, values, direction);
+}
+
+/**
+ * @brief Values every move of a position with a full search of depth().
+ * @param board The position to search.
+ * @param legal Receives true for each direction that changes the board.
+ * @param values Receives the expected value of each legal direction.
+ * @param token The cancelToken() read before the search was launched, or CurrentToken.
+ * @return True if a legal move exists and the search was not cancelled, false otherwise.
+ */
+bool Expectimax2048::evaluateMoves(const Board2048 &board, bool legal[4], float values[4], uint64_t token)
+{
+    beginSearch(-1, token);
+
+    const int order[4] = { 0, 1, 2, 3 };
+    bool complete[4];
+    searchRoot(board.bits(), searchDepth, order, legal, values, complete);
+    completedDepth = searchDepth;
+    return std::count(legal, legal + 4, true) > 0 && !stopping.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Finds the best move within a time limit by iterative deepening.
+ * @param board The position to search.
+ * @param timeLimitMs The time limit, in milliseconds.
+ * @param direction Receives the best direction.
+ * @param token The cancelToken() read before the search was launched, or CurrentToken.
+ * @return True if a legal move exists, false if the game is lost.
+ */
+bool Expectimax2048::searchTimed(const Board2048 &board, int timeLimitMs, Board2048::Direction &direction, uint64_t token)
+{
+    beginSearch(timeLimitMs, token);
+
+    int order[4] = { 0, 1, 2, 3 };
+    bool legal[4];
+    float values[4];
+    bool complete[4];
+    bool found = false;
+    for (int depth = 1; depth <= searchDepth; ++depth) {
+        searchRoot(board.bits(), depth, order, legal, values, complete);
+        if (depth == 1) {
+            // Depth 1 only evaluates leaves, so it always finishes
+            found = pickBest(legal, values, direction);
+            completedDepth = 1;
+            if (std::count(legal, legal + 4, true) <= 1) {
+                break;
+            }
+        } else if (stopping.load(std::memory_order_relaxed)) {
+            // The moves that finished are ranked at the new depth; use them only if the best move
+            // of the previous iteration, which was queued first, is one of them
+            if (complete[order[0]]) {
+                pickBest(complete, values, direction);
+            }
+            break;
+        } else {
+            pickBest(legal, values, direction);
+            completedDepth = depth;
+        }
+
+        // Queue the moves best first in the next iteration
+        std::stable_sort(order, order + 4, [&](int a, int b) {
+            return legal[a] != legal[b] ? legal[a] : values[a] > values[b];
+        });
+        if (deadline.hasExpired() || stopping.load(std::memory_order_relaxed)) {
+            break;
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Starts a search: resets the counters and stops it at once if it was cancelled before it began.
+ * @param timeLimitMs The time limit, in milliseconds, or -1 for none.
+ * @param token The cancelToken() read before the search was launched, or CurrentToken.
+ */
+void Expectimax2048::beginSearch(int timeLimitMs, uint64_t token)
+{
+    deadline = timeLimitMs < 0 ? QDeadlineTimer(QDeadlineTimer::Forever) : QDeadlineTimer(timeLimitMs, Qt::PreciseTimer);
+    searchToken = token == CurrentToken ? cancelToken() : token;
+    stopping.store(searchToken != cancelToken(), std::memory_order_relaxed);
+    nodes = 0;
+    completedDepth = 0;
+}
+
+/**
+ * @brief Searches every legal root move to a fixed depth.
+ * @param bits The packed root position.
+ * @param depth The search depth.
+ * @param order The directions, in the order their tasks are queued.
+ * @param legal Receives true for each direction that changes the board.
+ * @param values Receives the expected value of each legal direction.
+ * @param complete Receives true for each legal direction whose tasks all finished before a stop.
+ */
+void Expectimax2048::searchRoot(uint64_t bits, int depth, const int order[4], bool legal[4], float values[4], bool complete[4])
+{
+    // Expand the root into one task per spawn below each legal move
+    const SpawnCosts &costs = spawnCosts();
+    QVector<RootTask> tasks;
+    float rewards[4];
+    for (int i = 0; i < 4; ++i) {
+        int d = order[i];
+        int addedScore = 0;
+        uint64_t next = Board2048::slide(bits, static_cast<Board2048::Direction>(d), addedScore);
+        legal[d] = next != bits;
+        rewards[d] = moveReward(addedScore);
+        if (!legal[d]) {
+            continue;
+        }
+        if (depth == 1) {
+            tasks.append(RootTask{ d, next, -1, 1.0f, 0.0f, 0, false });
+            continue;
+        }
+        uint16_t empty = Board2048(next).emptyMask();
+        int emptyCount = std::popcount(empty);
+        for (uint16_t mask = empty; mask != 0; mask &= mask - 1) {
+            uint64_t tile = 1ULL << (4 * std::countr_zero(mask));
+            tasks.append(RootTask{ d, next | tile, RootBudget - costs.two[emptyCount], 0.9f / emptyCount, 0.0f, 0, false });
+            tasks.append(RootTask{ d, next | (tile << 1), RootBudget - costs.four[emptyCount], 0.1f / emptyCount, 0.0f, 0, false });
+        }
+    }
+
+    auto runTask = [this, depth](RootTask &task) {
+        if (task.budget < 0) {
+            task.value = leafValue(task.board);
+        } else {
+            task.value = maxNode(task.board, depth - 1, task.budget, task.nodes);
+        }
+        task.complete = !stopping.load(std::memory_order_relaxed);
+    };
+    if (pool.maxThreadCount() == 1) {
+        // One thread gains nothing from the pool, and the caller's thread keeps its own priority
+        for (RootTask &task : tasks) {
+            runTask(task);
+        }
+    } else {
+        QtConcurrent::blockingMap(&pool, tasks, runTask);
+    }
+
+    // Merge in task order, whatever order the tasks finished in
+    for (int d = 0; d < 4; ++d) {
+        values[d] = legal[d] ? rewards[d] : 0.0f;
+        complete[d] = legal[d];
+    }
+    for (const RootTask &task : tasks) {
+        values[task.direction] += task.weight * task.value;
+        complete[task.direction] = complete[task.direction] && task.complete;
+        nodes += task.nodes + 1;
+    }
+}
+
+/**
+ * @brief Picks the direction with the highest value among some candidates.
+ * @param candidates The directions to choose from.
+ * @param values The value of each direction.
+ * @param direction Receives the best direction; ties go to the first in Direction order.
+ * @return True if there was a candidate, false otherwise.
+ */
+bool Expectimax2048::pickBest(const bool candidates[4], const float values[4], Board2048::Direction &direction)
+{
+    bool found = false;
+    for (int d = 0; d < 4; ++d) {
+        if (candidates[d] && (!found || values[d] > values[direction])) {
+            found = true;
+            direction = static_cast<Board2048::Direction>(d);
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Scores a position with the static heuristic and its default weights.
+ * @param bits The packed board.
+ * @return The heuristic value; higher is better.
+ */
+float Expectimax2048::evaluate(uint64_t bits)
+{
+    return Heuristic2048::standard().evaluate(bits);
+}
+
+/**
+ * @brief Scores a position where the player is to move.
+ * @param bits The packed board.
+ * @param depthLeft The number of moves left to search.
+ * @param budget The remaining probability budget.
+ * @param visited Accumulates the number of visited nodes.
+ * @return The expected value of the best move.
+ */
+float Expectimax2048::maxNode(uint64_t bits, int depthLeft, int budget, uint64_t &visited)
+{
+    // The token catches a cancel() whose flag the start of this search overwrote
+    if ((++visited & 0xFF) == 0 && (deadline.hasExpired() || cancelToken() != searchToken)) {
+        stopping.store(true, std::memory_order_relaxed);
+    }
+    if (stopping.load(std::memory_order_relaxed)) {
+        return 0.0f;
+    }
+    float best = 0.0f;
+    for (int d = 0; d < 4; ++d) {
+        int addedScore = 0;
+        uint64_t next = Board2048::slide(bits, static_cast<Board2048::Direction>(d), addedScore);
+        if (next != bits) {
+            best = std::max(best, moveReward(addedScore) + chanceNode(next, depthLeft - 1, budget, visited));
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Scores a position where a random tile is about to spawn.
+ * @param bits The packed board.
+ * @param depthLeft The number of moves left to search.
+ * @param budget The remaining probability budget.
+ * @param visited Accumulates the number of visited nodes.
+ * @return The expected value over all spawns.
+ */
+float Expectimax2048::chanceNode(uint64_t bits, int depthLeft, int budget, uint64_t &visited)
+{
+    ++visited;
+    if (depthLeft <= 0) {
+        return leafValue(bits);
+    }
+
+    float value;
+    if (table.probe(bits, depthLeft, budget, value)) {
+        return value;
+    }
+
+    const SpawnCosts &costs = spawnCosts();
+    uint16_t empty = Board2048(bits).emptyMask();
+    int emptyCount = std::popcount(empty);
+    int budgetTwo = budget - costs.two[emptyCount];
+    int budgetFour = budget - costs.four[emptyCount];
+    float total = 0.0f;
+    for (uint16_t mask = empty; mask != 0; mask &= mask - 1) {
+        uint64_t tile = 1ULL << (4 * std::countr_zero(mask));
+        total += 0.9f * (budgetTwo < 0 ? leafValue(bits | tile) : maxNode(bits | tile, depthLeft, budgetTwo, visited));
+        total += 0.1f * (budgetFour < 0 ? leafValue(bits | (tile << 1))
+                                        : maxNode(bits | (tile << 1), depthLeft, budgetFour, visited));
+    }
+    value = total / emptyCount;
+
+    // A stopped search returns made-up values, which must not outlive it
+    if (stopping.load(std::memory_order_relaxed)) {
+        return value;
+    }
+    table.store(bits, depthLeft, budget, value);
+    return value;
+}
@@ -0,0 +1,255 @@
+/**
+ * @file expectimax2048.h
+ * @brief Declares the Expectimax2048 class, an expectimax move search for the 2048 game.
+ *
+ * The search runs on packed Board2048 positions. Max nodes try the four moves, chance nodes average
+ * over every empty cell receiving a 2 (90%) or a 4 (10%). Leaves are scored with a table-driven
+ * heuristic and chance nodes are memoized in a transposition cache.
+ *
+ * The root is split into one task per (direction, spawn) pair and the tasks run on a thread pool
+ * sharing a lock-free transposition table. With a single thread the tasks run one after the other
+ * on the calling thread instead, at its priority, and the pool never starts a thread. Unlikely
+ * branches are cut off with an integer probability budget rather than a floating-point probability,
+ * which makes every cached value a pure function of (board, depth, budget). Together with a fixed merge order this gives the same move and value for
+ * any number of threads.
+ *
+ * searchTimed() deepens one ply at a time until a deadline, queueing the root moves in the order
+ * the previous iteration ranked them, and keeps the move of the deepest iteration that finished.
+ * The deadline is checked every 256 nodes of each task and cancel() stops a search from any thread;
+ * values computed after a stop are never written to the transposition table. cancel() bumps a
+ * counter rather than setting a flag the next search would clear: a caller that launches a search
+ * on another thread passes the cancelToken() it read beforehand, and a cancel() issued before the
+ * search actually starts still stops it.
+ *
+ * setHeuristic() replaces the default heuristic weights with tuned ones, such as those written by
+ * tune2048. setEvaluator() swaps the heuristic for a trained NTuple2048 network. The network estimates the
+ * score still to come, so the search then also adds the score gained by each move along the path.
+ */
+#ifndef EXPECTIMAX2048_H
+#define EXPECTIMAX2048_H
+
+#include "board2048.h"
+#include "heuristic2048.h"
+#include "ntuple2048.h"
+#include "transpositiontable2048.h"
+#include <QThreadPool>
+#include <QDeadlineTimer>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @class Expectimax2048
+ * @brief The Expectimax2048 class searches for the best move of a 2048 position.
+ */
+class Expectimax2048 {
+public:
+    static constexpr uint64_t CurrentToken = UINT64_MAX;    ///< Token of a search only stopped by a later cancel().
+    static constexpr int DefaultCacheBits = 20;             ///< log2 of the default number of cache entries.
+
+    /**
+     * @brief Constructs a search with the given depth.
+     * @param depth The number of moves to look ahead.
+     * @param threads The number of worker threads, 0 for one per core, or 1 to search on the calling thread.
+     * @param cacheBits log2 of the number of transposition table entries.
+     */
+    explicit Expectimax2048(int depth = 3, int threads = 0, int cacheBits = DefaultCacheBits);
+
+    /**
+     * @brief Sets the number of moves to look ahead, or the deepest iteration of a timed search.
+     *
+     * Must not be called while a search is running.
+     * @param depth The search depth, clamped to [1, 8].
+     */
+    void setDepth(int depth);
+    /**
+     * @brief Returns the number of moves the search looks ahead.
+     * @return The search depth.
+     */
+    int depth() const { return searchDepth; }
+    /**
+     * @brief Sets the number of worker threads used by the search.
+     * @param threads The number of threads, 0 for one per core, or 1 to search on the calling thread.
+     */
+    void setThreadCount(int threads);
+    /**
+     * @brief Returns the number of worker threads used by the search.
+     * @return The thread count.
+     */
+    int threadCount() const { return pool.maxThreadCount(); }
+    /**
+     * @brief Scores the leaves with a trained network instead of the static heuristic.
+     *
+     * Must not be called while a search is running. The network must outlive the search.
+     * @param evaluator The network, or nullptr to go back to the heuristic.
+     */
+    void setEvaluator(const NTuple2048 *evaluator);
+    /**
+     * @brief Returns the network used to score the leaves.
+     * @return The network, or nullptr when the static heuristic is used.
+     */
+    const NTuple2048 *evaluator() const { return network; }
+    /**
+     * @brief Scores the leaves with a set of tuned weights instead of the default ones.
+     *
+     * Must not be called while a search is running. The heuristic must outlive the search; a
+     * network set with setEvaluator() takes precedence over it.
+     * @param heuristic The heuristic, or nullptr to go back to the default weights.
+     */
+    void setHeuristic(const Heuristic2048 *heuristic);
+    /**
+     * @brief Returns the heuristic used to score the leaves when no network is set.
+     * @return The heuristic.
+     */
+    const Heuristic2048 *heuristic() const { return staticHeuristic; }
+
+    /**
+     * @brief Finds the move with the highest expected heuristic value.
+     * @param board The position to search.
+     * @param direction Receives the best direction.
+     * @param token The cancelToken() read before the search was launched, or CurrentToken.
+     * @return True if a legal move exists, false if the game is lost.
+     */
+    bool bestMove(const Board2048 &board, Board2048::Direction &direction, uint64_t token = CurrentToken);
+    /**
+     * @brief Values every move of a position with a full search of depth().
+     * @param board The position to search.
+     * @param legal Receives true for each direction that changes the board.
+     * @param values Receives the expected value of each legal direction.
+     * @param token The cancelToken() read before the search was launched, or CurrentToken.
+     * @return True if a legal move exists and the search was not cancelled, false otherwise.
+     */
+    bool evaluateMoves(const Board2048 &board, bool legal[4], float values[4], uint64_t token = CurrentToken);
+    /**
+     * @brief Finds the best move within a time limit by iterative deepening.
+     *
+     * Depth 1 always completes, so a legal move is found however short the limit. Deeper
+     * iterations run until depth() is reached, the deadline passes or cancel() is called.
+     * @param board The position to search.
+     * @param timeLimitMs The time limit, in milliseconds.
+     * @param direction Receives the best direction.
+     * @param token The cancelToken() read before the search was launched, or CurrentToken.
+     * @return True if a legal move exists, false if the game is lost.
+     */
+    bool searchTimed(const Board2048 &board, int timeLimitMs, Board2048::Direction &direction, uint64_t token = CurrentToken);
+    /**
+     * @brief Stops the running search, and any search launched with an older token, as soon as possible.
+     *
+     * Safe to call from any thread.
+     */
+    void cancel()
+    {
+        cancels.fetch_add(1, std::memory_order_relaxed);
+        stopping.store(true, std::memory_order_relaxed);
+    }
+    /**
+     * @brief Returns the token a search must be launched with to be stopped by the next cancel().
+     *
+     * Read it on the launching thread, before the search is handed to another one.
+     * @return The number of cancel() calls so far.
+     */
+    uint64_t cancelToken() const { return cancels.load(std::memory_order_relaxed); }
+    /**
+     * @brief Returns the number of positions visited by the last search.
+     * @return The node count.
+     */
+    uint64_t nodeCount() const { return nodes; }
+    /**
+     * @brief Returns the depth of the deepest iteration the last search finished.
+     * @return The reached depth.
+     */
+    int reachedDepth() const { return completedDepth; }
+
+    /**
+     * @brief Scores a position with the static heuristic and its default weights.
+     * @param bits The packed board.
+     * @return The heuristic value; higher is better.
+     */
+    static float evaluate(uint64_t bits);
+
+private:
+    /**
+     * @brief A spawn below one of the root moves, searched as an independent task.
+     */
+    struct RootTask {
+        int direction;
+        uint64_t board;
+        int budget;
+        float weight;
+        float value;
+        uint64_t nodes;
+        bool complete;
+    };
+
+    /**
+     * @brief Starts a search: resets the counters and stops it at once if it was cancelled before it began.
+     * @param timeLimitMs The time limit, in milliseconds, or -1 for none.
+     * @param token The cancelToken() read before the search was launched, or CurrentToken.
+     */
+    void beginSearch(int timeLimitMs, uint64_t token);
+    /**
+     * @brief Searches every legal root move to a fixed depth.
+     * @param bits The packed root position.
+     * @param depth The search depth.
+     * @param order The directions, in the order their tasks are queued.
+     * @param legal Receives true for each direction that changes the board.
+     * @param values Receives the expected value of each legal direction.
+     * @param complete Receives true for each legal direction whose tasks all finished before a stop.
+     */
+    void searchRoot(uint64_t bits, int depth, const int order[4], bool legal[4], float values[4], bool complete[4]);
+    /**
+     * @brief Picks the direction with the highest value among some candidates.
+     * @param candidates The directions to choose from.
+     * @param values The value of each direction.
+     * @param direction Receives the best direction; ties go to the first in Direction order.
+     * @return True if there was a candidate, false otherwise.
+     */
+    static bool pickBest(const bool candidates[4], const float values[4], Board2048::Direction &direction);
+    /**
+     * @brief Scores a leaf with the network if one is set, or with the static heuristic.
+     * @param bits The packed board.
+     * @return The leaf value.
+     */
+    float leafValue(uint64_t bits) const
+    {
+        return network != nullptr ? network->evaluate(bits) : staticHeuristic->evaluate(bits);
+    }
+    /**
+     * @brief Returns the part of a move's score that counts towards the value of a path.
+     * @param addedScore The score gained by the move.
+     * @return The score with a network, 0 with the heuristic, which already rewards merges.
+     */
+    float moveReward(int addedScore) const { return network != nullptr ? static_cast<float>(addedScore) : 0.0f; }
+
+    /**
+     * @brief Scores a position where the player is to move.
+     * @param bits The packed board.
+     * @param depthLeft The number of moves left to search.
+     * @param budget The remaining probability budget.
+     * @param visited Accumulates the number of visited nodes.
+     * @return The expected value of the best move.
+     */
+    float maxNode(uint64_t bits, int depthLeft, int budget, uint64_t &visited);
+    /**
+     * @brief Scores a position where a random tile is about to spawn.
+     * @param bits The packed board.
+     * @param depthLeft The number of moves left to search.
+     * @param budget The remaining probability budget.
+     * @param visited Accumulates the number of visited nodes.
+     * @return The expected value over all spawns.
+     */
+    float chanceNode(uint64_t bits, int depthLeft, int budget, uint64_t &visited);
+
+    int searchDepth;
+    int completedDepth = 0;
+    uint64_t nodes = 0;
+    QDeadlineTimer deadline;
+    std::atomic<bool> stopping{ false };
+    std::atomic<uint64_t> cancels{ 0 };
+    uint64_t searchToken = 0;
+    const NTuple2048 *network = nullptr;
+    const Heuristic2048 *staticHeuristic = &Heuristic2048::standard();
+    TranspositionTable2048 table;
+    QThreadPool pool;
+};
+
+#endif // EXPECTIMAX2048_H
@@ -8,6 +8,9 @@
 #include <QMessageBox>
 #include <QLabel>
 #include "settingswindow.h"
+#include "analysisdialog2048.h"
+#include "spectatorwall2048.h"
+#include "variantgame2048.h"
 #include <QString>
 #include <QColor>
 #include <QFile>
@@ -16,6 +19,17 @@
 #include <QMediaPlayer>
 #include <QSoundEffect>
 #include <QAudioOutput>
+#include <QRandomGenerator>
+#include <QStatusBar>
+#include <QtConcurrent>
+
+namespace {
+
+const int FrameIntervalMs = 16;        ///< Interval at which queued moves are played and shown.
+const int SlideSoundIntervalMs = 80;   ///< Shortest time between two slide sounds.
+const int MaxPendingMoves = 64;        ///< Key presses kept while waiting for the next frame.
+
+} // namespace
 
 int bestScore;
 /**
@@ -50,6 +64,8 @@ game2048::game2048(QWidget *parent)
     bestScoreLabel = new QLabel("Best Score: " + QString::number(bestScore));
     verticalLayout->addWidget(scoreLabel);
     verticalLayout->addWidget(bestScoreLabel);
+    winChanceLabel = new QLabel("Chance of 2048: -");
+    winChanceLabel->setToolTip("Share of quick AI playouts from this position that reach 2048 and 4096");
 
     loadHighestScore();
 
@@ -64,20 +80,9 @@ game2048::game2048(QWidget *parent)
     layout->setSpacing(3);
     layout->setVerticalSpacing(15);
 
-    for(int i = 0; i < 4; ++i) {
-        for(int j = 0; j < 4; ++j) {
-            grid[i][j] = 0;
-            gridButtons[i][j] = new QPushButton("");
-            gridButtons[i][j]->setFixedSize(buttonSize, buttonSize);
-            // font size
-            QFont font = gridButtons[i][j]->font();
-            font.setPointSize(buttonSize/4);
-            gridButtons[i][j]->setFont(font);
-            // font color
-            gridButtons[i][j]->setStyleSheet("color: #8E753D;");
-            layout->addWidget(gridButtons[i][j], i, j);
-        }
-    }
+    boardView = new BoardView2048();
+    boardView->setMinimumSize(QSize(buttonSize, buttonSize) * 4);
+    layout->addWidget(boardView, 0, 0, 4, 4);
 
     // Sound effect
     soundEffect = new QSoundEffect(this);
@@ -96,6 +101,64 @@ game2048::game2048(QWidget *parent)
     QPushButton *settingsButton = new QPushButton("Settings");
     connect(settingsButton, &QPushButton::clicked, this, &game2048::showSettings);
 
+    hintButton = new QPushButton("Hint");
+    connect(hintButton, &QPushButton::clicked, this, &game2048::showHint);
+
+    autoplayButton = new QPushButton("Autoplay");
+    connect(autoplayButton, &QPushButton::clicked, this, &game2048::toggleAutoplay);
+
+    QPushButton *wallButton = new QPushButton("AI Wall");
+    wallButton->setToolTip("Watch many AI games at once");
+    connect(wallButton, &QPushButton::clicked, this, &game2048::showSpectatorWall);
+
+    undoButton = new QPushButton("Undo");
+    connect(undoButton, &QPushButton::clicked, this, &game2048::undoMove);
+
+    redoButton = new QPushButton("Redo");
+    connect(redoButton, &QPushButton::clicked, this, &game2048::redoMove);
+    updateHistoryButtons();
+
+    // AI
+    QSettings aiSettings("backIntimeBytes", "game2048");
+    solver.setDepth(aiSettings.value("SearchDepth", solver.depth()).toInt());
+    // Weights tuned by tune2048 replace the default heuristic weights when their file is present
+    QString heuristicPath = QCoreApplication::applicationDirPath() + "/heuristic2048.weights";
+    Heuristic2048::Weights tunedWeights;
+    if (Heuristic2048::loadWeights(aiSettings.value("HeuristicWeights", heuristicPath).toString(), tunedWeights)) {
+        tunedHeuristic = std::make_unique<Heuristic2048>(tunedWeights);
+        solver.setHeuristic(tunedHeuristic.get());
+        analysis.setHeuristic(tunedHeuristic.get());
+        evilSpawner.setHeuristic(tunedHeuristic.get());
+    }
+    // A trained network replaces the heuristic when its weights file is present
+    QString weightsPath = QCoreApplication::applicationDirPath() + "/ntuple2048.weights";
+    if (network.load(aiSettings.value("NTupleWeights", weightsPath).toString())) {
+        solver.setEvaluator(&network);
+        winEstimator.setEvaluator(&network);
+        analysis.setEvaluator(&network);
+    }
+    board = GridBoard2048(aiSettings.value("BoardSize", Board2048::Size).toInt());
+    hardMode = aiSettings.value("HardMode", false).toBool();
+    boardView->setBoard(board);
+    // Perfect hints on 3x3 come from a table solved offline by solve2048
+    QString exactPath = QCoreApplication::applicationDirPath() + "/solve2048-3x3.table";
+    exactSolver.load(aiSettings.value("ExactTable", exactPath).toString());
+    updateAiButtons();
+    hintTimeMs = aiSettings.value("HintTimeMs", hintTimeMs).toInt();
+    autoplayTimeMs = aiSettings.value("AutoplayTimeMs", autoplayTimeMs).toInt();
+    autoplayTimer = new QTimer(this);
+    autoplayTimer->setInterval(50);
+    connect(autoplayTimer, &QTimer::timeout, this, &game2048::autoplayStep);
+    moveTimer = new QTimer(this);
+    moveTimer->setInterval(FrameIntervalMs);
+    connect(moveTimer, &QTimer::timeout, this, &game2048::playPendingMoves);
+    searchWatcher = new QFutureWatcher<int>(this);
+    connect(searchWatcher, &QFutureWatcher<int>::finished, this, &game2048::searchFinished);
+    winChanceTimer = new QTimer(this);
+    winChanceTimer->setInterval(100);
+    connect(winChanceTimer, &QTimer::timeout, this, &game2048::showWinChance);
+    winChanceTimer->start();
+
     // set theme
     int randTheme = rand() % 4 + 1;
     changeTheme(randTheme);
@@ -104,13 +167,23 @@ game2048::game2048(QWidget *parent)
     // Connect
     connect(settingsWindow, &SettingsWindow::changeThemeClicked, this, &game2048::changeTheme);
     connect(settingsWindow, &SettingsWindow::changeButtonClicked, this, &game2048::changeButtonColor);
+    connect(settingsWindow, &SettingsWindow::changeSearchDepthClicked, this, &game2048::changeSearchDepth);
+    connect(settingsWindow, &SettingsWindow::changeBoardSizeClicked, this, &game2048::changeBoardSize);
+    connect(settingsWindow, &SettingsWindow::changeHardModeClicked, this, &game2048::changeHardMode);
+    connect(settingsWindow, &SettingsWindow::playVariantClicked, this, &game2048::playVariant);
     connect(exitButton, &QPushButton::clicked, this, &game2048::actionExitClicked);
 
     // Add widget
     verticalLayout->addWidget(bestScoreLabel);
+    verticalLayout->addWidget(winChanceLabel);
     QHBoxLayout *buttonLayout = new QHBoxLayout();
     buttonLayout->addWidget(helpButton);
     buttonLayout->addWidget(settingsButton);
+    buttonLayout->addWidget(hintButton);
+    buttonLayout->addWidget(autoplayButton);
+    buttonLayout->addWidget(wallButton);
+    buttonLayout->addWidget(undoButton);
+    buttonLayout->addWidget(redoButton);
     verticalLayout->addLayout(buttonLayout);
     layout->addWidget(resetButton, 5, 0, 1, 2);
     layout->addWidget(exitButton, 5, 2, 1, 2);
@@ -122,6 +195,11 @@ game2048::game2048(QWidget *parent)
  */
 game2048::~game2048()
 {
+    // The background search uses the solver, which is about to be destroyed
+    solver.cancel();
+    searchWatcher->waitForFinished();
+    // The games of the wall use the network, which is about to be destroyed
+    delete spectatorWall;
 }
 
 /**
@@ -144,425 +222,501 @@ void game2048::keyPressEvent(QKeyEvent *event)
         return;
     }
 
-    bool moved = false;
-    bool mergePossible = false;
+    if (event->matches(QKeySequence::Undo)) {
+        undoMove();
+        return;
+    }
+    if (event->matches(QKeySequence::Redo)) {
+        redoMove();
+        return;
+    }
+
+    Board2048::Direction direction;
+    if (!directionForKey(event->key(), direction)) {
+        QMainWindow::keyPressEvent(event);
+        return;
+    }
+
+    // An auto-repeat only tops up an empty queue, so holding a key never builds a backlog;
+    // distinct presses are all kept, however fast they come
+    if ((event->isAutoRepeat() && !pendingMoves.isEmpty()) || pendingMoves.size() >= MaxPendingMoves) {
+        return;
+    }
+    pendingMoves.append(direction);
+    // The first move after a pause is played at once, later ones once per frame
+    if (!moveTimer->isActive()) {
+        playPendingMoves();
+        moveTimer->start();
+    }
+}
+
+/**
+ * @brief Plays the moves queued since the last frame, and stops the frame clock once idle.
+ */
+void game2048::playPendingMoves()
+{
+    if (pendingMoves.isEmpty()) {
+        moveTimer->stop();
+        return;
+    }
+    // Take the queue first: a win or lose message runs its own event loop
+    QVector<Board2048::Direction> directions;
+    directions.swap(pendingMoves);
+    applyMoves(directions);
+}
 
-    switch (event->key()) {
+/**
+ * @brief Maps a movement key to the direction it slides the tiles.
+ * @param key The Qt key code.
+ * @param direction Receives the direction of the move.
+ * @return True if the key is a movement key, false otherwise.
+ */
+bool game2048::directionForKey(int key, Board2048::Direction &direction)
+{
+    switch (key) {
     case Qt::Key_W:
     case Qt::Key_Up:
-        if (!checkLose()) {
-            // Attempt merging and move up
-            mergePossible = merge('w');
-            moved = moveUp();
-
-            //updateGameState();
-        }
-        break;
+        direction = Board2048::Up;
+        return true;
     case Qt::Key_S:
     case Qt::Key_Down:
-        if (!checkLose()) {
-            mergePossible = merge('s');
-            moved = moveDown();
-
-            //updateGameState();
-        }
-        break;
+        direction = Board2048::Down;
+        return true;
     case Qt::Key_A:
     case Qt::Key_Left:
-        if (!checkLose()) {
-            mergePossible = merge('a');
-            moved = moveLeft();
-
-            //updateGameState();
-        }
-        break;
+        direction = Board2048::Left;
+        return true;
     case Qt::Key_D:
     case Qt::Key_Right:
-        if (!checkLose()) {
-            mergePossible = merge('d');
-            moved = moveRight();
-
-            //updateGameState();
-        }
-        break;
+        direction = Board2048::Right;
+        return true;
     default:
-        QMainWindow::keyPressEvent(event);
-        return;
+        return false;
     }
+}
 
-    // If merging didn't occur but moving did, attempt merging again
-    if (!mergePossible && moved) {
-        switch (event->key()) {
-        case Qt::Key_W:
-        case Qt::Key_Up:
-            mergePossible = merge('w');
-            break;
-        case Qt::Key_S:
-        case Qt::Key_Down:
-            mergePossible = merge('s');
-            break;
-        case Qt::Key_A:
-        case Qt::Key_Left:
-            mergePossible = merge('a');
-
+/**
+ * @brief Plays moves one after the other and refreshes the game once, on the final position.
+ * @param directions The directions of the moves, in order.
+ */
+void game2048::applyMoves(const QVector<Board2048::Direction> &directions)
+{
+    GridBoard2048 before;
+    Board2048::Direction lastDirection = Board2048::Up;
+    int played = 0;
+    int totalAdded = 0;
+    // The hard-mode spawns of a burst share the thinking time of a single spawn, so the GUI never stalls
+    QDeadlineTimer spawnBudget(EvilSpawner2048::DefaultTimeMs, Qt::PreciseTimer);
+    for (Board2048::Direction direction : directions) {
+        if (board.checkLose()) {
             break;
-        case Qt::Key_D:
-        case Qt::Key_Right:
-            mergePossible = merge('d');
+        }
+        GridBoard2048 previous = board;
+        int addedScore = 0;
+        if (!board.move(direction, &addedScore)) {
+            continue;
+        }
+        generateRandomNumber(static_cast<int>(spawnBudget.remainingTime()));
+        history.push(board, addedScore);
+        totalAdded += addedScore;
+        before = previous;
+        lastDirection = direction;
+        ++played;
+        if (win == 0 && board.checkWin()) {
             break;
         }
     }
-
-    if (mergePossible || moved) {
-        generateRandomNumber();
-        updateGrid();
-        updateGameState();
-        // // Debugging statements
-        // qDebug() << "Moved: " << moved;
-        // qDebug() << "Merge possible: " << mergePossible;
-        // qDebug() << "Lose state: " << checkLose();
-
+    if (played == 0) {
+        return;
     }
 
-
+    playSlideSound();
+    if (totalAdded > 0) {
+        updateScore(totalAdded);
+    }
+    updateHistoryButtons();
+    // Only a single move is animated; a burst jumps straight to where it ended
+    if (played == 1) {
+        boardView->animateMove(before, lastDirection, board);
+    } else {
+        boardView->setBoard(board);
+    }
+    updateWinChance();
+    updateGameState();
 }
 
 /**
- * @brief Resets the game.
+ * @brief Plays the slide sound, unless it was started only a moment ago.
  */
-void game2048::resetGame()
+void game2048::playSlideSound()
 {
-    score = 0; // Reset the score to 0
-    scoreLabel->setText("Score: " + QString::number(score));
-    // Reset the game grid to initial state
-    for(int i = 0; i < 4; ++i) {
-        for(int j = 0; j < 4; ++j) {
-            grid[i][j] = 0;
-        }
+    if (!slideSoundClock.isValid() || slideSoundClock.elapsed() >= SlideSoundIntervalMs) {
+        slideSoundEffect.play();
+        slideSoundClock.start();
     }
+}
 
-    generateRandomNumber();
-    generateRandomNumber();
+/**
+ * @brief Takes back the last move.
+ */
+void game2048::undoMove()
+{
+    GridBoard2048 previous;
+    int scoreDelta = 0;
+    pendingMoves.clear();
+    if (!gameStarted || !history.undo(previous, scoreDelta)) {
+        return;
+    }
+    if (autoplayTimer->isActive()) {
+        toggleAutoplay();
+    }
 
+    board = previous;
+    score -= scoreDelta;
+    scoreLabel->setText("Score: " + QString::number(score));
     updateGrid();
-    gameStarted = true;
-    win = 0;
+    updateHistoryButtons();
 }
 
 /**
- * @brief Handles the state change of background music.
- * @param status The new media status.
+ * @brief Plays again the last move taken back.
  */
-void game2048::musicStateChanged(QMediaPlayer::MediaStatus status) {
-    if (status == QMediaPlayer::EndOfMedia) {
-        bgSound->setPosition(0); // Restart the music
-        bgSound->play();
+void game2048::redoMove()
+{
+    GridBoard2048 next;
+    int scoreDelta = 0;
+    pendingMoves.clear();
+    if (!gameStarted || !history.redo(next, scoreDelta)) {
+        return;
     }
+
+    board = next;
+    score += scoreDelta;
+    scoreLabel->setText("Score: " + QString::number(score));
+    updateGrid();
+    updateHistoryButtons();
 }
 
 /**
- * @brief Updates the grid display.
+ * @brief Enables the undo and redo buttons according to the history.
  */
-void game2048::updateGrid()
+void game2048::updateHistoryButtons()
 {
-    for(int i = 0; i < 4; ++i) {
-        for(int j = 0; j < 4; ++j) {
-            if(grid[i][j] == 0) {
-                gridButtons[i][j]->setText(""); // Set empty string if the number is 0
-            } else {
-                gridButtons[i][j]->setText(QString::number(grid[i][j])); // Set number as text
+    undoButton->setEnabled(gameStarted && history.canUndo());
+    redoButton->setEnabled(gameStarted && history.canRedo());
+}
 
-            }
-        }
-    }
+/**
+ * @brief Enables the hint and autoplay buttons on the board sizes the AI can play.
+ */
+void game2048::updateAiButtons()
+{
+    // The search plays packed 4x4 boards only; 3x3 hints need the solved table
+    bool searchable = board.size() == Board2048::Size;
+    bool solved = exactSolver.isSolved() && board.size() == exactSolver.rows();
+    hintButton->setEnabled(searchable || solved);
+    autoplayButton->setEnabled(searchable);
 }
 
 /**
- * @brief Generates a random number in the grid.
+ * @brief Highlights the grid edge the AI suggests sliding the tiles towards.
  */
-void game2048::generateRandomNumber()
+void game2048::showHint()
 {
-    bool isEmptyCellAvailable = false;
-    for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 4; ++j) {
-            if (grid[i][j] == 0) {
-                isEmptyCellAvailable = true;
-                break;
-            }
-        }
-        if (isEmptyCellAvailable) {
-            break;
-        }
-    }
-    if (!isEmptyCellAvailable) {
+    if (!gameStarted) {
         return;
     }
-    int row, col;
-    do {
-        row = rand() % 4;
-        col = rand() % 4;
-    } while (grid[row][col] != 0);
-    int randomNumber = (rand() % 10 < 9) ? 2 : 4;
-    grid[row][col] = randomNumber;
+    uint64_t state;
+    Board2048::Direction direction;
+    if (exactSolver.pack(board, state) && exactSolver.bestMove(state, direction)) {
+        // The solved table answers at once, no search needed
+        float expected = 0.0f;
+        exactSolver.value(state, expected);
+        statusBar()->showMessage(QString("AI (exact): %1 more points expected").arg(expected, 0, 'f', 1), 2000);
+        boardView->setHighlight(direction);
+        QTimer::singleShot(300, boardView, &BoardView2048::clearHighlight);
+    } else if (!searchWatcher->isRunning()) {
+        startSearch(true);
+    }
 }
 
 /**
- * @brief Moves tiles upward in the grid.
- * @return True if any tile moved, false otherwise.
+ * @brief Starts or stops the AI playing the game.
  */
-bool game2048::moveUp()
+void game2048::toggleAutoplay()
 {
-    bool moved = false;
-
-    for (int j = 0; j < 4; ++j) {
-        int index = 0;
-        for (int i = 0; i < 4; ++i) {
-            if (grid[i][j] != 0) {
-                if (index != i) {
-                    grid[index][j] = grid[i][j];
-                    grid[i][j] = 0;
-                    moved = true;
-                }
-                ++index;
-            }
-        }
+    if (autoplayTimer->isActive()) {
+        autoplayTimer->stop();
+        autoplayButton->setText("Autoplay");
+    } else if (gameStarted && !board.checkLose()) {
+        autoplayTimer->start();
+        autoplayButton->setText("Stop Autoplay");
     }
-    return moved;
+    // The rollouts would compete with the AI search for the cores
+    winEstimator.setPaused(autoplayTimer->isActive() || searchWatcher->isRunning());
 }
 
-
 /**
- * @brief Moves tiles downward in the grid.
- * @return True if any tile moved, false otherwise.
+ * @brief Plays one AI move while autoplay is on.
  */
-bool game2048::moveDown()
+void game2048::autoplayStep()
 {
-    bool moved = false;
-
-    for (int j = 0; j < 4; ++j) {
-        int index = 3;
-        for (int i = 3; i >= 0; --i) {
-            if (grid[i][j] != 0) {
-                if (index != i) {
-                    grid[index][j] = grid[i][j];
-                    grid[i][j] = 0;
-                    moved = true;
-                }
-                index--;
-            }
-        }
+    if (searchWatcher->isRunning()) {
+        return;
+    }
+    if (!startSearch(false)) {
+        toggleAutoplay();
     }
-
-    return moved;
 }
 
 /**
- * @brief Moves tiles leftward in the grid.
- * @return True if any tile moved, false otherwise.
+ * @brief Starts a timed AI search of the current position on a worker thread.
+ * @param forHint True to highlight the move once found, false to play it.
+ * @return True if a search was started, false if the position cannot be searched.
  */
-bool game2048::moveLeft()
+bool game2048::startSearch(bool forHint)
 {
-    bool moved = false;
-
-    for (int i = 0; i < 4; ++i) {
-        int index = 0;
-        for (int j = 0; j < 4; ++j) {
-            if (grid[i][j] != 0) {
-                if (index != j) {
-                    grid[i][index] = grid[i][j];
-                    grid[i][j] = 0;
-                    moved = true;
-                }
-                index++;
-            }
-        }
+    Board2048 packed;
+    if (!board.toBoard2048(packed)) {
+        return false;
     }
-    return moved;
+
+    // The GUI thread only waits for the finished signal, so input stays responsive
+    searchedBoard = packed;
+    searchForHint = forHint;
+    winEstimator.setPaused(true);
+    int timeLimitMs = forHint ? hintTimeMs : autoplayTimeMs;
+    // A cancel() issued before the worker picks the search up must still stop it
+    uint64_t token = solver.cancelToken();
+    searchWatcher->setFuture(QtConcurrent::run([this, packed, timeLimitMs, token]() {
+        Board2048::Direction direction;
+        return solver.searchTimed(packed, timeLimitMs, direction, token) ? static_cast<int>(direction) : -1;
+    }));
+    return true;
 }
 
 /**
- * @brief Moves tiles rightward in the grid.
- * @return True if any tile moved, false otherwise.
+ * @brief Uses the move found by a background search.
  */
-bool game2048::moveRight()
+void game2048::searchFinished()
 {
-    bool moved = false;
+    int result = searchWatcher->result();
+    winEstimator.setPaused(autoplayTimer->isActive());
+    Board2048 packed;
+    if (!board.toBoard2048(packed) || packed != searchedBoard) {
+        // The player moved, undid or restarted while the AI was thinking
+        return;
+    }
+    if (result < 0) {
+        if (!searchForHint && autoplayTimer->isActive()) {
+            toggleAutoplay();
+        }
+        return;
+    }
 
-    for (int i = 0; i < 4; ++i) {
-        int index = 3;
-        for (int j = 3; j >= 0; --j) {
-            if (grid[i][j] != 0) {
-                if (index != j) {
-                    grid[i][index] = grid[i][j];
-                    grid[i][j] = 0;
-                    moved = true;
-                }
-                index--;
-            }
+    Board2048::Direction direction = static_cast<Board2048::Direction>(result);
+    QString evaluator = solver.evaluator() != nullptr ? "n-tuple" : "heuristic";
+    statusBar()->showMessage(QString("AI (%1): depth %2, %3 nodes").arg(evaluator).arg(solver.reachedDepth()).arg(solver.nodeCount()), 2000);
+    if (searchForHint) {
+        boardView->setHighlight(direction);
+        QTimer::singleShot(300, boardView, &BoardView2048::clearHighlight);
+    } else if (autoplayTimer->isActive()) {
+        // Pause while the move is applied, since a win or lose message runs its own event loop
+        autoplayTimer->stop();
+        applyMoves({ direction });
+        if (board.checkLose()) {
+            autoplayButton->setText("Autoplay");
+            winEstimator.setPaused(false);
+        } else {
+            autoplayTimer->start();
         }
     }
-    return moved;
 }
 
 /**
- * @brief Checks if there are adjacent duplicates in the grid.
- * @return True if adjacent duplicates are found, false otherwise.
+ * @brief Opens a window where many AI games play at once, at the current search depth.
  */
-bool game2048::hasAdjacentDuplicates() const
+void game2048::showSpectatorWall()
 {
-    // Check horizontally
-    for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 3; ++j) {
-            if (grid[i][j] == grid[i][j+1]) {
-                return true;
-            }
-        }
-    }
-
-    // Check vertically
-    for (int i = 0; i < 3; ++i) {
-        for (int j = 0; j < 4; ++j) {
-            if (grid[i][j] == grid[i+1][j]) {
-                return true;
-            }
-        }
+    if (spectatorWall == nullptr) {
+        spectatorWall = new SpectatorWall2048(&network, solver.depth(), this);
+        spectatorWall->setAttribute(Qt::WA_DeleteOnClose);
     }
+    spectatorWall->show();
+    spectatorWall->raise();
+}
 
-    // No adjacent duplicates found
-    return false;
+/**
+ * @brief Opens a window playing a variant of the game, on its own board.
+ * @param variant 0 for the 4x4x4 cube, 1 for the hexagon.
+ */
+void game2048::playVariant(int variant)
+{
+    const LineBoard2048::Shape &shape = variant == 0 ? LineBoard2048::Shape::cube() : LineBoard2048::Shape::hexagon();
+    VariantGame2048 *window = new VariantGame2048(shape, this);
+    window->setAttribute(Qt::WA_DeleteOnClose);
+    window->show();
 }
 
+/**
+ * @brief Changes how many moves the AI looks ahead.
+ * @param depth The new search depth.
+ */
+void game2048::changeSearchDepth(int depth)
+{
+    solver.cancel();
+    searchWatcher->waitForFinished();
+    solver.setDepth(depth);
+    QSettings settings("backIntimeBytes", "game2048");
+    settings.setValue("SearchDepth", solver.depth());
+}
 
 /**
- * @brief Merges tiles in the grid in the specified direction.
- * @param direction The direction to merge ('w', 's', 'a', 'd').
- * @return True if any merge occurred, false otherwise.
+ * @brief Changes the number of rows and columns, starting a new game.
+ * @param size The new board size.
  */
-bool game2048::merge(char direction)
+void game2048::changeBoardSize(int size)
 {
-    bool merged = false;
-    int mergedNumber = 0;
+    if (autoplayTimer->isActive()) {
+        toggleAutoplay();
+    }
+    board = GridBoard2048(size);
+    QSettings settings("backIntimeBytes", "game2048");
+    settings.setValue("BoardSize", board.size());
+    updateAiButtons();
 
-    switch (direction) {
-    case 'w': // Merge Up
-        for (int j = 0; j < 4; ++j) {
-            for (int i = 0; i < 3; ++i) {
-                if (grid[i][j] != 0 && grid[i][j] == grid[i + 1][j]) {
-                    // Merge if adjacent numbers are equal
-                    merged = true;
-                    mergedNumber = grid[i][j] * 2;
-                    grid[i][j] = mergedNumber;
-                    grid[i + 1][j] = 0;
-                    updateScore(mergedNumber);
-                }
-            }
-        }
-        slideSoundEffect.play();
-        break;
-    case 's': // Merge Down
-        for (int j = 0; j < 4; ++j) {
-            for (int i = 3; i > 0; --i) {
-                if (grid[i][j] != 0 && grid[i][j] == grid[i - 1][j]) {
-                    merged = true;
-                    mergedNumber = grid[i][j] * 2;
-                    grid[i][j] = mergedNumber;
-                    grid[i - 1][j] = 0;
-                    updateScore(mergedNumber);
-                }
-            }
-        }
-        slideSoundEffect.play();
-        break;
-    case 'a': // Merge Left
-        for (int i = 0; i < 4; ++i) {
-            for (int j = 0; j < 3; ++j) {
-                if (grid[i][j] != 0 && grid[i][j] == grid[i][j + 1]) {
-                    merged = true;
-                    mergedNumber = grid[i][j] * 2;
-                    grid[i][j] = mergedNumber;
-                    grid[i][j + 1] = 0;
-                    updateScore(mergedNumber);
-                }
-            }
-        }
-        slideSoundEffect.play();
-        break;
-    case 'd': // Merge Right
-        for (int i = 0; i < 4; ++i) {
-            for (int j = 3; j > 0; --j) {
-                if (grid[i][j] != 0 && grid[i][j] == grid[i][j - 1]) {
-                    merged = true;
-                    mergedNumber = grid[i][j] * 2;
-                    grid[i][j] = mergedNumber;
-                    grid[i][j - 1] = 0;
-                    updateScore(mergedNumber);
-                }
-            }
-        }
-        slideSoundEffect.play();
-        break;
-    default:
-        break;
+    if (gameStarted) {
+        resetGame();
+    } else {
+        updateGrid();
     }
-    return merged;
 }
 
 /**
- * @brief Checks if the game has been won.
- * @return True if the game has been won, false otherwise.
+ * @brief Switches between random and adversarial tile spawns, starting a new game.
+ * @param enabled True for hard mode.
  */
-bool game2048::checkWin() const
+void game2048::changeHardMode(bool enabled)
 {
-    for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 4; ++j) {
-            if (grid[i][j] == 2048) {
+    hardMode = enabled;
+    QSettings settings("backIntimeBytes", "game2048");
+    settings.setValue("HardMode", hardMode);
 
-                return true;
-            }
-        }
+    if (gameStarted) {
+        resetGame();
+    } else {
+        updateGrid();
     }
-    return false;
 }
 
-
+/**
+ * @brief Resets the game with a fresh random seed.
+ */
+void game2048::resetGame()
+{
+    startGame(QRandomGenerator::global()->generate64());
+}
 
 /**
- * @brief Checks if the game has been lost.
- * @return True if the game has been lost, false otherwise.
+ * @brief Starts a new game whose tile spawns are determined by a seed.
+ * @param seed The seed of the game.
  */
-bool game2048::checkLose() const
+void game2048::startGame(quint64 seed)
 {
-    // Check for adjacent duplicates
-    bool hasDuplicates = hasAdjacentDuplicates();
+    analysis.stop();
+    pendingMoves.clear();
+    gameSeed = seed;
+    rng.setSeed(seed);
+    score = 0; // Reset the score to 0
+    scoreLabel->setText("Score: " + QString::number(score));
+    // Reset the game grid to initial state
+    board = GridBoard2048(board.size());
 
-    // Check for empty cells
-    bool hasEmptyCells = false;
-    for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 4; ++j) {
-            if (grid[i][j] == 0) {
-                hasEmptyCells = true;
-                break;
-            }
-        }
-        if (hasEmptyCells) {
-            break;
-        }
-    }
+    generateRandomNumber();
+    generateRandomNumber();
 
-    // Return true if there are no adjacent duplicates and no empty cells
-    return !hasDuplicates && !hasEmptyCells;
+    gameStarted = true;
+    updateGrid();
+    win = 0;
+    history.reset(board);
+    updateHistoryButtons();
 }
 
+/**
+ * @brief Handles the state change of background music.
+ * @param status The new media status.
+ */
+void game2048::musicStateChanged(QMediaPlayer::MediaStatus status) {
+    if (status == QMediaPlayer::EndOfMedia) {
+        bgSound->setPosition(0); // Restart the music
+        bgSound->play();
+    }
+}
 
+/**
+ * @brief Updates the grid display.
+ */
+void game2048::updateGrid()
+{
+    boardView->setBoard(board);
+    updateWinChance();
+}
 
+/**
+ * @brief Restarts the win chance estimate on the current position.
+ */
+void game2048::updateWinChance()
+{
+    // Rollouts play packed 4x4 boards only, and spawn at random
+    Board2048 packed;
+    if (gameStarted && !hardMode && board.toBoard2048(packed) && !packed.checkLose()) {
+        winEstimator.start(packed);
+    } else {
+        winEstimator.stop();
+    }
+    shownRollouts = -1;
+}
 
+/**
+ * @brief Shows the latest win chance estimate next to the score.
+ */
+void game2048::showWinChance()
+{
+    WinEstimator2048::Estimate estimate = winEstimator.estimate();
+    if (estimate.rollouts == shownRollouts) {
+        return;
+    }
+    shownRollouts = estimate.rollouts;
+    if (estimate.rollouts == 0) {
+        winChanceLabel->setText("Chance of 2048: -");
+        return;
+    }
+    double chance2048 = 100.0 * estimate.reached[0] / estimate.rollouts;
+    double chance4096 = 100.0 * estimate.reached[1] / estimate.rollouts;
+    winChanceLabel->setText(QString("Chance of 2048: %1%, of 4096: %2%").arg(chance2048, 0, 'f', 1).arg(chance4096, 0, 'f', 1));
+}
+
+/**
+ * @brief Places a 2 or a 4 on a random empty cell, drawn from the game's own generator.
+ * @param timeLimitMs The time the adversary may think, in milliseconds; 0 for its quickest spawn.
+ */
+void game2048::generateRandomNumber(int timeLimitMs)
+{
+    // The adversary plays packed 4x4 boards only
+    Board2048 packed;
+    if (hardMode && board.toBoard2048(packed)) {
+        board = GridBoard2048(Board2048(evilSpawner.worstSpawn(packed.bits(), timeLimitMs)));
+        return;
+    }
+    board.spawnTile(rng);
+}
 
 /**
  * @brief Updates the game state after a move.
  */
 void game2048::updateGameState()
 {
-    if (checkWin()) {
+    if (board.checkWin()) {
         win += 1;
         if(win<=1){
             QMessageBox winMessage;
@@ -572,16 +726,56 @@ void game2048::updateGameState()
             winMessage.setIconPixmap(winPixmap.scaled(64, 64, Qt::KeepAspectRatio, Qt::SmoothTransformation)); // Scale the image if necessary
             winMessage.exec();
         }
-    } else if (checkLose()) {
+    } else if (board.checkLose()) {
+        // The review runs while the message is open, so it is well along if the player asks for it
+        bool analysed = startAnalysis();
         QMessageBox loseMessage;
         loseMessage.setText("Sorry!");
         loseMessage.setInformativeText("Game Over. Good luck next time!");
         QPixmap losePixmap(":/image/2048lose.png");
         loseMessage.setIconPixmap(losePixmap.scaled(64, 64, Qt::KeepAspectRatio, Qt::SmoothTransformation)); // Scale the image if necessary
+        QPushButton *analyseButton = analysed ? loseMessage.addButton("Analyse Game", QMessageBox::ActionRole) : nullptr;
+        loseMessage.addButton(QMessageBox::Ok);
         loseMessage.exec();
+        if (analyseButton != nullptr && loseMessage.clickedButton() == analyseButton) {
+            showAnalysis();
+        }
     }
 }
 
+/**
+ * @brief Starts reviewing the moves of the game in the background.
+ * @return True if a review was started, false if the game cannot be analysed.
+ */
+bool game2048::startAnalysis()
+{
+    // The search plays packed 4x4 boards only
+    QVector<uint64_t> positions;
+    for (int i = 0; i <= history.position(); ++i) {
+        Board2048 packed;
+        if (!history.at(i).toBoard2048(packed)) {
+            return false;
+        }
+        positions.append(packed.bits());
+    }
+    if (positions.size() < 2) {
+        return false;
+    }
+    analysedMoves = static_cast<int>(positions.size()) - 1;
+    analysisFuture = analysis.start(positions);
+    return true;
+}
+
+/**
+ * @brief Opens a window following the review started by startAnalysis().
+ */
+void game2048::showAnalysis()
+{
+    AnalysisDialog2048 *dialog = new AnalysisDialog2048(analysisFuture, analysedMoves, analysis.valuesInPoints(), this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->show();
+}
+
 /**
  * @brief Updates the score and best score.
  * @param addedScore The score to add.
@@ -650,6 +844,14 @@ void game2048::showHelp() {
         "<p><b>😢 Losing:\n</b>"
         "   - No valid moves left.\n"
         "   - Keep tiles merging!\n\n"
+        "<p><b>💡 Hint &amp; Autoplay:\n</b>"
+        "   - 'Hint' highlights the side the AI would slide towards.\n"
+        "   - 'Autoplay' lets the AI play until you stop it.\n"
+        "   - The AI plays the classic 4x4 board only.\n\n</p >"
+        "<p><b>↩️ Undo &amp; Redo:\n</b>"
+        "   - 'Undo' (Ctrl+Z) takes back moves, 'Redo' plays them again.\n\n</p >"
+        "<p><b>📐 Board Size:\n</b>"
+        "   - Pick a board from 3x3 to 8x8 in 'Settings'.\n\n</p >"
         "<p><b>🔄 Restart:\n</b>"
         "   - Click 'Start/Restart'.\n"
         "   - Score resets.\n\n</p >"
@@ -691,6 +893,10 @@ void game2048::showSettings() {
     SettingsWindow *settingsWindow = new SettingsWindow(this);
     connect(settingsWindow, &SettingsWindow::changeThemeClicked, this, &game2048::changeTheme);
     connect(settingsWindow, &SettingsWindow::changeButtonClicked, this, &game2048::changeButtonColor);
+    connect(settingsWindow, &SettingsWindow::changeSearchDepthClicked, this, &game2048::changeSearchDepth);
+    connect(settingsWindow, &SettingsWindow::changeBoardSizeClicked, this, &game2048::changeBoardSize);
+    connect(settingsWindow, &SettingsWindow::changeHardModeClicked, this, &game2048::changeHardMode);
+    connect(settingsWindow, &SettingsWindow::playVariantClicked, this, &game2048::playVariant);
     settingsWindow->exec();
 }
 
@@ -724,41 +930,39 @@ void game2048::changeTheme(int theme) {
 }
 
 /**
- * @brief Changes the color of the buttons.
- * @param color The color index.
+ * @brief Changes the color of the tiles.
+ * @param button The color index.
  */
 void game2048::changeButtonColor(int button)
 {
     qDebug() << "changeButtonColor() method called.";
-    QString buttonStyleSheet = "";
+    QColor tileColor;
     switch(button){
     case 1:
-        buttonStyleSheet = "background-color: #D49987";
+        tileColor = QColor(0xD4, 0x99, 0x87);
         //pink
         break;
     case 2:
-        buttonStyleSheet = "background-color: #8E9A6D";
+        tileColor = QColor(0x8E, 0x9A, 0x6D);
         //green
         break;
     case 3:
-        buttonStyleSheet = "background-color: #A981C4";
+        tileColor = QColor(0xA9, 0x81, 0xC4);
         //purple
         break;
     case 4:
-        buttonStyleSheet = "background-color: #7D8E99";
+        tileColor = QColor(0x7D, 0x8E, 0x99);
         //blue
         break;
     case 5:
-        buttonStyleSheet = "background-color: #FDFDFD";
+        tileColor = QColor(0xFD, 0xFD, 0xFD);
         //grey
         break;
     default:
         break;
     }
-    for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 4; ++j) {
-            gridButtons[i][j]->setStyleSheet(buttonStyleSheet);
-        }
+    if (tileColor.isValid()) {
+        boardView->setTileColor(tileColor);
     }
 }
 
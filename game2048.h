@@ -18,12 +18,30 @@
 #include <QMediaPlayer>
 #include <QAudioOutput>
 #include "settingswindow.h"
+#include "board2048.h"
+#include "gridboard2048.h"
+#include "historyring2048.h"
+#include "boardview2048.h"
+#include "expectimax2048.h"
+#include "heuristic2048.h"
+#include "ntuple2048.h"
+#include "exactsolver2048.h"
+#include "evilspawner2048.h"
+#include "gameanalysis2048.h"
+#include "winestimator2048.h"
+#include "rng2048.h"
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QPointer>
+#include <memory>
 
 /**
  * @class game2048
  * @brief The game2048 class represents the main game window for the 2048 game.
  */
 class SettingsWindow;
+class SpectatorWall2048;
 class game2048 : public QMainWindow {
     Q_OBJECT
     QMediaPlayer *bgSound;
@@ -67,10 +85,66 @@ private slots:
      */
     void changeTheme(int theme);
     /**
-     * @brief Slot function to change the color of the buttons.
-     * @param button The index of the selected button color.
+     * @brief Slot function to change the color of the tiles.
+     * @param button The index of the selected tile color.
      */
     void changeButtonColor(int button);
+    /**
+     * @brief Slot function to highlight the move suggested by the AI.
+     */
+    void showHint();
+    /**
+     * @brief Slot function to start or stop the AI playing the game.
+     */
+    void toggleAutoplay();
+    /**
+     * @brief Slot function that plays one AI move while autoplay is on.
+     */
+    void autoplayStep();
+    /**
+     * @brief Slot function to open a window where many AI games play at once.
+     */
+    void showSpectatorWall();
+    /**
+     * @brief Slot function to open a window playing a variant of the game.
+     * @param variant 0 for the 4x4x4 cube, 1 for the hexagon.
+     */
+    void playVariant(int variant);
+    /**
+     * @brief Slot function to change how many moves the AI looks ahead.
+     * @param depth The new search depth.
+     */
+    void changeSearchDepth(int depth);
+    /**
+     * @brief Slot function to change the number of rows and columns, starting a new game.
+     * @param size The new board size.
+     */
+    void changeBoardSize(int size);
+    /**
+     * @brief Slot function to switch between random and adversarial tile spawns, starting a new game.
+     * @param enabled True for hard mode, where the spawns are chosen by the EvilSpawner2048.
+     */
+    void changeHardMode(bool enabled);
+    /**
+     * @brief Slot function to take back the last move.
+     */
+    void undoMove();
+    /**
+     * @brief Slot function to play again the last move taken back.
+     */
+    void redoMove();
+    /**
+     * @brief Slot function that uses the move found by a background search.
+     */
+    void searchFinished();
+    /**
+     * @brief Slot function to show the latest win chance estimate next to the score.
+     */
+    void showWinChance();
+    /**
+     * @brief Slot function that plays the moves queued since the last frame.
+     */
+    void playPendingMoves();
 
 signals:
     /**
@@ -92,72 +166,88 @@ private:
     SettingsWindow *settingsWindow;
     int bestScore;
     bool gameStarted = false;
-    int grid[4][4];
+    GridBoard2048 board;
+    Rng2048 rng;
+    quint64 gameSeed = 0;
     int score;
     int win = 0;
+    HistoryRing2048 history;
 
     /**
      * @brief Updates the grid representation on the UI.
      */
     void updateGrid();
     /**
-     * @brief Generates a random number on the grid.
+     * @brief Restarts the win chance estimate on the current position.
      */
-    void generateRandomNumber();
+    void updateWinChance();
     /**
-     * @brief Moves the tiles upwards on the grid.
-     * @return True if any tile was moved, false otherwise.
+     * @brief Places a 2 or a 4 on a random empty cell, drawn from the game's own generator.
+     *
+     * In hard mode on the 4x4 board, the EvilSpawner2048 picks the cell and the value instead.
+     * @param timeLimitMs The time the adversary may think, in milliseconds; 0 for its quickest spawn.
      */
-    bool moveUp();
+    void generateRandomNumber(int timeLimitMs = EvilSpawner2048::DefaultTimeMs);
     /**
-     * @brief Moves the tiles downwards on the grid.
-     * @return True if any tile was moved, false otherwise.
+     * @brief Maps a movement key to the direction it slides the tiles.
+     * @param key The Qt key code.
+     * @param direction Receives the direction of the move.
+     * @return True if the key is a movement key, false otherwise.
      */
-    bool moveDown();
+    static bool directionForKey(int key, Board2048::Direction &direction);
     /**
-     * @brief Moves the tiles to the left on the grid.
-     * @return True if any tile was moved, false otherwise.
+     * @brief Plays moves one after the other and refreshes the game once, on the final position.
+     *
+     * Moves that do not change the board are skipped. Play stops early on the first win and on a
+     * lost position, so their messages show the position that caused them.
+     * @param directions The directions of the moves, in order.
      */
-    bool moveLeft();
+    void applyMoves(const QVector<Board2048::Direction> &directions);
     /**
-     * @brief Moves the tiles to the right on the grid.
-     * @return True if any tile was moved, false otherwise.
+     * @brief Plays the slide sound, unless it was started only a moment ago.
      */
-    bool moveRight();
+    void playSlideSound();
     /**
-     * @brief Checks if there are adjacent duplicate tiles on the grid.
-     * @return True if adjacent duplicates are found, false otherwise.
+     * @brief Enables the undo and redo buttons according to the history.
      */
-    bool hasAdjacentDuplicates() const;
+    void updateHistoryButtons();
     /**
-     * @brief Merges the tiles in the specified direction.
-     * @param direction The direction of merging.
-     * @return True if any tiles were merged, false otherwise.
+     * @brief Enables the hint and autoplay buttons on the board sizes the AI can play.
      */
-    bool merge(char direction);
+    void updateAiButtons();
     /**
-     * @brief Checks if the game has been won.
-     * @return True if the game has been won, false otherwise.
+     * @brief Starts a timed AI search of the current position on a worker thread.
+     * @param forHint True to highlight the move once found, false to play it.
+     * @return True if a search was started, false if the position cannot be searched.
      */
-    bool checkWin() const;
-    /**
-     * @brief Checks if the game has been lost.
-     * @return True if the game has been lost, false otherwise.
-     */
-    bool checkLose() const;
+    bool startSearch(bool forHint);
     /**
      * @brief Updates the game state after a move.
      */
     void updateGameState();
+    /**
+     * @brief Starts reviewing the moves of the game in the background.
+     * @return True if a review was started, false if the game cannot be analysed.
+     */
+    bool startAnalysis();
+    /**
+     * @brief Opens a window following the review started by startAnalysis().
+     */
+    void showAnalysis();
     /**
      * @brief Updates the score and best score.
      * @param addedScore The score to add.
      */
     void updateScore(int addedScore);
     /**
-     * @brief Resets the game to its initial state.
+     * @brief Resets the game to its initial state with a fresh random seed.
      */
     void resetGame();
+    /**
+     * @brief Starts a new game whose tile spawns are determined by a seed.
+     * @param seed The seed of the game; the same seed and moves replay the same game.
+     */
+    void startGame(quint64 seed);
     /**
      * @brief Handles the exit action by saving the best score.
      */
@@ -185,11 +275,38 @@ private:
      */
     void musicStateChanged(QMediaPlayer::MediaStatus status);
 
-    QPushButton *gridButtons[4][4];
+    BoardView2048 *boardView;
     QLabel *scoreLabel;
     QLabel *bestScoreLabel;
     QSoundEffect *soundEffect;
     QSoundEffect slideSoundEffect;
+    QElapsedTimer slideSoundClock;
+    QVector<Board2048::Direction> pendingMoves;
+    QTimer *moveTimer;
+    NTuple2048 network;
+    std::unique_ptr<Heuristic2048> tunedHeuristic;
+    Expectimax2048 solver;
+    ExactSolver2048 exactSolver;
+    EvilSpawner2048 evilSpawner;
+    bool hardMode = false;
+    WinEstimator2048 winEstimator;
+    GameAnalysis2048 analysis;
+    QPointer<SpectatorWall2048> spectatorWall;
+    QFuture<GameAnalysis2048::MoveReview> analysisFuture;
+    int analysedMoves = 0;
+    QLabel *winChanceLabel;
+    QTimer *winChanceTimer;
+    qint64 shownRollouts = -1;
+    QTimer *autoplayTimer;
+    QFutureWatcher<int> *searchWatcher;
+    Board2048 searchedBoard;
+    bool searchForHint = false;
+    int hintTimeMs = 100;
+    int autoplayTimeMs = 5;
+    QPushButton *hintButton;
+    QPushButton *autoplayButton;
+    QPushButton *undoButton;
+    QPushButton *redoButton;
 };
 
 #endif // GAME2048_H
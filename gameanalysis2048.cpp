@@ -0,0 +1,103 @@
+/**
+ * @file gameanalysis2048.cpp
+ * @brief Implementation of the GameAnalysis2048 post-game review.
+ */
+#include "gameanalysis2048.h"
+#include <QPromise>
+#include <QtConcurrent>
+#include <bit>
+
+/**
+ * @brief Constructs an idle analysis.
+ * @param depth The search depth of the reviews.
+ */
+GameAnalysis2048::GameAnalysis2048(int depth)
+    : search(depth)
+{
+}
+
+/**
+ * @brief Stops a running analysis and waits for it.
+ */
+GameAnalysis2048::~GameAnalysis2048()
+{
+    stop();
+}
+
+/**
+ * @brief Starts reviewing a game, stopping the previous analysis first.
+ * @param positions The packed positions of the game with the player to move, oldest first.
+ * @return The future that receives one review per move, in game order.
+ */
+QFuture<GameAnalysis2048::MoveReview> GameAnalysis2048::start(const QVector<uint64_t> &positions)
+{
+    stop();
+    uint64_t token = search.cancelToken();
+    running = QtConcurrent::run([this, positions, token](QPromise<MoveReview> &promise) {
+        promise.setProgressRange(0, static_cast<int>(positions.size()) - 1);
+        for (int i = 0; i + 1 < positions.size(); ++i) {
+            if (promise.isCanceled()) {
+                return;
+            }
+            MoveReview review;
+            review.move = i;
+            int played = playedDirections(positions[i], positions[i + 1]);
+            bool legal[4];
+            float values[4];
+            if (played != 0 && search.evaluateMoves(Board2048(positions[i]), legal, values, token) && !promise.isCanceled()) {
+                review.played = static_cast<Board2048::Direction>(std::countr_zero(static_cast<unsigned>(played)));
+                review.best = review.played;
+                for (int d = 0; d < 4; ++d) {
+                    if ((played & (1 << d)) && values[d] > values[review.played]) {
+                        review.played = static_cast<Board2048::Direction>(d);
+                    }
+                    if (legal[d] && values[d] > values[review.best]) {
+                        review.best = static_cast<Board2048::Direction>(d);
+                    }
+                }
+                review.playedValue = values[review.played];
+                review.bestValue = values[review.best];
+                review.loss = review.bestValue - review.playedValue;
+                promise.addResult(review);
+            }
+            promise.setProgressValue(i + 1);
+        }
+    });
+    return running;
+}
+
+/**
+ * @brief Stops the running analysis and waits for it.
+ */
+void GameAnalysis2048::stop()
+{
+    running.cancel();
+    search.cancel();
+    running.waitForFinished();
+}
+
+/**
+ * @brief Finds the directions that lead from one position to the next.
+ * @param before The position before the move.
+ * @param after The position after the move and the spawn that followed it.
+ * @return Bit d set for each direction d that matches, 0 if none does.
+ */
+int GameAnalysis2048::playedDirections(uint64_t before, uint64_t after)
+{
+    int directions = 0;
+    for (int d = 0; d < 4; ++d) {
+        int addedScore = 0;
+        uint64_t next = Board2048::slide(before, static_cast<Board2048::Direction>(d), addedScore);
+        uint64_t diff = next ^ after;
+        if (next == before || diff == 0) {
+            continue;
+        }
+        // The positions must differ by a 2 or a 4 on one cell that the move left empty
+        int shift = 4 * (std::countr_zero(diff) / 4);
+        uint64_t spawned = (after >> shift) & 0xF;
+        if ((diff & ~(0xFULL << shift)) == 0 && ((next >> shift) & 0xF) == 0 && (spawned == 1 || spawned == 2)) {
+            directions |= 1 << d;
+        }
+    }
+    return directions;
+}
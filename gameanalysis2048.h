@@ -0,0 +1,103 @@
+/**
+ * @file gameanalysis2048.h
+ * @brief Declares the GameAnalysis2048 class, which reviews every move of a finished 2048 game.
+ *
+ * Each position of the game is searched with a dedicated Expectimax2048, and the value of the move
+ * the player made is compared with the value of the best move. The positions are reviewed one
+ * after the other on a background thread while the search spreads each one over all cores, and
+ * the reviews are reported through a QFuture as soon as each one is ready. Consecutive positions
+ * of a game share most of their subtrees, so the search keeps its transposition table from one
+ * position to the next instead of starting cold.
+ */
+#ifndef GAMEANALYSIS2048_H
+#define GAMEANALYSIS2048_H
+
+#include <QFuture>
+#include <QVector>
+#include <cstdint>
+#include "board2048.h"
+#include "expectimax2048.h"
+
+/**
+ * @class GameAnalysis2048
+ * @brief The GameAnalysis2048 class measures how much expected value each move of a game gave away.
+ */
+class GameAnalysis2048 {
+public:
+    static constexpr int DefaultDepth = 3;    ///< Search depth of the reviews.
+
+    /**
+     * @brief Review of one move of the game.
+     */
+    struct MoveReview {
+        int move = 0;                                      ///< Index of the move, from 0.
+        Board2048::Direction played = Board2048::Up;       ///< Direction the player chose.
+        Board2048::Direction best = Board2048::Up;         ///< Direction the search prefers.
+        float playedValue = 0.0f;                          ///< Expected value of the played move.
+        float bestValue = 0.0f;                            ///< Expected value of the best move.
+        float loss = 0.0f;                                 ///< bestValue - playedValue, never negative.
+    };
+
+    /**
+     * @brief Constructs an idle analysis.
+     * @param depth The search depth of the reviews.
+     */
+    explicit GameAnalysis2048(int depth = DefaultDepth);
+    /**
+     * @brief Stops a running analysis and waits for it.
+     */
+    ~GameAnalysis2048();
+    GameAnalysis2048(const GameAnalysis2048 &) = delete;
+    GameAnalysis2048 &operator=(const GameAnalysis2048 &) = delete;
+
+    /**
+     * @brief Scores the positions with a trained network, so that losses read as expected points.
+     *
+     * Must not be called while an analysis is running. The network must outlive the analysis.
+     * @param evaluator The network, or nullptr for the static heuristic.
+     */
+    void setEvaluator(const NTuple2048 *evaluator) { search.setEvaluator(evaluator); }
+    /**
+     * @brief Scores the positions with tuned heuristic weights.
+     *
+     * Must not be called while an analysis is running. The heuristic must outlive the analysis.
+     * @param heuristic The heuristic, or nullptr for the default weights.
+     */
+    void setHeuristic(const Heuristic2048 *heuristic) { search.setHeuristic(heuristic); }
+    /**
+     * @brief Tells whether the values are expected points or heuristic units.
+     * @return True if a trained network is set, false otherwise.
+     */
+    bool valuesInPoints() const { return search.evaluator() != nullptr; }
+
+    /**
+     * @brief Starts reviewing a game, stopping the previous analysis first.
+     *
+     * The move played from each position is found by matching the next position against the
+     * outcome of each direction; a move that matches none is skipped, and when several match the
+     * player gets the benefit of the doubt.
+     * @param positions The packed positions of the game with the player to move, oldest first.
+     * @return The future that receives one review per move, in game order.
+     */
+    QFuture<MoveReview> start(const QVector<uint64_t> &positions);
+    /**
+     * @brief Stops the running analysis and waits for it.
+     */
+    void stop();
+
+    /**
+     * @brief Finds the directions that lead from one position to the next.
+     *
+     * A spawn can make two different moves end in the same position, so there may be several.
+     * @param before The position before the move.
+     * @param after The position after the move and the spawn that followed it.
+     * @return Bit d set for each direction d that matches, 0 if none does.
+     */
+    static int playedDirections(uint64_t before, uint64_t after);
+
+private:
+    Expectimax2048 search;
+    QFuture<MoveReview> running;
+};
+
+#endif // GAMEANALYSIS2048_H
@@ -0,0 +1,35 @@
+/**
+ * @file greedy2048.cpp
+ * @brief Implementation of the Greedy2048 one-move policy.
+ */
+#include "greedy2048.h"
+
+/**
+ * @brief Picks the move with the best value one move ahead.
+ * @param bits The packed position.
+ * @param move Receives the move; ties go to the first in Direction order.
+ * @param network The network scoring the afterstates, or nullptr for the heuristic.
+ * @param heuristic The heuristic scoring the afterstates when no network is given.
+ * @return True if a legal move exists, false if the game is lost.
+ */
+bool Greedy2048::choose(uint64_t bits, Move &move, const NTuple2048 *network, const Heuristic2048 &heuristic)
+{
+    bool found = false;
+    float bestValue = 0.0f;
+    for (int d = 0; d < 4; ++d) {
+        int addedScore = 0;
+        uint64_t next = Board2048::slide(bits, static_cast<Board2048::Direction>(d), addedScore);
+        if (next == bits) {
+            continue;
+        }
+        float value = network != nullptr ? addedScore + network->evaluate(next) : heuristic.evaluate(next);
+        if (!found || value > bestValue) {
+            found = true;
+            bestValue = value;
+            move.direction = static_cast<Board2048::Direction>(d);
+            move.afterstate = next;
+            move.addedScore = addedScore;
+        }
+    }
+    return found;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file greedy2048.h
+ * @brief Declares the Greedy2048 class, the one-move greedy policy of the 2048 AI.
+ *
+ * The policy plays the move whose afterstate scores best. With an NTuple2048 network that is the
+ * score gained by the move plus the network's estimate of the score still to come; otherwise it is
+ * the Heuristic2048 value of the afterstate, which already rewards merges. Rollouts, self-play
+ * training, tuning, the spectator wall and the simulator all play it through this one function.
+ */
+#ifndef GREEDY2048_H
+#define GREEDY2048_H
+
+#include "board2048.h"
+#include "heuristic2048.h"
+#include "ntuple2048.h"
+#include <cstdint>
+
+/**
+ * @class Greedy2048
+ * @brief The Greedy2048 class picks the move with the best value one move ahead.
+ */
+class Greedy2048 {
+public:
+    /**
+     * @brief The move picked, with what it leads to.
+     */
+    struct Move {
+        Board2048::Direction direction = Board2048::Up;    ///< Direction of the move.
+        uint64_t afterstate = 0;                            ///< Packed board after the move, before the spawn.
+        int addedScore = 0;                                 ///< Score gained by the move.
+    };
+
+    /**
+     * @brief Picks the move with the best value one move ahead.
+     * @param bits The packed position.
+     * @param move Receives the move; ties go to the first in Direction order.
+     * @param network The network scoring the afterstates, or nullptr for the heuristic.
+     * @param heuristic The heuristic scoring the afterstates when no network is given.
+     * @return True if a legal move exists, false if the game is lost.
+     */
+    static bool choose(uint64_t bits, Move &move, const NTuple2048 *network = nullptr,
+                       const Heuristic2048 &heuristic = Heuristic2048::standard());
+};
+
+#endif // GREEDY2048_H
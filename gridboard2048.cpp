@@ -0,0 +1,725 @@
+/**
+ * @file gridboard2048.cpp
+ * @brief Implementation of the GridBoard2048 engine.
+ */
+#include "gridboard2048.h"
+#include "rng2048.h"
+#include <bit>
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+// The SSSE3 row kernel and the BMI2 select are compiled whatever the target flags and only called
+// on CPUs that have them
+#define GRIDBOARD2048_X86_KERNELS
+#define GRIDBOARD2048_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define GRIDBOARD2048_TARGET_BMI2 __attribute__((target("bmi2")))
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr uint64_t LowBits = 0x7F7F7F7F7F7F7F7FULL;
+constexpr uint64_t HighBits = 0x8080808080808080ULL;
+
+/**
+ * @brief Lookup tables driving the row kernel, indexed by an 8-bit mask with one bit per column.
+ */
+struct LineTables {
+    uint64_t compact[256];       ///< Byte shuffle moving the bytes flagged in the mask to the front.
+    uint64_t spread[256];        ///< A 0x01 byte for every bit of the mask.
+    uint8_t mergeStarts[256];    ///< Left cell of every pair merged, given the cells equal to their right neighbour.
+
+    LineTables()
+    {
+        for (int mask = 0; mask < 256; ++mask) {
+            // Unused shuffle slots read 0x80, which makes pshufb write a zero byte
+            uint64_t control = 0x8080808080808080ULL;
+            int count = 0;
+            uint64_t ones = 0;
+            for (int i = 0; i < 8; ++i) {
+                if (mask & (1 << i)) {
+                    control = (control & ~(0xFFULL << (8 * count))) | (static_cast<uint64_t>(i) << (8 * count));
+                    ++count;
+                    ones |= 1ULL << (8 * i);
+                }
+            }
+            compact[mask] = control;
+            spread[mask] = ones;
+
+            // Pairs are taken greedily from column 0, so a run of k equal tiles merges k / 2 times
+            int starts = 0;
+            for (int i = 0; i < 8; ++i) {
+                bool taken = i > 0 && (starts & (1 << (i - 1)));
+                if ((mask & (1 << i)) && !taken) {
+                    starts |= 1 << i;
+                }
+            }
+            mergeStarts[mask] = static_cast<uint8_t>(starts);
+        }
+    }
+};
+
+/**
+ * @brief Returns the shared line tables, building them on first use.
+ * @return The line tables.
+ */
+const LineTables &lineTables()
+{
+    static const LineTables tables;
+    return tables;
+}
+
+/**
+ * @brief Returns a word with the high bit of every zero byte set.
+ * @param x The word.
+ * @return The zero-byte flags.
+ */
+inline uint64_t zeroBytes(uint64_t x)
+{
+    return ~(((x & LowBits) + LowBits) | x | LowBits);
+}
+
+/**
+ * @brief Gathers the high bit of every byte into an 8-bit mask.
+ * @param flags The byte flags.
+ * @return Bit i set if byte i has its high bit set.
+ */
+inline int byteMask(uint64_t flags)
+{
+    return static_cast<int>((((flags & HighBits) >> 7) * 0x0102040810204080ULL) >> 56);
+}
+
+/**
+ * @brief Moves the non-empty cells of a row word to the front, keeping their order.
+ * @param row The row word.
+ * @param tables The line tables.
+ * @return The compacted row word.
+ */
+inline uint64_t compactRow(uint64_t row, const LineTables &tables)
+{
+    uint64_t control = tables.compact[byteMask(~zeroBytes(row))];
+    uint64_t result = 0;
+    for (int i = 0; i < 8; ++i) {
+        uint64_t index = (control >> (8 * i)) & 0xFF;
+        if (index & 0x80) {
+            break;
+        }
+        result |= ((row >> (8 * index)) & 0xFF) << (8 * i);
+    }
+    return result;
+}
+
+/**
+ * @brief Flags the cells of a compacted row word that can merge with their right neighbour.
+ * @param row The compacted row word.
+ * @return Bit i set if cell i is non-empty, below MaxExponent and equal to cell i + 1.
+ */
+inline int mergeCandidates(uint64_t row)
+{
+    uint64_t equal = zeroBytes(row ^ (row >> 8));
+    uint64_t capped = zeroBytes(row ^ (0x0101010101010101ULL * GridBoard2048::MaxExponent));
+    return byteMask(equal & ~zeroBytes(row) & ~capped) & 0x7F;
+}
+
+/**
+ * @brief Merges the pairs starting at the given cells of a compacted row word.
+ * @param row The compacted row word.
+ * @param starts Bit i set for the left cell of every pair merged.
+ * @param tables The line tables.
+ * @param addedScore Accumulates the score gained by the merges.
+ * @return The row word with every pair merged into its left cell, not compacted.
+ */
+inline uint64_t mergePairs(uint64_t row, int starts, const LineTables &tables, int &addedScore)
+{
+    for (unsigned m = static_cast<unsigned>(starts); m != 0; m &= m - 1) {
+        int e = static_cast<int>((row >> (8 * std::countr_zero(m))) & 0xFF);
+        addedScore += 1 << (e + 1);
+    }
+    uint64_t ones = tables.spread[starts];
+    return (row + ones) & ~((ones * 0xFF) << 8);
+}
+
+/**
+ * @brief Returns the position of the k-th set bit of a mask.
+ * @param mask The mask, with more than k bits set.
+ * @param k The zero-based rank of the bit.
+ * @return The bit position.
+ */
+inline int selectBitScalar(uint64_t mask, int k)
+{
+    // Narrow down the half, quarter and byte holding the k-th set bit, then scan the byte
+    int position = 0;
+    for (int width = 32; width >= 8; width /= 2) {
+        int count = std::popcount((mask >> position) & ((1ULL << width) - 1));
+        if (k >= count) {
+            k -= count;
+            position += width;
+        }
+    }
+    uint64_t byte = (mask >> position) & 0xFF;
+    for (; k > 0; --k) {
+        byte &= byte - 1;
+    }
+    return position + std::countr_zero(byte);
+}
+
+#if defined(GRIDBOARD2048_X86_KERNELS)
+
+/**
+ * @brief Checks once whether the CPU running the program supports SSSE3.
+ * @return True if the pshufb row kernel can run, false otherwise.
+ */
+bool cpuHasSsse3()
+{
+    static const bool supported = __builtin_cpu_supports("ssse3");
+    return supported;
+}
+
+/**
+ * @brief Checks once whether the CPU running the program supports BMI2.
+ * @return True if pdep can run, false otherwise.
+ */
+bool cpuHasBmi2()
+{
+    static const bool supported = __builtin_cpu_supports("bmi2");
+    return supported;
+}
+
+/**
+ * @brief Moves the non-empty cells of a row word to the front with one pshufb.
+ * @param row The row word.
+ * @param tables The line tables.
+ * @return The compacted row word.
+ */
+GRIDBOARD2048_TARGET_SSSE3 inline uint64_t compactRowSsse3(uint64_t row, const LineTables &tables)
+{
+    __m128i v = _mm_cvtsi64_si128(static_cast<long long>(row));
+    int occupied = ~_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) & 0xFF;
+    __m128i control = _mm_cvtsi64_si128(static_cast<long long>(tables.compact[occupied]));
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_shuffle_epi8(v, control)));
+}
+
+/**
+ * @brief Flags the cells of a compacted row word that can merge with their right neighbour, with byte compares.
+ * @param row The compacted row word.
+ * @return Bit i set if cell i is non-empty, below MaxExponent and equal to cell i + 1.
+ */
+GRIDBOARD2048_TARGET_SSSE3 inline int mergeCandidatesSsse3(uint64_t row)
+{
+    __m128i v = _mm_cvtsi64_si128(static_cast<long long>(row));
+    int equal = _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_srli_si128(v, 1)));
+    int empty = _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128()));
+    int capped = _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(GridBoard2048::MaxExponent)));
+    return equal & ~empty & ~capped & 0x7F;
+}
+
+/**
+ * @brief Slides and merges one row word towards column 0, compacting with pshufb.
+ * @param row The row word.
+ * @param addedScore Accumulates the score gained by the merges.
+ * @return The row word after the move.
+ */
+GRIDBOARD2048_TARGET_SSSE3 uint64_t slideRowSsse3(uint64_t row, int &addedScore)
+{
+    const LineTables &tables = lineTables();
+    row = compactRowSsse3(row, tables);
+    int starts = tables.mergeStarts[mergeCandidatesSsse3(row)];
+    if (starts == 0) {
+        return row;
+    }
+    return compactRowSsse3(mergePairs(row, starts, tables, addedScore), tables);
+}
+
+/**
+ * @brief Returns the position of the k-th set bit of a mask with one pdep.
+ * @param mask The mask, with more than k bits set.
+ * @param k The zero-based rank of the bit.
+ * @return The bit position.
+ */
+GRIDBOARD2048_TARGET_BMI2 inline int selectBitBmi2(uint64_t mask, int k)
+{
+    return std::countr_zero(_pdep_u64(1ULL << k, mask));
+}
+
+#endif
+
+/**
+ * @brief Returns the position of the k-th set bit of a mask, with pdep when the CPU has BMI2.
+ * @param mask The mask, with more than k bits set.
+ * @param k The zero-based rank of the bit.
+ * @return The bit position.
+ */
+inline int selectBit(uint64_t mask, int k)
+{
+#if defined(GRIDBOARD2048_X86_KERNELS)
+    if (cpuHasBmi2()) {
+        return selectBitBmi2(mask, k);
+    }
+#endif
+    return selectBitScalar(mask, k);
+}
+
+/**
+ * @brief Reverses the order of the bytes of a word.
+ * @param x The word.
+ * @return The word with byte i moved to byte 7 - i.
+ */
+inline uint64_t byteSwap(uint64_t x)
+{
+    // GCC and Clang compile this to a single bswap
+    x = ((x & 0x00FF00FF00FF00FFULL) << 8) | ((x >> 8) & 0x00FF00FF00FF00FFULL);
+    x = ((x & 0x0000FFFF0000FFFFULL) << 16) | ((x >> 16) & 0x0000FFFF0000FFFFULL);
+    return (x << 32) | (x >> 32);
+}
+
+/**
+ * @brief Packs the four byte exponents of a 4x4 row word into a 16-bit Board2048 row.
+ * @param row The row word, every exponent below 16.
+ * @return The nibble row.
+ */
+inline uint64_t packRow(uint64_t row)
+{
+    row = (row | (row >> 4)) & 0x00FF00FFULL;
+    return (row | (row >> 8)) & 0xFFFFULL;
+}
+
+/**
+ * @brief Spreads a 16-bit Board2048 row into a row word with one byte per exponent.
+ * @param row The nibble row in the low 16 bits.
+ * @return The row word.
+ */
+inline uint64_t unpackRow(uint64_t row)
+{
+    row &= 0xFFFFULL;
+    row = (row | (row << 8)) & 0x00FF00FFULL;
+    return (row | (row << 4)) & 0x0F0F0F0FULL;
+}
+
+} // namespace
+
+/**
+ * @brief Constructs an empty board.
+ * @param size The number of rows and columns, clamped to [MinSize, MaxSize].
+ */
+GridBoard2048::GridBoard2048(int size)
+    : gridSize(size < MinSize ? MinSize : (size > MaxSize ? MaxSize : size))
+{
+    clear();
+}
+
+/**
+ * @brief Constructs a 4x4 board from a packed Board2048.
+ * @param board The packed board.
+ */
+GridBoard2048::GridBoard2048(const Board2048 &board)
+    : GridBoard2048(Board2048::Size)
+{
+    for (int r = 0; r < Board2048::Size; ++r) {
+        rows[r] = unpackRow(board.bits() >> (16 * r));
+    }
+}
+
+/**
+ * @brief Returns the tile value stored in a cell.
+ * @param row The row index.
+ * @param col The column index.
+ * @return The tile value, or 0 if the cell is empty.
+ */
+int GridBoard2048::cell(int row, int col) const
+{
+    int e = exponent(row, col);
+    return e == 0 ? 0 : 1 << e;
+}
+
+/**
+ * @brief Returns the exponent stored in a cell.
+ * @param row The row index.
+ * @param col The column index.
+ * @return The exponent of the tile value, or 0 if the cell is empty.
+ */
+int GridBoard2048::exponent(int row, int col) const
+{
+    return static_cast<int>((rows[row] >> (8 * col)) & 0xFF);
+}
+
+/**
+ * @brief Stores an exponent in a cell.
+ * @param row The row index.
+ * @param col The column index.
+ * @param exponent The exponent of the tile value, or 0 to empty the cell.
+ */
+void GridBoard2048::setExponent(int row, int col, int exponent)
+{
+    uint64_t e = static_cast<uint64_t>(exponent < 0 ? 0 : (exponent > MaxExponent ? MaxExponent : exponent));
+    rows[row] = (rows[row] & ~(0xFFULL << (8 * col))) | (e << (8 * col));
+}
+
+/**
+ * @brief Empties every cell of the board, keeping its size.
+ */
+void GridBoard2048::clear()
+{
+    for (uint64_t &row : rows) {
+        row = 0;
+    }
+}
+
+/**
+ * @brief Slides and merges the tiles in the given direction.
+ * @param direction The direction of the move.
+ * @param addedScore If not null, receives the score gained by the merges.
+ * @return True if any tile moved or merged, false otherwise.
+ */
+bool GridBoard2048::move(Direction direction, int *addedScore)
+{
+    int gained = 0;
+    GridBoard2048 next(*this);
+
+    // 4x4 boards below the nibble cap merge exactly like Board2048, whose row tables are faster
+    Board2048 packed;
+    if (toBoard2048(packed) && !checkExponent(Board2048::MaxExponent)) {
+        uint64_t bits = Board2048::slide(packed.bits(), direction, gained);
+        for (int r = 0; r < Board2048::Size; ++r) {
+            next.rows[r] = unpackRow(bits >> (16 * r));
+        }
+    } else {
+        bool vertical = direction == Board2048::Up || direction == Board2048::Down;
+        bool mirrored = direction == Board2048::Right || direction == Board2048::Down;
+        if (vertical) {
+            next.transpose();
+        }
+        if (mirrored) {
+            next.mirrorRows();
+        }
+        for (int r = 0; r < gridSize; ++r) {
+            next.rows[r] = slideRow(next.rows[r], gained);
+        }
+        if (mirrored) {
+            next.mirrorRows();
+        }
+        if (vertical) {
+            next.transpose();
+        }
+    }
+
+    if (addedScore) {
+        *addedScore = gained;
+    }
+    if (next == *this) {
+        return false;
+    }
+    *this = next;
+    return true;
+}
+
+/**
+ * @brief Checks whether a move in the given direction would change the board.
+ * @param direction The direction to test.
+ * @return True if the move is legal, false otherwise.
+ */
+bool GridBoard2048::canMove(Direction direction) const
+{
+    GridBoard2048 next(*this);
+    return next.move(direction);
+}
+
+/**
+ * @brief Places a 2 (90%) or a 4 (10%) on an empty cell chosen uniformly at random.
+ * @param rng The generator of the game.
+ * @return True if a tile was placed, false if the board is full.
+ */
+bool GridBoard2048::spawnTile(Rng2048 &rng)
+{
+    uint64_t random = rng.next();
+    uint64_t empty = emptyMask();
+    if (empty == 0) {
+        return false;
+    }
+    uint64_t count = static_cast<uint64_t>(std::popcount(empty));
+    int k = static_cast<int>(((random >> 32) * count) >> 32);
+    int position = selectBit(empty, k);
+    setExponent(position / MaxSize, position % MaxSize, static_cast<uint32_t>(random) % 10 < 9 ? 1 : 2);
+    return true;
+}
+
+/**
+ * @brief Checks if there are equal non-empty tiles next to each other.
+ * @return True if adjacent duplicates are found, false otherwise.
+ */
+bool GridBoard2048::hasAdjacentDuplicates() const
+{
+    return adjacentPairs(false) != 0;
+}
+
+/**
+ * @brief Counts the empty cells of the board.
+ * @return The number of empty cells.
+ */
+int GridBoard2048::emptyCount() const
+{
+    return std::popcount(emptyMask());
+}
+
+/**
+ * @brief Returns a mask with bit (row * MaxSize + col) set for every empty cell.
+ * @return The 64-bit empty-cell mask.
+ */
+uint64_t GridBoard2048::emptyMask() const
+{
+    uint64_t columns = (1ULL << gridSize) - 1;
+    uint64_t mask = 0;
+    for (int r = 0; r < gridSize; ++r) {
+        mask |= (static_cast<uint64_t>(byteMask(zeroBytes(rows[r]))) & columns) << (MaxSize * r);
+    }
+    return mask;
+}
+
+/**
+ * @brief Checks if the board holds a 2048 tile.
+ * @return True if the game has been won, false otherwise.
+ */
+bool GridBoard2048::checkWin() const
+{
+    // 2048 is exponent 11
+    return checkExponent(11);
+}
+
+/**
+ * @brief Checks if no move is possible anymore.
+ * @return True if the game has been lost, false otherwise.
+ */
+bool GridBoard2048::checkLose() const
+{
+    // On a full board only a merge can change anything
+    return emptyMask() == 0 && adjacentPairs(true) == 0;
+}
+
+/**
+ * @brief Returns the largest tile on the board.
+ * @return The largest tile value, or 0 for an empty board.
+ */
+int GridBoard2048::maxTile() const
+{
+    int best = 0;
+    for (int r = 0; r < gridSize; ++r) {
+        for (int c = 0; c < gridSize; ++c) {
+            int e = exponent(r, c);
+            if (e > best) {
+                best = e;
+            }
+        }
+    }
+    return best == 0 ? 0 : 1 << best;
+}
+
+/**
+ * @brief Packs the board into a Board2048 for the search code.
+ * @param board Receives the packed board.
+ * @return True if the board is 4x4 and every tile fits a nibble, false otherwise.
+ */
+bool GridBoard2048::toBoard2048(Board2048 &board) const
+{
+    if (gridSize != Board2048::Size) {
+        return false;
+    }
+    uint64_t bits = 0;
+    for (int r = 0; r < Board2048::Size; ++r) {
+        if (rows[r] & 0xF0F0F0F0ULL) {
+            return false;
+        }
+        bits |= packRow(rows[r]) << (16 * r);
+    }
+    board = Board2048(bits);
+    return true;
+}
+
+/**
+ * @brief Records the path of every tile during a move.
+ * @param direction The direction of the move.
+ * @param motions Receives up to MaxSize * MaxSize motions, one per tile.
+ * @return The number of motions written.
+ */
+int GridBoard2048::traceMove(Direction direction, TileMotion *motions) const
+{
+    int n = gridSize;
+    int count = 0;
+    for (int line = 0; line < n; ++line) {
+        // Cell index of each position along the line, starting at the edge the tiles slide towards
+        int cells[MaxSize];
+        for (int k = 0; k < n; ++k) {
+            switch (direction) {
+            case Board2048::Left:
+                cells[k] = line * MaxSize + k;
+                break;
+            case Board2048::Right:
+                cells[k] = line * MaxSize + (n - 1 - k);
+                break;
+            case Board2048::Up:
+                cells[k] = k * MaxSize + line;
+                break;
+            case Board2048::Down:
+                cells[k] = (n - 1 - k) * MaxSize + line;
+                break;
+            }
+        }
+
+        // Same walk as the row kernel: compact towards position 0, merging each equal pair once
+        int placed = 0;
+        int lastExponent = 0;
+        bool mergeable = false;
+        for (int k = 0; k < n; ++k) {
+            int e = exponent(cells[k] / MaxSize, cells[k] % MaxSize);
+            if (e == 0) {
+                continue;
+            }
+            TileMotion &motion = motions[count++];
+            motion.fromCell = static_cast<uint8_t>(cells[k]);
+            motion.exponent = static_cast<uint8_t>(e);
+            if (mergeable && lastExponent == e && e < MaxExponent) {
+                motion.toCell = static_cast<uint8_t>(cells[placed - 1]);
+                motion.merged = true;
+                mergeable = false;
+            } else {
+                motion.toCell = static_cast<uint8_t>(cells[placed++]);
+                motion.merged = false;
+                lastExponent = e;
+                mergeable = true;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Slides and merges one row word towards column 0.
+ *
+ * The row is compacted, the merging pairs are looked up from the mask of cells equal to their right
+ * neighbour, the left cell of each pair is incremented and the right one cleared, and the row is
+ * compacted again. On CPUs with SSSE3 the compactions are single pshufb instructions.
+ * @param row The row word.
+ * @param addedScore Accumulates the score gained by the merges.
+ * @return The row word after the move.
+ */
+uint64_t GridBoard2048::slideRow(uint64_t row, int &addedScore)
+{
+#if defined(GRIDBOARD2048_X86_KERNELS)
+    if (cpuHasSsse3()) {
+        return slideRowSsse3(row, addedScore);
+    }
+#endif
+    return slideRowScalar(row, addedScore);
+}
+
+/**
+ * @brief Slides and merges one row word towards column 0 without SIMD instructions.
+ * @param row The row word.
+ * @param addedScore Accumulates the score gained by the merges.
+ * @return The row word after the move.
+ */
+uint64_t GridBoard2048::slideRowScalar(uint64_t row, int &addedScore)
+{
+    const LineTables &tables = lineTables();
+    row = compactRow(row, tables);
+    int starts = tables.mergeStarts[mergeCandidates(row)];
+    if (starts == 0) {
+        return row;
+    }
+    return compactRow(mergePairs(row, starts, tables, addedScore), tables);
+}
+
+/**
+ * @brief Tells whether slideRow() uses the SSSE3 row kernel.
+ * @return True if the kernel was built and the CPU supports SSSE3, false otherwise.
+ */
+bool GridBoard2048::isVectorized()
+{
+#if defined(GRIDBOARD2048_X86_KERNELS)
+    return cpuHasSsse3();
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Compares two boards of the same size cell by cell.
+ * @param other The other board.
+ * @return True if both boards have the same size and tiles, false otherwise.
+ */
+bool GridBoard2048::operator==(const GridBoard2048 &other) const
+{
+    if (gridSize != other.gridSize) {
+        return false;
+    }
+    for (int r = 0; r < gridSize; ++r) {
+        if (rows[r] != other.rows[r]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Checks if any cell holds the given exponent.
+ * @param exponent The exponent to look for, not 0.
+ * @return True if a cell holds it, false otherwise.
+ */
+bool GridBoard2048::checkExponent(int exponent) const
+{
+    uint64_t pattern = 0x0101010101010101ULL * static_cast<uint64_t>(exponent);
+    for (int r = 0; r < gridSize; ++r) {
+        if (zeroBytes(rows[r] ^ pattern)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Swaps rows and columns.
+ */
+void GridBoard2048::transpose()
+{
+    uint64_t result[MaxSize] = {};
+    for (int r = 0; r < gridSize; ++r) {
+        for (int c = 0; c < gridSize; ++c) {
+            result[c] |= ((rows[r] >> (8 * c)) & 0xFF) << (8 * r);
+        }
+    }
+    for (int r = 0; r < MaxSize; ++r) {
+        rows[r] = result[r];
+    }
+}
+
+/**
+ * @brief Mirrors every row so that the last column becomes column 0.
+ */
+void GridBoard2048::mirrorRows()
+{
+    // Reversing all eight bytes puts column c at byte 7 - c; shift it back to byte size - 1 - c
+    int shift = 8 * (MaxSize - gridSize);
+    for (int r = 0; r < gridSize; ++r) {
+        rows[r] = byteSwap(rows[r]) >> shift;
+    }
+}
+
+/**
+ * @brief Returns a mask with bit (row * MaxSize + col) set for every tile equal to its right or
+ * lower neighbour.
+ * @param mergeableOnly True to leave out pairs at MaxExponent, which never merge.
+ * @return The pair mask.
+ */
+uint64_t GridBoard2048::adjacentPairs(bool mergeableOnly) const
+{
+    uint64_t mask = 0;
+    for (int r = 0; r < gridSize; ++r) {
+        // Bytes past the board size are zero, so the occupancy test also keeps pairs inside the board
+        uint64_t pairs = zeroBytes(rows[r] ^ (rows[r] >> 8));
+        if (r + 1 < gridSize) {
+            pairs |= zeroBytes(rows[r] ^ rows[r + 1]);
+        }
+        pairs &= ~zeroBytes(rows[r]);
+        if (mergeableOnly) {
+            pairs &= ~zeroBytes(rows[r] ^ (0x0101010101010101ULL * MaxExponent));
+        }
+        mask |= static_cast<uint64_t>(byteMask(pairs)) << (MaxSize * r);
+    }
+    return mask;
+}
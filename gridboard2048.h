@@ -0,0 +1,214 @@
+/**
+ * @file gridboard2048.h
+ * @brief Declares the GridBoard2048 class, a 2048 engine for square boards from 3x3 to 8x8.
+ *
+ * Each row is packed into a 64-bit word holding one byte exponent per cell, so a row of any size up
+ * to 8 fits a single SSE register. A move compacts and merges rows with byte shuffles driven by
+ * 256-entry mask tables; columns are handled by transposing the board. 4x4 boards whose tiles fit
+ * a nibble are handed to the Board2048 row tables instead.
+ */
+#ifndef GRIDBOARD2048_H
+#define GRIDBOARD2048_H
+
+#include <cstdint>
+#include "board2048.h"
+
+class Rng2048;
+
+/**
+ * @class GridBoard2048
+ * @brief The GridBoard2048 class stores a square 2048 board of a selectable size.
+ *
+ * Cell (row, col) is the byte at bit offset 8 * col of row word row. Bytes past the board size are
+ * always zero. A byte holds the exponent of the tile value, capped at MaxExponent; two tiles at the
+ * cap never merge.
+ */
+class GridBoard2048 {
+public:
+    using Direction = Board2048::Direction;
+
+    static constexpr int MinSize = 3;        ///< Smallest supported number of rows and columns.
+    static constexpr int MaxSize = 8;        ///< Largest supported number of rows and columns.
+    static constexpr int MaxExponent = 30;   ///< Largest exponent, so that tile values fit an int.
+
+    /**
+     * @brief Describes where one tile travels during a move.
+     */
+    struct TileMotion {
+        uint8_t fromCell;    ///< Cell index (row * MaxSize + col) before the move.
+        uint8_t toCell;      ///< Cell index after the move.
+        uint8_t exponent;    ///< Exponent of the tile before any merge.
+        bool merged;         ///< True if the tile merges into another one at its destination.
+    };
+
+    /**
+     * @brief Constructs an empty board.
+     * @param size The number of rows and columns, clamped to [MinSize, MaxSize].
+     */
+    explicit GridBoard2048(int size = Board2048::Size);
+    /**
+     * @brief Constructs a 4x4 board from a packed Board2048.
+     * @param board The packed board.
+     */
+    explicit GridBoard2048(const Board2048 &board);
+
+    /**
+     * @brief Returns the number of rows and columns.
+     * @return The board size.
+     */
+    int size() const { return gridSize; }
+    /**
+     * @brief Returns the packed exponents of a row.
+     * @param row The row index.
+     * @return The row word, byte col holding the exponent of column col.
+     */
+    uint64_t row(int row) const { return rows[row]; }
+    /**
+     * @brief Returns the tile value stored in a cell.
+     * @param row The row index.
+     * @param col The column index.
+     * @return The tile value, or 0 if the cell is empty.
+     */
+    int cell(int row, int col) const;
+    /**
+     * @brief Returns the exponent stored in a cell.
+     * @param row The row index.
+     * @param col The column index.
+     * @return The exponent of the tile value, or 0 if the cell is empty.
+     */
+    int exponent(int row, int col) const;
+    /**
+     * @brief Stores an exponent in a cell.
+     * @param row The row index.
+     * @param col The column index.
+     * @param exponent The exponent of the tile value, or 0 to empty the cell.
+     */
+    void setExponent(int row, int col, int exponent);
+    /**
+     * @brief Empties every cell of the board, keeping its size.
+     */
+    void clear();
+
+    /**
+     * @brief Slides and merges the tiles in the given direction.
+     * @param direction The direction of the move.
+     * @param addedScore If not null, receives the score gained by the merges.
+     * @return True if any tile moved or merged, false otherwise.
+     */
+    bool move(Direction direction, int *addedScore = nullptr);
+    /**
+     * @brief Checks whether a move in the given direction would change the board.
+     * @param direction The direction to test.
+     * @return True if the move is legal, false otherwise.
+     */
+    bool canMove(Direction direction) const;
+    /**
+     * @brief Places a 2 (90%) or a 4 (10%) on an empty cell chosen uniformly at random.
+     *
+     * Uses one draw per spawn exactly like Board2048::spawnTile(), so a 4x4 game plays out the same
+     * on both engines for the same seed.
+     * @param rng The generator of the game.
+     * @return True if a tile was placed, false if the board is full.
+     */
+    bool spawnTile(Rng2048 &rng);
+
+    /**
+     * @brief Checks if there are equal non-empty tiles next to each other.
+     * @return True if adjacent duplicates are found, false otherwise.
+     */
+    bool hasAdjacentDuplicates() const;
+    /**
+     * @brief Counts the empty cells of the board.
+     * @return The number of empty cells.
+     */
+    int emptyCount() const;
+    /**
+     * @brief Returns a mask with bit (row * MaxSize + col) set for every empty cell.
+     * @return The 64-bit empty-cell mask.
+     */
+    uint64_t emptyMask() const;
+    /**
+     * @brief Checks if the board holds a 2048 tile.
+     * @return True if the game has been won, false otherwise.
+     */
+    bool checkWin() const;
+    /**
+     * @brief Checks if no move is possible anymore.
+     * @return True if the game has been lost, false otherwise.
+     */
+    bool checkLose() const;
+    /**
+     * @brief Returns the largest tile on the board.
+     * @return The largest tile value, or 0 for an empty board.
+     */
+    int maxTile() const;
+
+    /**
+     * @brief Packs the board into a Board2048 for the search code.
+     * @param board Receives the packed board.
+     * @return True if the board is 4x4 and every tile fits a nibble, false otherwise.
+     */
+    bool toBoard2048(Board2048 &board) const;
+    /**
+     * @brief Records the path of every tile during a move.
+     *
+     * This walks the lines one cell at a time and is meant for presentation only.
+     * @param direction The direction of the move.
+     * @param motions Receives up to MaxSize * MaxSize motions, one per tile.
+     * @return The number of motions written.
+     */
+    int traceMove(Direction direction, TileMotion *motions) const;
+
+    /**
+     * @brief Slides and merges one row word towards column 0.
+     *
+     * Runs the SSSE3 kernel when the CPU supports it, or slideRowScalar() otherwise.
+     * @param row The row word.
+     * @param addedScore Accumulates the score gained by the merges.
+     * @return The row word after the move.
+     */
+    static uint64_t slideRow(uint64_t row, int &addedScore);
+    /**
+     * @brief Slides and merges one row word towards column 0 without SIMD instructions.
+     * @param row The row word.
+     * @param addedScore Accumulates the score gained by the merges.
+     * @return The row word after the move.
+     */
+    static uint64_t slideRowScalar(uint64_t row, int &addedScore);
+    /**
+     * @brief Tells whether slideRow() uses the SSSE3 row kernel.
+     * @return True if the kernel was built and the CPU supports SSSE3, false if it runs slideRowScalar().
+     */
+    static bool isVectorized();
+
+    bool operator==(const GridBoard2048 &other) const;
+    bool operator!=(const GridBoard2048 &other) const { return !(*this == other); }
+
+private:
+    /**
+     * @brief Checks if any cell holds the given exponent.
+     * @param exponent The exponent to look for, not 0.
+     * @return True if a cell holds it, false otherwise.
+     */
+    bool checkExponent(int exponent) const;
+    /**
+     * @brief Swaps rows and columns.
+     */
+    void transpose();
+    /**
+     * @brief Mirrors every row so that the last column becomes column 0.
+     */
+    void mirrorRows();
+    /**
+     * @brief Returns a mask with bit (row * MaxSize + col) set for every tile that merges with its
+     * right or lower neighbour.
+     * @param mergeableOnly True to leave out pairs at MaxExponent, which never merge.
+     * @return The pair mask.
+     */
+    uint64_t adjacentPairs(bool mergeableOnly) const;
+
+    int gridSize;
+    uint64_t rows[MaxSize];
+};
+
+#endif // GRIDBOARD2048_H
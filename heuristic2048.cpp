@@ -0,0 +1,171 @@
+/**
+ * @file heuristic2048.cpp
+ * @brief Implementation of the Heuristic2048 weighted evaluation.
+ */
+#include "heuristic2048.h"
+#include "board2048.h"
+#include <QFile>
+#include <QSettings>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const char *const Group = "Heuristic2048";    ///< Settings group of the weights file.
+
+} // namespace
+
+/**
+ * @brief Constructs a heuristic with the default weights.
+ */
+Heuristic2048::Heuristic2048()
+    : Heuristic2048(Weights())
+{
+}
+
+/**
+ * @brief Constructs a heuristic with the given weights.
+ * @param weights The weights.
+ */
+Heuristic2048::Heuristic2048(const Weights &weights)
+{
+    setWeights(weights);
+}
+
+/**
+ * @brief Replaces the weights and rebuilds the line table.
+ * @param weights The new weights.
+ */
+void Heuristic2048::setWeights(const Weights &weights)
+{
+    lineWeights = weights;
+    rows.resize(65536);
+    for (int row = 0; row < 65536; ++row) {
+        int line[4] = { row & 0xF, (row >> 4) & 0xF, (row >> 8) & 0xF, (row >> 12) & 0xF };
+
+        float sum = 0.0f;
+        int empty = 0;
+        int merges = 0;
+        int previous = 0;
+        int counter = 0;
+        int largest = 0;
+        for (int i = 0; i < 4; ++i) {
+            int e = line[i];
+            sum += std::pow(static_cast<float>(e), weights.sumPower);
+            largest = std::max(largest, e);
+            if (e == 0) {
+                ++empty;
+                continue;
+            }
+            if (previous == e) {
+                ++counter;
+            } else if (counter > 0) {
+                merges += 1 + counter;
+                counter = 0;
+            }
+            previous = e;
+        }
+        if (counter > 0) {
+            merges += 1 + counter;
+        }
+
+        float monotonicityLeft = 0.0f;
+        float monotonicityRight = 0.0f;
+        for (int i = 1; i < 4; ++i) {
+            float a = std::pow(static_cast<float>(line[i - 1]), weights.monotonicityPower);
+            float b = std::pow(static_cast<float>(line[i]), weights.monotonicityPower);
+            if (line[i - 1] > line[i]) {
+                monotonicityLeft += a - b;
+            } else {
+                monotonicityRight += b - a;
+            }
+        }
+
+        // A corner tile counts once for its row and once for its column
+        int corner = largest > 0 && (line[0] == largest || line[3] == largest) ? largest : 0;
+
+        rows[row] = weights.lostPenalty + weights.emptyWeight * empty + weights.mergesWeight * merges
+                    - weights.monotonicityWeight * std::min(monotonicityLeft, monotonicityRight)
+                    - weights.sumWeight * sum + weights.cornerWeight * corner;
+    }
+}
+
+/**
+ * @brief Scores a position.
+ * @param bits The packed board.
+ * @return The heuristic value; higher is better.
+ */
+float Heuristic2048::evaluate(uint64_t bits) const
+{
+    const float *table = rows.constData();
+    uint64_t transposed = Board2048::transpose(bits);
+    float value = 0.0f;
+    for (int r = 0; r < 4; ++r) {
+        value += table[(bits >> (16 * r)) & 0xFFFF];
+        value += table[(transposed >> (16 * r)) & 0xFFFF];
+    }
+    return value;
+}
+
+/**
+ * @brief Returns the shared heuristic with the default weights, building it on first use.
+ * @return The default heuristic.
+ */
+const Heuristic2048 &Heuristic2048::standard()
+{
+    static const Heuristic2048 heuristic;
+    return heuristic;
+}
+
+/**
+ * @brief Reads weights from a file written by saveWeights().
+ * @param path The weights file.
+ * @param weights Receives the weights; terms missing from the file keep their defaults.
+ * @return True if the file exists and could be read, false otherwise.
+ */
+bool Heuristic2048::loadWeights(const QString &path, Weights &weights)
+{
+    if (!QFile::exists(path)) {
+        return false;
+    }
+    QSettings file(path, QSettings::IniFormat);
+    if (file.status() != QSettings::NoError) {
+        return false;
+    }
+    Weights defaults;
+    file.beginGroup(Group);
+    weights.lostPenalty = file.value("LostPenalty", defaults.lostPenalty).toFloat();
+    weights.monotonicityPower = file.value("MonotonicityPower", defaults.monotonicityPower).toFloat();
+    weights.monotonicityWeight = file.value("MonotonicityWeight", defaults.monotonicityWeight).toFloat();
+    weights.sumPower = file.value("SumPower", defaults.sumPower).toFloat();
+    weights.sumWeight = file.value("SumWeight", defaults.sumWeight).toFloat();
+    weights.mergesWeight = file.value("MergesWeight", defaults.mergesWeight).toFloat();
+    weights.emptyWeight = file.value("EmptyWeight", defaults.emptyWeight).toFloat();
+    weights.cornerWeight = file.value("CornerWeight", defaults.cornerWeight).toFloat();
+    file.endGroup();
+    return true;
+}
+
+/**
+ * @brief Writes weights to a text file.
+ * @param path The weights file.
+ * @param weights The weights.
+ * @return True on success, false otherwise.
+ */
+bool Heuristic2048::saveWeights(const QString &path, const Weights &weights)
+{
+    QSettings file(path, QSettings::IniFormat);
+    file.clear();
+    file.beginGroup(Group);
+    file.setValue("LostPenalty", weights.lostPenalty);
+    file.setValue("MonotonicityPower", weights.monotonicityPower);
+    file.setValue("MonotonicityWeight", weights.monotonicityWeight);
+    file.setValue("SumPower", weights.sumPower);
+    file.setValue("SumWeight", weights.sumWeight);
+    file.setValue("MergesWeight", weights.mergesWeight);
+    file.setValue("EmptyWeight", weights.emptyWeight);
+    file.setValue("CornerWeight", weights.cornerWeight);
+    file.endGroup();
+    file.sync();
+    return file.status() == QSettings::NoError;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file heuristic2048.h
+ * @brief Declares the Heuristic2048 class, the weighted static evaluation of a 2048 position.
+ *
+ * Every row and every column of a board is scored on its own: a bonus for empty cells, for tiles
+ * that could merge and for a largest tile sitting at one end of the line, and penalties for a line
+ * that is not monotonic and for large tiles in general. The score of each of the 65536 possible
+ * lines is computed once per set of weights, so evaluating a board costs eight table lookups.
+ *
+ * The weights can be saved to and loaded from a small text file, which tune2048 writes and the
+ * game reads for its hints and autoplay.
+ */
+#ifndef HEURISTIC2048_H
+#define HEURISTIC2048_H
+
+#include <QString>
+#include <QVector>
+#include <cstdint>
+
+/**
+ * @class Heuristic2048
+ * @brief The Heuristic2048 class scores 2048 positions with a table built from a set of weights.
+ */
+class Heuristic2048 {
+public:
+    /**
+     * @brief Weights of the terms of a line's score. The defaults are the AI's hand-tuned ones.
+     */
+    struct Weights {
+        float lostPenalty = 200000.0f;        ///< Constant per line, so that any position beats a lost one.
+        float monotonicityPower = 4.0f;       ///< Power of the exponents compared for monotonicity.
+        float monotonicityWeight = 47.0f;     ///< Penalty for a line that rises and falls.
+        float sumPower = 3.5f;                ///< Power of the exponents summed.
+        float sumWeight = 11.0f;              ///< Penalty for large tiles.
+        float mergesWeight = 700.0f;          ///< Bonus for equal neighbours.
+        float emptyWeight = 270.0f;           ///< Bonus for each empty cell.
+        float cornerWeight = 0.0f;            ///< Bonus per exponent of a largest tile at a line end.
+    };
+
+    /**
+     * @brief Constructs a heuristic with the default weights.
+     */
+    Heuristic2048();
+    /**
+     * @brief Constructs a heuristic with the given weights.
+     * @param weights The weights.
+     */
+    explicit Heuristic2048(const Weights &weights);
+
+    /**
+     * @brief Replaces the weights and rebuilds the line table.
+     * @param weights The new weights.
+     */
+    void setWeights(const Weights &weights);
+    /**
+     * @brief Returns the weights.
+     * @return The weights.
+     */
+    const Weights &weights() const { return lineWeights; }
+    /**
+     * @brief Scores a position.
+     * @param bits The packed board.
+     * @return The heuristic value; higher is better.
+     */
+    float evaluate(uint64_t bits) const;
+
+    /**
+     * @brief Returns the shared heuristic with the default weights.
+     * @return The default heuristic.
+     */
+    static const Heuristic2048 &standard();
+    /**
+     * @brief Reads weights from a file written by saveWeights().
+     * @param path The weights file.
+     * @param weights Receives the weights; terms missing from the file keep their defaults.
+     * @return True if the file exists and could be read, false otherwise.
+     */
+    static bool loadWeights(const QString &path, Weights &weights);
+    /**
+     * @brief Writes weights to a text file.
+     * @param path The weights file.
+     * @param weights The weights.
+     * @return True on success, false otherwise.
+     */
+    static bool saveWeights(const QString &path, const Weights &weights);
+
+private:
+    Weights lineWeights;
+    QVector<float> rows;
+};
+
+#endif // HEURISTIC2048_H
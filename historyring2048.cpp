@@ -0,0 +1,156 @@
+/**
+ * @file historyring2048.cpp
+ * @brief Implementation of the HistoryRing2048 undo/redo history.
+ */
+#include "historyring2048.h"
+
+/**
+ * @brief Constructs an empty history.
+ * @param capacity The number of steps kept before the oldest ones are overwritten.
+ */
+HistoryRing2048::HistoryRing2048(int capacity)
+    : capacity(qMax(2, capacity))
+{
+}
+
+/**
+ * @brief Drops every step and records the starting position of a new game.
+ * @param start The starting position.
+ */
+void HistoryRing2048::reset(const GridBoard2048 &start)
+{
+    int size = start.size();
+    if (size != boardSize || stride == 0) {
+        boardSize = size;
+        stride = (size * size * BitsPerCell + 7) / 8;
+        boards.clear();
+        deltas.clear();
+    }
+    first = 0;
+    stored = 0;
+    current = -1;
+    push(start, 0);
+}
+
+/**
+ * @brief Records the position reached by a move, dropping any step that could have been redone.
+ * @param board The position after the move.
+ * @param scoreDelta The score gained by the move.
+ */
+void HistoryRing2048::push(const GridBoard2048 &board, int scoreDelta)
+{
+    stored = current + 1;
+    if (stored == capacity) {
+        // Full: forget the oldest step
+        first = (first + 1) % capacity;
+        --stored;
+    }
+
+    int slot = slotFor(stored);
+    if (slot == deltas.size()) {
+        // The ring only grows until it reaches its capacity, then slots are reused
+        if (deltas.size() == deltas.capacity()) {
+            int grown = qMin(capacity, qMax(1024, 2 * deltas.size()));
+            deltas.reserve(grown);
+            boards.reserve(grown * stride);
+        }
+        deltas.append(0);
+        boards.resize(boards.size() + stride);
+    }
+    store(slot, board);
+    deltas[slot] = scoreDelta;
+    current = stored++;
+}
+
+/**
+ * @brief Steps back to the previous position.
+ * @param board Receives the previous position.
+ * @param scoreDelta Receives the score gained by the undone move.
+ * @return True if there was a move to undo, false otherwise.
+ */
+bool HistoryRing2048::undo(GridBoard2048 &board, int &scoreDelta)
+{
+    if (!canUndo()) {
+        return false;
+    }
+    scoreDelta = scoreDeltaAt(current);
+    board = at(--current);
+    return true;
+}
+
+/**
+ * @brief Steps forward to the position that was undone last.
+ * @param board Receives the next position.
+ * @param scoreDelta Receives the score gained by the redone move.
+ * @return True if there was a move to redo, false otherwise.
+ */
+bool HistoryRing2048::redo(GridBoard2048 &board, int &scoreDelta)
+{
+    if (!canRedo()) {
+        return false;
+    }
+    board = at(++current);
+    scoreDelta = scoreDeltaAt(current);
+    return true;
+}
+
+/**
+ * @brief Returns a stored position.
+ * @param index The step index, between 0 and count() - 1.
+ * @return The position.
+ */
+GridBoard2048 HistoryRing2048::at(int index) const
+{
+    GridBoard2048 board(boardSize);
+    const uint8_t *bytes = boards.constData() + slotFor(index) * stride;
+    uint32_t bits = 0;
+    int available = 0;
+    for (int row = 0; row < boardSize; ++row) {
+        for (int col = 0; col < boardSize; ++col) {
+            if (available < BitsPerCell) {
+                bits |= static_cast<uint32_t>(*bytes++) << available;
+                available += 8;
+            }
+            board.setExponent(row, col, static_cast<int>(bits & ((1u << BitsPerCell) - 1)));
+            bits >>= BitsPerCell;
+            available -= BitsPerCell;
+        }
+    }
+    return board;
+}
+
+/**
+ * @brief Returns the score gained by the move that reached a stored position.
+ * @param index The step index, between 0 and count() - 1.
+ * @return The score delta, 0 for the starting position.
+ */
+int HistoryRing2048::scoreDeltaAt(int index) const
+{
+    return deltas[slotFor(index)];
+}
+
+/**
+ * @brief Packs a board into a slot.
+ * @param slot The slot index.
+ * @param board The board.
+ */
+void HistoryRing2048::store(int slot, const GridBoard2048 &board)
+{
+    uint8_t *bytes = boards.data() + slot * stride;
+    uint32_t bits = 0;
+    int used = 0;
+    for (int row = 0; row < boardSize; ++row) {
+        for (int col = 0; col < boardSize; ++col) {
+            bits |= static_cast<uint32_t>(board.exponent(row, col)) << used;
+            used += BitsPerCell;
+            while (used >= 8) {
+                *bytes++ = static_cast<uint8_t>(bits);
+                bits >>= 8;
+                used -= 8;
+            }
+        }
+    }
+    if (used > 0) {
+        *bytes = static_cast<uint8_t>(bits);
+    }
+}
@@ -0,0 +1,118 @@
+/**
+ * @file historyring2048.h
+ * @brief Declares the HistoryRing2048 class, a bounded undo/redo history of 2048 positions.
+ */
+#ifndef HISTORYRING2048_H
+#define HISTORYRING2048_H
+
+#include <QVector>
+#include <cstdint>
+#include "gridboard2048.h"
+
+/**
+ * @class HistoryRing2048
+ * @brief The HistoryRing2048 class records every position of a game in a fixed-capacity ring.
+ *
+ * A step is stored as the board packed at 5 bits per cell plus the score gained by the move, so a
+ * 4x4 step takes 14 bytes and a million steps fit in 14 MB. When the ring is full the oldest step
+ * is overwritten. Undo and redo only move a cursor and unpack one board, so they never allocate.
+ *
+ * Steps are numbered from 0 (the oldest position still stored) to count() - 1, which also lets
+ * tools replay a whole game with at() and scoreDeltaAt() without simulating it again.
+ */
+class HistoryRing2048 {
+public:
+    static constexpr int DefaultCapacity = 1 << 20;    ///< Steps kept by default.
+
+    /**
+     * @brief Constructs an empty history.
+     * @param capacity The number of steps kept before the oldest ones are overwritten.
+     */
+    explicit HistoryRing2048(int capacity = DefaultCapacity);
+
+    /**
+     * @brief Drops every step and records the starting position of a new game.
+     * @param start The starting position.
+     */
+    void reset(const GridBoard2048 &start);
+    /**
+     * @brief Records the position reached by a move, dropping any step that could have been redone.
+     * @param board The position after the move.
+     * @param scoreDelta The score gained by the move.
+     */
+    void push(const GridBoard2048 &board, int scoreDelta);
+    /**
+     * @brief Steps back to the previous position.
+     * @param board Receives the previous position.
+     * @param scoreDelta Receives the score gained by the undone move.
+     * @return True if there was a move to undo, false otherwise.
+     */
+    bool undo(GridBoard2048 &board, int &scoreDelta);
+    /**
+     * @brief Steps forward to the position that was undone last.
+     * @param board Receives the next position.
+     * @param scoreDelta Receives the score gained by the redone move.
+     * @return True if there was a move to redo, false otherwise.
+     */
+    bool redo(GridBoard2048 &board, int &scoreDelta);
+    /**
+     * @brief Checks if a move can be undone.
+     * @return True if the current position is not the oldest one stored.
+     */
+    bool canUndo() const { return current > 0; }
+    /**
+     * @brief Checks if a move can be redone.
+     * @return True if positions were undone since the last move.
+     */
+    bool canRedo() const { return current + 1 < stored; }
+
+    /**
+     * @brief Returns the number of positions stored, including the ones that can be redone.
+     * @return The number of steps.
+     */
+    int count() const { return stored; }
+    /**
+     * @brief Returns the index of the current position.
+     * @return The step index, between 0 and count() - 1.
+     */
+    int position() const { return current; }
+    /**
+     * @brief Returns a stored position.
+     * @param index The step index, between 0 and count() - 1.
+     * @return The position.
+     */
+    GridBoard2048 at(int index) const;
+    /**
+     * @brief Returns the score gained by the move that reached a stored position.
+     * @param index The step index, between 0 and count() - 1.
+     * @return The score delta, 0 for the starting position.
+     */
+    int scoreDeltaAt(int index) const;
+
+private:
+    static constexpr int BitsPerCell = 5;    ///< Enough for exponents up to GridBoard2048::MaxExponent.
+
+    /**
+     * @brief Returns the ring slot of a step.
+     * @param index The step index.
+     * @return The slot index.
+     */
+    int slotFor(int index) const { return (first + index) % capacity; }
+    /**
+     * @brief Packs a board into a slot.
+     * @param slot The slot index.
+     * @param board The board.
+     */
+    void store(int slot, const GridBoard2048 &board);
+
+    int capacity;
+    int boardSize = Board2048::Size;
+    int stride = 0;      ///< Bytes per packed board.
+    int first = 0;       ///< Slot of step 0.
+    int stored = 0;      ///< Number of steps stored.
+    int current = -1;    ///< Step index of the current position, -1 while empty.
+    QVector<uint8_t> boards;
+    QVector<int32_t> deltas;
+};
+
+#endif // HISTORYRING2048_H
@@ -0,0 +1,468 @@
+/**
+ * @file lineboard2048.cpp
+ * @brief Implementation of the LineBoard2048 engine and its shapes.
+ */
+#include "lineboard2048.h"
+#include "rng2048.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+// The shuffle kernel is compiled for SSSE3 whatever the target flags and only called on CPUs that have it
+#define LINEBOARD2048_SSSE3_KERNEL
+#define LINEBOARD2048_TARGET_SSSE3 __attribute__((target("ssse3")))
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/**
+ * @brief Gathers the exponents of one line into a row word.
+ * @param cells The cells of the board.
+ * @param line The cells of the line, far end first.
+ * @param length The number of cells of the line.
+ * @return The row word, byte k holding the exponent of the k-th cell of the line.
+ */
+inline uint64_t gatherLine(const uint8_t *cells, const uint8_t *line, int length)
+{
+    uint64_t word = 0;
+    for (int k = 0; k < length; ++k) {
+        word |= static_cast<uint64_t>(cells[line[k]]) << (8 * k);
+    }
+    return word;
+}
+
+#if defined(LINEBOARD2048_SSSE3_KERNEL)
+
+/**
+ * @brief Checks once whether the CPU running the program supports SSSE3.
+ * @return True if the shuffle kernel can run, false otherwise.
+ */
+bool cpuHasSsse3()
+{
+    static const bool supported = __builtin_cpu_supports("ssse3");
+    return supported;
+}
+
+/**
+ * @brief Reorders the 64 cells of a board through a table of pshufb masks.
+ * @param from The cells to read, 64 of them.
+ * @param to Receives the reordered cells, 64 of them.
+ * @param shuffles The masks: [out block][in block][lane].
+ */
+LINEBOARD2048_TARGET_SSSE3 inline void shuffleCells(const uint8_t *from, uint8_t *to, const uint8_t (*shuffles)[4][16])
+{
+    __m128i blocks[4];
+    for (int b = 0; b < 4; ++b) {
+        blocks[b] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(from + 16 * b));
+    }
+    for (int out = 0; out < 4; ++out) {
+        __m128i v = _mm_setzero_si128();
+        for (int in = 0; in < 4; ++in) {
+            __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i *>(shuffles[out][in]));
+            v = _mm_or_si128(v, _mm_shuffle_epi8(blocks[in], mask));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(to + 16 * out), v);
+    }
+}
+
+/**
+ * @brief Slides the lines of four cells of a board, gathered and scattered with pshufb.
+ *
+ * The cells are gathered in line order, each block of four lines is packed into nibbles, slid
+ * with the Board2048 row tables and unpacked, and the cells are scattered back if any changed.
+ * @param cells The cells of the board, MaxCells of them.
+ * @param gather The pshufb masks that gather the cells into line order.
+ * @param scatter The pshufb masks that scatter the cells back.
+ * @param lineCount The number of lines, a multiple of four.
+ * @param addedScore Accumulates the score gained by the merges.
+ * @return True if any tile moved or merged, false otherwise.
+ */
+LINEBOARD2048_TARGET_SSSE3 bool moveQuadsSsse3(uint8_t *cells, const uint8_t (*gather)[4][16],
+                                               const uint8_t (*scatter)[4][16], int lineCount, int &addedScore)
+{
+    bool moved = false;
+    alignas(16) uint8_t lined[LineBoard2048::MaxCells];
+    shuffleCells(cells, lined, gather);
+    const __m128i nibbleWeights = _mm_set1_epi16(0x1001);
+    const __m128i lowNibbles = _mm_set1_epi8(0x0F);
+    for (int i = 0; i < lineCount; i += Board2048::Size) {
+        __m128i *block = reinterpret_cast<__m128i *>(lined + 4 * i);
+        __m128i pairs = _mm_maddubs_epi16(_mm_load_si128(block), nibbleWeights);
+        uint64_t bits = static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_packus_epi16(pairs, pairs)));
+        int quadScore = 0;
+        uint64_t slid = Board2048::slide(bits, Board2048::Left, quadScore);
+        if (slid != bits) {
+            moved = true;
+            addedScore += quadScore;
+            __m128i packed = _mm_cvtsi64_si128(static_cast<long long>(slid));
+            __m128i low = _mm_and_si128(packed, lowNibbles);
+            __m128i high = _mm_and_si128(_mm_srli_epi16(packed, 4), lowNibbles);
+            _mm_store_si128(block, _mm_unpacklo_epi8(low, high));
+        }
+    }
+    if (moved) {
+        shuffleCells(lined, cells, scatter);
+    }
+    return moved;
+}
+
+#endif
+
+/**
+ * @brief Gathers four lines of four cells into a packed Board2048, one line per row.
+ * @param cells The cells of the board.
+ * @param line The cells of the four lines, line after line, far end first.
+ * @return The packed board, column 0 holding the far ends.
+ */
+inline uint64_t gatherQuad(const uint8_t *cells, const uint8_t *line)
+{
+    uint64_t bits = 0;
+    for (int k = 0; k < Board2048::CellCount; ++k) {
+        bits |= static_cast<uint64_t>(cells[line[k]]) << (4 * k);
+    }
+    return bits;
+}
+
+/**
+ * @brief Slides the lines of four cells of a board, gathered four lines at a time into a packed Board2048.
+ * @param cells The cells of the board.
+ * @param line The cells of the lines, line after line, far end first.
+ * @param lineCount The number of lines, a multiple of four.
+ * @param addedScore Accumulates the score gained by the merges.
+ * @return True if any tile moved or merged, false otherwise.
+ */
+bool moveQuadsScalar(uint8_t *cells, const uint8_t *line, int lineCount, int &addedScore)
+{
+    bool moved = false;
+    for (int i = 0; i < lineCount; i += Board2048::Size, line += Board2048::CellCount) {
+        uint64_t bits = gatherQuad(cells, line);
+        int quadScore = 0;
+        uint64_t slid = Board2048::slide(bits, Board2048::Left, quadScore);
+        if (slid != bits) {
+            moved = true;
+            addedScore += quadScore;
+            for (int k = 0; k < Board2048::CellCount; ++k) {
+                cells[line[k]] = static_cast<uint8_t>((slid >> (4 * k)) & 0xF);
+            }
+        }
+    }
+    return moved;
+}
+
+/**
+ * @brief Checks if any cell holds a tile too large for the Board2048 row tables.
+ * @param cells The cells of the board, MaxCells of them.
+ * @return True if an exponent of Board2048::MaxExponent or more is found, false otherwise.
+ */
+inline bool hasLargeTile(const uint8_t *cells)
+{
+    // Exponents stay below 0xFF, so adding 1 to each byte never carries into the next one
+    uint64_t large = 0;
+    for (int i = 0; i < LineBoard2048::MaxCells; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, cells + i, sizeof(word));
+        large |= word + 0x0101010101010101ULL;
+    }
+    return (large & 0xF0F0F0F0F0F0F0F0ULL) != 0;
+}
+
+} // namespace
+
+/**
+ * @brief Builds the line tables of a shape.
+ * @param points The coordinates of the cells, at most MaxCells.
+ * @param count The number of cells.
+ * @param vectors The step towards which each direction slides the tiles.
+ * @param directionNames The name of each direction.
+ * @param directionCount The number of directions, at most MaxDirections.
+ */
+LineBoard2048::Shape::Shape(const Point *points, int count, const Point *vectors, const char *const *directionNames,
+                            int directionCount)
+    : cells(count), directions(directionCount)
+{
+    auto find = [points, count](int a, int b, int c) {
+        for (int i = 0; i < count; ++i) {
+            if (points[i].a == a && points[i].b == b && points[i].c == c) {
+                return i;
+            }
+        }
+        return -1;
+    };
+
+    for (int d = 0; d < directions; ++d) {
+        const Point &v = vectors[d];
+        names[d] = directionNames[d];
+        lineCount[d] = 0;
+        int filled = 0;
+        for (int i = 0; i < cells; ++i) {
+            // A line starts at the cell whose next step leaves the board, and runs back from there
+            const Point &p = points[i];
+            if (find(p.a + v.a, p.b + v.b, p.c + v.c) >= 0) {
+                continue;
+            }
+            int length = 0;
+            for (int cell = i; cell >= 0; cell = find(points[cell].a - v.a, points[cell].b - v.b, points[cell].c - v.c)) {
+                lineCells[d][filled++] = static_cast<uint8_t>(cell);
+                ++length;
+            }
+            lineLength[d][lineCount[d]++] = static_cast<uint8_t>(length);
+        }
+        // Lanes marked 0x80 read as zero, so each output block ORs the lanes of four input blocks
+        std::memset(gatherShuffles[d], 0x80, sizeof(gatherShuffles[d]));
+        std::memset(scatterShuffles[d], 0x80, sizeof(scatterShuffles[d]));
+        for (int p = 0; p < cells; ++p) {
+            int cell = lineCells[d][p];
+            gatherShuffles[d][p / 16][cell / 16][p % 16] = static_cast<uint8_t>(cell % 16);
+            scatterShuffles[d][cell / 16][p / 16][cell % 16] = static_cast<uint8_t>(p % 16);
+        }
+        quadLines[d] = lineCount[d] % Board2048::Size == 0
+                       && std::all_of(lineLength[d], lineLength[d] + lineCount[d],
+                                      [](uint8_t length) { return length == Board2048::Size; });
+    }
+}
+
+/**
+ * @brief Returns the 4x4x4 cube: four layers of 4x4 that also slide into each other.
+ * @return The cube shape.
+ */
+const LineBoard2048::Shape &LineBoard2048::Shape::cube()
+{
+    static const Shape shape = [] {
+        Point points[64];
+        for (int i = 0; i < 64; ++i) {
+            points[i] = { i % 4, i / 4 % 4, i / 16 };
+        }
+        const Point vectors[] = { { 0, -1, 0 }, { 0, 1, 0 }, { -1, 0, 0 }, { 1, 0, 0 }, { 0, 0, -1 }, { 0, 0, 1 } };
+        const char *const names[] = { "Up", "Down", "Left", "Right", "Front", "Back" };
+        Shape cube(points, 64, vectors, names, 6);
+
+        // The layers are laid out side by side, one column apart
+        for (int i = 0; i < 64; ++i) {
+            cube.x[i] = 5.0f * static_cast<float>(points[i].c) + static_cast<float>(points[i].a) + 0.5f;
+            cube.y[i] = static_cast<float>(points[i].b) + 0.5f;
+        }
+        cube.layoutWidth = 19.0f;
+        cube.layoutHeight = 4.0f;
+        return cube;
+    }();
+    return shape;
+}
+
+/**
+ * @brief Returns the hexagon of side 3, 19 hexagonal cells with flat tops.
+ * @return The hexagon shape.
+ */
+const LineBoard2048::Shape &LineBoard2048::Shape::hexagon()
+{
+    static const Shape shape = [] {
+        // Cube coordinates (q, r, s) with q + r + s = 0
+        const int radius = 2;
+        Point points[MaxCells];
+        int count = 0;
+        for (int r = -radius; r <= radius; ++r) {
+            for (int q = -radius; q <= radius; ++q) {
+                if (std::abs(q + r) <= radius) {
+                    points[count++] = { q, r, -q - r };
+                }
+            }
+        }
+        const Point vectors[] = { { 0, -1, 1 }, { 0, 1, -1 }, { -1, 0, 1 }, { 1, 0, -1 }, { 1, -1, 0 }, { -1, 1, 0 } };
+        const char *const names[] = { "Up", "Down", "Up-Left", "Down-Right", "Up-Right", "Down-Left" };
+        Shape hexagon(points, count, vectors, names, 6);
+
+        // Hexagons one unit wide with flat tops; each column overlaps the one on its left by a
+        // quarter and sits half a row lower
+        const float rowHeight = std::sqrt(3.0f) / 2.0f;
+        hexagon.hexagonal = true;
+        for (int i = 0; i < count; ++i) {
+            hexagon.x[i] = 0.75f * static_cast<float>(points[i].a + radius) + 0.5f;
+            hexagon.y[i] = rowHeight * (static_cast<float>(points[i].b + radius) + static_cast<float>(points[i].a) / 2.0f + 0.5f);
+        }
+        hexagon.layoutWidth = 0.75f * static_cast<float>(2 * radius) + 1.0f;
+        hexagon.layoutHeight = rowHeight * static_cast<float>(2 * radius + 1);
+        return hexagon;
+    }();
+    return shape;
+}
+
+/**
+ * @brief Constructs an empty board.
+ * @param shape The shape of the board.
+ */
+LineBoard2048::LineBoard2048(const Shape &shape)
+    : boardShape(&shape)
+{
+    clear();
+}
+
+/**
+ * @brief Empties every cell of the board.
+ */
+void LineBoard2048::clear()
+{
+    std::memset(cells, 0, sizeof(cells));
+}
+
+/**
+ * @brief Slides and merges the tiles in the given direction.
+ * @param direction The direction of the move.
+ * @param addedScore If not null, receives the score gained by the merges.
+ * @return True if any tile moved or merged, false otherwise.
+ */
+bool LineBoard2048::move(int direction, int *addedScore)
+{
+    if (boardShape->quadLines[direction] && !hasLargeTile(cells)) {
+        return moveQuads(direction, addedScore);
+    }
+
+    const uint8_t *line = boardShape->lineCells[direction];
+    const uint8_t *lengths = boardShape->lineLength[direction];
+    int lines = boardShape->lineCount[direction];
+    int gained = 0;
+    bool moved = false;
+    for (int i = 0; i < lines; ++i) {
+        int length = lengths[i];
+        uint64_t word = gatherLine(cells, line, length);
+        uint64_t slid = GridBoard2048::slideRow(word, gained);
+        if (slid != word) {
+            moved = true;
+            for (int k = 0; k < length; ++k) {
+                cells[line[k]] = static_cast<uint8_t>(slid >> (8 * k));
+            }
+        }
+        line += length;
+    }
+    if (addedScore) {
+        *addedScore = gained;
+    }
+    return moved;
+}
+
+/**
+ * @brief Moves a direction whose lines all have four cells, four lines at a time.
+ * @param direction The direction of the move.
+ * @param addedScore If not null, receives the score gained by the merges.
+ * @return True if any tile moved or merged, false otherwise.
+ */
+bool LineBoard2048::moveQuads(int direction, int *addedScore)
+{
+    const Shape &shape = *boardShape;
+    int gained = 0;
+    bool moved;
+#if defined(LINEBOARD2048_SSSE3_KERNEL)
+    if (cpuHasSsse3()) {
+        moved = moveQuadsSsse3(cells, shape.gatherShuffles[direction], shape.scatterShuffles[direction],
+                               shape.lineCount[direction], gained);
+    } else {
+        moved = moveQuadsScalar(cells, shape.lineCells[direction], shape.lineCount[direction], gained);
+    }
+#else
+    moved = moveQuadsScalar(cells, shape.lineCells[direction], shape.lineCount[direction], gained);
+#endif
+    if (addedScore) {
+        *addedScore = gained;
+    }
+    return moved;
+}
+
+/**
+ * @brief Checks whether a move in the given direction would change the board.
+ * @param direction The direction to test.
+ * @return True if the move is legal, false otherwise.
+ */
+bool LineBoard2048::canMove(int direction) const
+{
+    if (boardShape->quadLines[direction] && !hasLargeTile(cells)) {
+        const uint8_t *line = boardShape->lineCells[direction];
+        for (int i = 0; i < boardShape->lineCount[direction]; i += Board2048::Size, line += Board2048::CellCount) {
+            if (Board2048(gatherQuad(cells, line)).canMove(Board2048::Left)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const uint8_t *line = boardShape->lineCells[direction];
+    const uint8_t *lengths = boardShape->lineLength[direction];
+    int lines = boardShape->lineCount[direction];
+    int gained = 0;
+    for (int i = 0; i < lines; ++i) {
+        uint64_t word = gatherLine(cells, line, lengths[i]);
+        if (GridBoard2048::slideRow(word, gained) != word) {
+            return true;
+        }
+        line += lengths[i];
+    }
+    return false;
+}
+
+/**
+ * @brief Places a 2 (90%) or a 4 (10%) on an empty cell chosen uniformly at random.
+ * @param rng The generator of the game.
+ * @return True if a tile was placed, false if the board is full.
+ */
+bool LineBoard2048::spawnTile(Rng2048 &rng)
+{
+    uint64_t random = rng.next();
+    uint64_t empty = emptyMask();
+    if (empty == 0) {
+        return false;
+    }
+    uint64_t count = static_cast<uint64_t>(std::popcount(empty));
+    for (int k = static_cast<int>(((random >> 32) * count) >> 32); k > 0; --k) {
+        empty &= empty - 1;
+    }
+    cells[std::countr_zero(empty)] = static_cast<uint32_t>(random) % 10 < 9 ? 1 : 2;
+    return true;
+}
+
+/**
+ * @brief Returns a mask with bit i set for every empty cell i.
+ * @return The empty-cell mask.
+ */
+uint64_t LineBoard2048::emptyMask() const
+{
+    uint64_t mask = 0;
+    for (int i = 0; i < boardShape->cellCount(); ++i) {
+        mask |= static_cast<uint64_t>(cells[i] == 0) << i;
+    }
+    return mask;
+}
+
+/**
+ * @brief Checks if the board holds a 2048 tile.
+ * @return True if the game has been won, false otherwise.
+ */
+bool LineBoard2048::checkWin() const
+{
+    return maxTile() >= 2048;
+}
+
+/**
+ * @brief Checks if no move is possible anymore.
+ * @return True if the game has been lost, false otherwise.
+ */
+bool LineBoard2048::checkLose() const
+{
+    if (emptyMask() != 0) {
+        return false;
+    }
+    for (int d = 0; d < boardShape->directionCount(); ++d) {
+        if (canMove(d)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Returns the largest tile on the board.
+ * @return The largest tile value, or 0 for an empty board.
+ */
+int LineBoard2048::maxTile() const
+{
+    int largest = *std::max_element(cells, cells + boardShape->cellCount());
+    return largest > 0 ? 1 << largest : 0;
+}
@@ -0,0 +1,233 @@
+/**
+ * @file lineboard2048.h
+ * @brief Declares the LineBoard2048 class, a 2048 engine for boards of any shape, such as a cube or a hexagon.
+ *
+ * A move of 2048 slides every line of cells that runs along the direction of the move towards its
+ * far end. LineBoard2048 only knows about lines: a Shape lists, for each direction, every line of
+ * the board as cell indices ordered from the edge the tiles slide towards. The tables are built
+ * once per shape from the cell coordinates and the direction vectors, so the same move code plays
+ * a 4x4x4 cube with six directions and a hexagon with three axes.
+ *
+ * A move gathers each line through its index table into a row word, slides it with
+ * GridBoard2048::slideRow(), which compacts and merges a whole line with a few byte shuffles, and
+ * scatters the line back only if it changed. The board stores one byte exponent per cell.
+ *
+ * When every line of a direction has four cells, as in the cube, and no tile has reached the
+ * nibble cap, the lines are gathered four at a time into a packed Board2048, one line per row, and
+ * slid with its 65536-entry row tables. On CPUs with SSSE3 the gather and the scatter are each
+ * sixteen pshufb instructions driven by masks built from the index tables.
+ */
+#ifndef LINEBOARD2048_H
+#define LINEBOARD2048_H
+
+#include <bit>
+#include <cstdint>
+#include "gridboard2048.h"
+
+class Rng2048;
+
+/**
+ * @class LineBoard2048
+ * @brief The LineBoard2048 class stores a 2048 board whose moves slide tiles along precomputed lines.
+ */
+class LineBoard2048 {
+public:
+    static constexpr int MaxCells = 64;                                ///< Most cells of a shape.
+    static constexpr int MaxDirections = 6;                            ///< Most directions of a shape.
+    static constexpr int MaxLineLength = GridBoard2048::MaxSize;       ///< Longest line, one row word.
+    static constexpr int MaxExponent = GridBoard2048::MaxExponent;     ///< Largest exponent.
+
+    /**
+     * @class Shape
+     * @brief The Shape class describes the cells of a board and the lines its moves slide along.
+     */
+    class Shape {
+    public:
+        /**
+         * @brief Returns the 4x4x4 cube: four layers of 4x4 that also slide into each other.
+         *
+         * Cell (x, y, z) has index 16 * z + 4 * y + x. The directions are Up, Down, Left and Right
+         * within the layers, as in Board2048, then Front towards layer 0 and Back towards layer 3.
+         * @return The cube shape.
+         */
+        static const Shape &cube();
+        /**
+         * @brief Returns the hexagon of side 3, 19 hexagonal cells with flat tops.
+         *
+         * The directions are Up, Down, Up-Left, Down-Right, Up-Right and Down-Left.
+         * @return The hexagon shape.
+         */
+        static const Shape &hexagon();
+
+        /**
+         * @brief Returns the number of cells.
+         * @return The cell count.
+         */
+        int cellCount() const { return cells; }
+        /**
+         * @brief Returns the number of move directions.
+         * @return The direction count.
+         */
+        int directionCount() const { return directions; }
+        /**
+         * @brief Returns the name of a direction.
+         * @param direction The direction, from 0.
+         * @return The name, such as "Up".
+         */
+        const char *directionName(int direction) const { return names[direction]; }
+        /**
+         * @brief Tells whether the cells are hexagons or squares.
+         * @return True for hexagonal cells.
+         */
+        bool isHexagonal() const { return hexagonal; }
+        /**
+         * @brief Returns the horizontal position of a cell's center on screen.
+         * @param cell The cell index.
+         * @return The position, in cell widths from the left of the layout.
+         */
+        float cellX(int cell) const { return x[cell]; }
+        /**
+         * @brief Returns the vertical position of a cell's center on screen.
+         * @param cell The cell index.
+         * @return The position, in cell widths from the top of the layout.
+         */
+        float cellY(int cell) const { return y[cell]; }
+        /**
+         * @brief Returns the width of the layout.
+         * @return The width, in cell widths.
+         */
+        float width() const { return layoutWidth; }
+        /**
+         * @brief Returns the height of the layout.
+         * @return The height, in cell widths.
+         */
+        float height() const { return layoutHeight; }
+
+    private:
+        friend class LineBoard2048;
+
+        /**
+         * @brief Integer coordinates of a cell or a direction vector.
+         */
+        struct Point {
+            int a, b, c;
+        };
+
+        /**
+         * @brief Builds the line tables of a shape.
+         * @param points The coordinates of the cells, at most MaxCells.
+         * @param count The number of cells.
+         * @param vectors The step towards which each direction slides the tiles.
+         * @param directionNames The name of each direction.
+         * @param directionCount The number of directions, at most MaxDirections.
+         */
+        Shape(const Point *points, int count, const Point *vectors, const char *const *directionNames, int directionCount);
+
+        int cells;
+        int directions;
+        bool hexagonal = false;
+        float x[MaxCells];
+        float y[MaxCells];
+        float layoutWidth = 0.0f;
+        float layoutHeight = 0.0f;
+        const char *names[MaxDirections];
+        int lineCount[MaxDirections];
+        uint8_t lineLength[MaxDirections][MaxCells];    ///< Length of each line, in line order.
+        uint8_t lineCells[MaxDirections][MaxCells];     ///< Cells line after line, far end first.
+        bool quadLines[MaxDirections];                  ///< True if every line has four cells.
+        /// pshufb masks that gather the cells into line order: [direction][out block][in block][lane].
+        alignas(16) uint8_t gatherShuffles[MaxDirections][4][4][16];
+        /// pshufb masks that scatter the cells back from line order.
+        alignas(16) uint8_t scatterShuffles[MaxDirections][4][4][16];
+    };
+
+    /**
+     * @brief Constructs an empty board.
+     * @param shape The shape of the board; it must outlive the board.
+     */
+    explicit LineBoard2048(const Shape &shape = Shape::cube());
+
+    /**
+     * @brief Returns the shape of the board.
+     * @return The shape.
+     */
+    const Shape &shape() const { return *boardShape; }
+    /**
+     * @brief Returns the exponent stored in a cell.
+     * @param cell The cell index.
+     * @return The exponent of the tile value, or 0 if the cell is empty.
+     */
+    int exponent(int cell) const { return cells[cell]; }
+    /**
+     * @brief Stores an exponent in a cell.
+     * @param cell The cell index.
+     * @param exponent The exponent of the tile value, or 0 to empty the cell.
+     */
+    void setExponent(int cell, int exponent) { cells[cell] = static_cast<uint8_t>(exponent); }
+    /**
+     * @brief Empties every cell of the board.
+     */
+    void clear();
+
+    /**
+     * @brief Slides and merges the tiles in the given direction.
+     * @param direction The direction of the move, from 0 to shape().directionCount() - 1.
+     * @param addedScore If not null, receives the score gained by the merges.
+     * @return True if any tile moved or merged, false otherwise.
+     */
+    bool move(int direction, int *addedScore = nullptr);
+    /**
+     * @brief Checks whether a move in the given direction would change the board.
+     * @param direction The direction to test.
+     * @return True if the move is legal, false otherwise.
+     */
+    bool canMove(int direction) const;
+    /**
+     * @brief Places a 2 (90%) or a 4 (10%) on an empty cell chosen uniformly at random.
+     *
+     * Uses one draw per spawn, like GridBoard2048::spawnTile().
+     * @param rng The generator of the game.
+     * @return True if a tile was placed, false if the board is full.
+     */
+    bool spawnTile(Rng2048 &rng);
+
+    /**
+     * @brief Returns a mask with bit i set for every empty cell i.
+     * @return The empty-cell mask.
+     */
+    uint64_t emptyMask() const;
+    /**
+     * @brief Counts the empty cells of the board.
+     * @return The number of empty cells.
+     */
+    int emptyCount() const { return std::popcount(emptyMask()); }
+    /**
+     * @brief Checks if the board holds a 2048 tile.
+     * @return True if the game has been won, false otherwise.
+     */
+    bool checkWin() const;
+    /**
+     * @brief Checks if no move is possible anymore.
+     * @return True if the game has been lost, false otherwise.
+     */
+    bool checkLose() const;
+    /**
+     * @brief Returns the largest tile on the board.
+     * @return The largest tile value, or 0 for an empty board.
+     */
+    int maxTile() const;
+
+private:
+    /**
+     * @brief Moves a direction whose lines all have four cells, four lines at a time.
+     * @param direction The direction of the move.
+     * @param addedScore If not null, receives the score gained by the merges.
+     * @return True if any tile moved or merged, false otherwise.
+     */
+    bool moveQuads(int direction, int *addedScore);
+
+    const Shape *boardShape;
+    uint8_t cells[MaxCells];
+};
+
+#endif // LINEBOARD2048_H
@@ -0,0 +1,261 @@
+/**
+ * @file ntuple2048.cpp
+ * @brief Implementation of the NTuple2048 n-tuple network.
+ */
+#include "ntuple2048.h"
+#include "board2048.h"
+#include <QSaveFile>
+#include <atomic>
+#include <cstring>
+
+namespace {
+
+const char Magic[8] = { 'N', 'T', 'U', 'P', '2', '0', '4', '8' };
+const uint32_t FileVersion = 1;
+
+/**
+ * @brief Cells of each tuple, numbered row * 4 + column: two straight and two bent shapes.
+ */
+const uint8_t TupleCells[NTuple2048::TupleCount][NTuple2048::TupleSize] = {
+    { 0, 1, 2, 3, 4, 5 },
+    { 4, 5, 6, 7, 8, 9 },
+    { 0, 1, 2, 4, 5, 6 },
+    { 4, 5, 6, 8, 9, 10 },
+};
+
+static_assert(std::atomic_ref<float>::is_always_lock_free, "weights are shared between training threads");
+
+/**
+ * @brief Reads a weight that other threads may be updating.
+ * @param weight The weight; only read, so it may live in a read-only mapping.
+ * @return The weight.
+ */
+inline float loadWeight(const float &weight)
+{
+    return std::atomic_ref<float>(const_cast<float &>(weight)).load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Adds to a weight that other threads may be updating.
+ *
+ * The read and the write are separate, so a concurrent update of the same weight can be lost, which
+ * self-play training shrugs off.
+ * @param weight The weight.
+ * @param delta The amount to add.
+ */
+inline void addWeight(float &weight, float delta)
+{
+    std::atomic_ref<float> ref(weight);
+    ref.store(ref.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Mirrors a board left to right.
+ * @param bits The packed board.
+ * @return The mirrored board.
+ */
+inline uint64_t mirrorColumns(uint64_t bits)
+{
+    return ((bits & 0x000F000F000F000FULL) << 12) | ((bits & 0x00F000F000F000F0ULL) << 4)
+           | ((bits & 0x0F000F000F000F00ULL) >> 4) | ((bits & 0xF000F000F000F000ULL) >> 12);
+}
+
+/**
+ * @brief Mirrors a board top to bottom.
+ * @param bits The packed board.
+ * @return The mirrored board.
+ */
+inline uint64_t mirrorRows(uint64_t bits)
+{
+    return (bits << 48) | ((bits << 16) & 0x0000FFFF00000000ULL) | ((bits >> 16) & 0x00000000FFFF0000ULL)
+           | (bits >> 48);
+}
+
+} // namespace
+
+/**
+ * @brief Constructs an empty network, which evaluates every position to 0.
+ */
+NTuple2048::NTuple2048()
+{
+}
+
+/**
+ * @brief Allocates zeroed weights in memory, for training from scratch.
+ */
+void NTuple2048::allocate()
+{
+    mapped.close();
+    owned.fill(0.0f, TupleCount * TableSize);
+    weights = owned.data();
+    gamesTrained = 0;
+}
+
+/**
+ * @brief Maps a weights file read-only into memory.
+ * @param path The weights file.
+ * @return True if the file was mapped, false if it is missing or not a weights file.
+ */
+bool NTuple2048::load(const QString &path)
+{
+    mapped.close();
+    owned.clear();
+    weights = nullptr;
+    gamesTrained = 0;
+
+    const qint64 expectedSize = sizeof(FileHeader) + qint64(TupleCount) * TableSize * sizeof(float);
+    mapped.setFileName(path);
+    if (!mapped.open(QIODevice::ReadOnly) || mapped.size() != expectedSize) {
+        mapped.close();
+        return false;
+    }
+    uchar *data = mapped.map(0, expectedSize);
+    if (data == nullptr) {
+        mapped.close();
+        return false;
+    }
+    // Everything but the game count must describe this network
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(FileHeader));
+    FileHeader expected = makeHeader();
+    expected.trainedGames = header.trainedGames;
+    if (std::memcmp(&header, &expected, sizeof(FileHeader)) != 0) {
+        mapped.close();
+        return false;
+    }
+    gamesTrained = header.trainedGames;
+    // The mapping is read-only; evaluate() only ever reads through the pointer
+    weights = reinterpret_cast<float *>(data + sizeof(FileHeader));
+    return true;
+}
+
+/**
+ * @brief Reads a weights file into memory so that training can resume from it.
+ * @param path The weights file.
+ * @return True if the file was read, false if it is missing or not a weights file.
+ */
+bool NTuple2048::loadForTraining(const QString &path)
+{
+    if (!load(path)) {
+        return false;
+    }
+    QVector<float> copy(weights, weights + qsizetype(TupleCount) * TableSize);
+    mapped.close();
+    owned = std::move(copy);
+    weights = owned.data();
+    return true;
+}
+
+/**
+ * @brief Writes the weights to a file, replacing the old file only once the new one is complete.
+ * @param path The weights file.
+ * @return True on success, false otherwise.
+ */
+bool NTuple2048::save(const QString &path) const
+{
+    if (weights == nullptr) {
+        return false;
+    }
+    // An interrupted write must not destroy the checkpoint that training resumes from
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    FileHeader header = makeHeader();
+    header.trainedGames = gamesTrained;
+    const qint64 weightBytes = qint64(TupleCount) * TableSize * sizeof(float);
+    if (file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != sizeof(header)
+        || file.write(reinterpret_cast<const char *>(weights), weightBytes) != weightBytes) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+/**
+ * @brief Estimates the score still to be gained from an afterstate.
+ * @param bits The packed afterstate.
+ * @return The estimated value.
+ */
+float NTuple2048::evaluate(uint64_t bits) const
+{
+    if (weights == nullptr) {
+        return 0.0f;
+    }
+    uint64_t variants[Symmetries];
+    symmetries(bits, variants);
+    float value = 0.0f;
+    for (int s = 0; s < Symmetries; ++s) {
+        for (int t = 0; t < TupleCount; ++t) {
+            value += loadWeight(weights[size_t(t) * TableSize + tupleIndex(variants[s], t)]);
+        }
+    }
+    return value;
+}
+
+/**
+ * @brief Moves the estimate of an afterstate towards a target.
+ * @param bits The packed afterstate.
+ * @param error The scaled difference between the target and the current estimate.
+ */
+void NTuple2048::update(uint64_t bits, float error)
+{
+    Q_ASSERT(!owned.isEmpty());
+    uint64_t variants[Symmetries];
+    symmetries(bits, variants);
+    float delta = error / (Symmetries * TupleCount);
+    for (int s = 0; s < Symmetries; ++s) {
+        for (int t = 0; t < TupleCount; ++t) {
+            addWeight(weights[size_t(t) * TableSize + tupleIndex(variants[s], t)], delta);
+        }
+    }
+}
+
+/**
+ * @brief Fills the header describing this network.
+ * @return The header.
+ */
+NTuple2048::FileHeader NTuple2048::makeHeader()
+{
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = FileVersion;
+    header.tupleCount = TupleCount;
+    header.tupleSize = TupleSize;
+    std::memcpy(header.cells, TupleCells, sizeof(TupleCells));
+    return header;
+}
+
+/**
+ * @brief Computes the eight symmetric variants of a board.
+ * @param bits The packed board.
+ * @param variants Receives the eight boards.
+ */
+void NTuple2048::symmetries(uint64_t bits, uint64_t variants[Symmetries])
+{
+    uint64_t transposed = Board2048::transpose(bits);
+    variants[0] = bits;
+    variants[1] = mirrorColumns(bits);
+    variants[2] = mirrorRows(bits);
+    variants[3] = mirrorRows(variants[1]);
+    variants[4] = transposed;
+    variants[5] = mirrorColumns(transposed);
+    variants[6] = mirrorRows(transposed);
+    variants[7] = mirrorRows(variants[5]);
+}
+
+/**
+ * @brief Reads the table index of a tuple on a board.
+ * @param bits The packed board.
+ * @param tuple The tuple index.
+ * @return The index into that tuple's table.
+ */
+uint32_t NTuple2048::tupleIndex(uint64_t bits, int tuple)
+{
+    uint32_t index = 0;
+    for (int i = 0; i < TupleSize; ++i) {
+        index |= static_cast<uint32_t>((bits >> (4 * TupleCells[tuple][i])) & 0xF) << (4 * i);
+    }
+    return index;
+}
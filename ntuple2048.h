@@ -0,0 +1,136 @@
+/**
+ * @file ntuple2048.h
+ * @brief Declares the NTuple2048 class, a learned n-tuple network evaluator for 2048 positions.
+ *
+ * The network sums one weight per (tuple, symmetry) pair: four six-cell tuples are read from the
+ * eight rotations and reflections of the board, and the six nibbles under a tuple index a table
+ * of 16^6 weights. The weights are trained offline by temporal-difference learning (see
+ * train2048.cpp) and saved in a flat binary file that the game maps into memory with QFile::map()
+ * instead of parsing, so only the pages a game actually touches are ever read from disk.
+ */
+#ifndef NTUPLE2048_H
+#define NTUPLE2048_H
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <cstdint>
+
+/**
+ * @class NTuple2048
+ * @brief The NTuple2048 class estimates the expected future score of a 2048 afterstate.
+ *
+ * An afterstate is the board right after a move, before the random tile spawns. Weights are read
+ * and written through relaxed atomic references, so several training threads may update a shared
+ * network while others evaluate it.
+ */
+class NTuple2048 {
+public:
+    static constexpr int TupleCount = 4;        ///< Number of distinct tuples.
+    static constexpr int TupleSize = 6;         ///< Cells per tuple.
+    static constexpr int Symmetries = 8;        ///< Rotations and reflections of the board.
+    static constexpr int TableSize = 1 << (4 * TupleSize);    ///< Weights per tuple.
+
+    /**
+     * @brief Constructs an empty network, which evaluates every position to 0.
+     */
+    NTuple2048();
+    NTuple2048(const NTuple2048 &) = delete;
+    NTuple2048 &operator=(const NTuple2048 &) = delete;
+
+    /**
+     * @brief Allocates zeroed weights in memory, for training from scratch.
+     */
+    void allocate();
+    /**
+     * @brief Maps a weights file read-only into memory.
+     * @param path The weights file.
+     * @return True if the file was mapped, false if it is missing or not a weights file.
+     */
+    bool load(const QString &path);
+    /**
+     * @brief Reads a weights file into memory so that training can resume from it.
+     * @param path The weights file.
+     * @return True if the file was read, false if it is missing or not a weights file.
+     */
+    bool loadForTraining(const QString &path);
+    /**
+     * @brief Writes the weights to a file, replacing the old file only once the new one is complete.
+     * @param path The weights file.
+     * @return True on success, false otherwise.
+     */
+    bool save(const QString &path) const;
+    /**
+     * @brief Returns the number of self-play games the weights were trained on, as stored in the file.
+     * @return The game count, 0 for new weights.
+     */
+    uint64_t trainedGames() const { return gamesTrained; }
+    /**
+     * @brief Sets the number of self-play games written with the weights by save().
+     * @param games The game count.
+     */
+    void setTrainedGames(uint64_t games) { gamesTrained = games; }
+    /**
+     * @brief Checks if the network holds weights.
+     * @return True after allocate() or a successful load, false otherwise.
+     */
+    bool isLoaded() const { return weights != nullptr; }
+
+    /**
+     * @brief Estimates the score still to be gained from an afterstate.
+     * @param bits The packed afterstate.
+     * @return The estimated value.
+     */
+    float evaluate(uint64_t bits) const;
+    /**
+     * @brief Moves the estimate of an afterstate towards a target.
+     *
+     * Only allowed on weights created by allocate() or loadForTraining().
+     * @param bits The packed afterstate.
+     * @param error The difference between the target and the current estimate, already scaled by
+     * the learning rate; it is spread evenly over the weights of the position.
+     */
+    void update(uint64_t bits, float error);
+
+private:
+    /**
+     * @brief Layout of the header that precedes the weights in a file.
+     */
+    struct FileHeader {
+        char magic[8];                                  ///< "NTUP2048".
+        uint32_t version;                               ///< Format version, currently 1.
+        uint32_t tupleCount;                            ///< Must equal TupleCount.
+        uint32_t tupleSize;                             ///< Must equal TupleSize.
+        uint32_t reserved;                              ///< Always 0.
+        uint8_t cells[TupleCount][TupleSize];           ///< Cell indices of each tuple.
+        uint64_t trainedGames;                          ///< Self-play games behind the weights, 0 if unknown.
+        uint8_t padding[64 - 32 - TupleCount * TupleSize];
+    };
+    static_assert(sizeof(FileHeader) == 64, "the weights must start 64-byte aligned");
+
+    /**
+     * @brief Fills the header describing this network.
+     * @return The header.
+     */
+    static FileHeader makeHeader();
+    /**
+     * @brief Computes the eight symmetric variants of a board.
+     * @param bits The packed board.
+     * @param variants Receives the eight boards.
+     */
+    static void symmetries(uint64_t bits, uint64_t variants[Symmetries]);
+    /**
+     * @brief Reads the table index of a tuple on a board.
+     * @param bits The packed board.
+     * @param tuple The tuple index.
+     * @return The index into that tuple's table.
+     */
+    static uint32_t tupleIndex(uint64_t bits, int tuple);
+
+    QFile mapped;
+    uint64_t gamesTrained = 0;
+    QVector<float> owned;
+    float *weights = nullptr;
+};
+
+#endif // NTUPLE2048_H
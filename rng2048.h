@@ -0,0 +1,110 @@
+/**
+ * @file rng2048.h
+ * @brief Declares the Rng2048 class, a small seedable random generator for 2048 games.
+ */
+#ifndef RNG2048_H
+#define RNG2048_H
+
+#include <cstdint>
+
+/**
+ * @class Rng2048
+ * @brief The Rng2048 class is a xoshiro256** generator owned by a single game or worker.
+ *
+ * Unlike rand() it holds no global state, so every game can be replayed from its seed and parallel
+ * workers never contend on a shared generator. jump() advances the stream by 2^128 draws, which
+ * gives each worker of a batch its own non-overlapping stream from one seed, as stream() returns it.
+ */
+class Rng2048 {
+public:
+    /**
+     * @brief Constructs a generator from a seed.
+     * @param seed The seed.
+     */
+    explicit Rng2048(uint64_t seed = 0) { setSeed(seed); }
+
+    /**
+     * @brief Returns one of the non-overlapping streams of a seed, one per worker of a batch.
+     * @param seed The seed shared by the batch.
+     * @param index The index of the worker.
+     * @return The generator of the seed, advanced by index jumps of 2^128 draws.
+     */
+    static Rng2048 stream(uint64_t seed, int index)
+    {
+        Rng2048 rng(seed);
+        for (int i = 0; i < index; ++i) {
+            rng.jump();
+        }
+        return rng;
+    }
+
+    /**
+     * @brief Restarts the generator from a seed.
+     * @param seed The seed.
+     */
+    void setSeed(uint64_t seed)
+    {
+        // Expand the seed with splitmix64, which never yields an all-zero state
+        for (uint64_t &word : state) {
+            seed += 0x9E3779B97F4A7C15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    /**
+     * @brief Draws the next 64 random bits.
+     * @return The random bits.
+     */
+    uint64_t next()
+    {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    /**
+     * @brief Draws a number in [0, bound) with a single draw.
+     * @param bound The exclusive upper bound, at most 2^32.
+     * @return The random number.
+     */
+    uint32_t bounded(uint32_t bound) { return static_cast<uint32_t>(((next() >> 32) * bound) >> 32); }
+
+    /**
+     * @brief Advances the generator by 2^128 draws.
+     */
+    void jump()
+    {
+        static const uint64_t polynomial[] = { 0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+                                               0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL };
+        uint64_t jumped[4] = { 0, 0, 0, 0 };
+        for (uint64_t word : polynomial) {
+            for (int bit = 0; bit < 64; ++bit) {
+                if (word & (1ULL << bit)) {
+                    for (int i = 0; i < 4; ++i) {
+                        jumped[i] ^= state[i];
+                    }
+                }
+                next();
+            }
+        }
+        for (int i = 0; i < 4; ++i) {
+            state[i] = jumped[i];
+        }
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t state[4];
+};
+
+#endif // RNG2048_H
@@ -6,6 +6,8 @@
 #include <QVBoxLayout>
 #include <QPushButton>
 #include <QLabel>
+#include <QComboBox>
+#include <QSettings>
 #include <QDebug>
 
 int theme;
@@ -65,6 +67,52 @@ SettingsWindow::SettingsWindow(QWidget *parent)
         changeButtonButtonClicked(4);
     });
 
+    // AI search depth section
+    QLabel *searchDepthLabel = new QLabel("AI Search Depth");
+    QComboBox *searchDepthCombo = new QComboBox();
+    for (int depth = 1; depth <= 6; ++depth) {
+        searchDepthCombo->addItem(QString::number(depth), depth);
+    }
+    QSettings settings("backIntimeBytes", "game2048");
+    searchDepthCombo->setCurrentIndex(searchDepthCombo->findData(settings.value("SearchDepth", 3).toInt()));
+    connect(searchDepthCombo, &QComboBox::activated, this, [this, searchDepthCombo](int index) {
+        emit changeSearchDepthClicked(searchDepthCombo->itemData(index).toInt());
+    });
+
+    // Board size section
+    QLabel *boardSizeLabel = new QLabel("Board Size");
+    QComboBox *boardSizeCombo = new QComboBox();
+    for (int size = 3; size <= 8; ++size) {
+        boardSizeCombo->addItem(QString("%1x%1").arg(size), size);
+    }
+    boardSizeCombo->setCurrentIndex(boardSizeCombo->findData(settings.value("BoardSize", 4).toInt()));
+    connect(boardSizeCombo, &QComboBox::activated, this, [this, boardSizeCombo](int index) {
+        emit changeBoardSizeClicked(boardSizeCombo->itemData(index).toInt());
+    });
+
+    // Tile spawn section
+    QLabel *spawnLabel = new QLabel("Tile Spawns");
+    QComboBox *spawnCombo = new QComboBox();
+    spawnCombo->addItem("Random", false);
+    spawnCombo->addItem("Evil (Hard Mode)", true);
+    spawnCombo->setCurrentIndex(spawnCombo->findData(settings.value("HardMode", false).toBool()));
+    connect(spawnCombo, &QComboBox::activated, this, [this, spawnCombo](int index) {
+        emit changeHardModeClicked(spawnCombo->itemData(index).toBool());
+    });
+
+    // Variant section, each button closes the settings and opens its own window
+    QLabel *variantLabel = new QLabel("Variants");
+    QPushButton *cubeButton = new QPushButton("Play 4x4x4 Cube");
+    connect(cubeButton, &QPushButton::clicked, this, [this]() {
+        accept();
+        emit playVariantClicked(0);
+    });
+    QPushButton *hexagonButton = new QPushButton("Play Hexagon");
+    connect(hexagonButton, &QPushButton::clicked, this, [this]() {
+        accept();
+        emit playVariantClicked(1);
+    });
+
     // Add widgets to layout
     layout->addWidget(themeLabel);
     layout->addWidget(changeThemeButton);
@@ -78,6 +126,15 @@ SettingsWindow::SettingsWindow(QWidget *parent)
     layout->addWidget(buttonColorButton2);
     layout->addWidget(buttonColorButton3);
     layout->addWidget(buttonColorButton4);
+    layout->addWidget(searchDepthLabel);
+    layout->addWidget(searchDepthCombo);
+    layout->addWidget(boardSizeLabel);
+    layout->addWidget(boardSizeCombo);
+    layout->addWidget(spawnLabel);
+    layout->addWidget(spawnCombo);
+    layout->addWidget(variantLabel);
+    layout->addWidget(cubeButton);
+    layout->addWidget(hexagonButton);
     layout->addWidget(new QLabel("")); // Blank line
 }
 
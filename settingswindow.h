@@ -18,6 +18,10 @@ class SettingsWindow : public QDialog
 signals:
     void changeThemeClicked(int theme);
     void changeButtonClicked(int button);
+    void changeSearchDepthClicked(int depth);
+    void changeBoardSizeClicked(int size);
+    void changeHardModeClicked(bool enabled);
+    void playVariantClicked(int variant);
 
 
 public:
@@ -0,0 +1,195 @@
+/**
+ * @file sim2048.cpp
+ * @brief Command-line batch self-play simulator for the 2048 game.
+ *
+ * Plays many games without a GUI using the same Board2048 rules as the game window, spread over all
+ * cores with one Rng2048 stream per worker. Reports throughput, the distribution of the largest tile
+ * and score percentiles.
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include <QtConcurrent>
+#include <algorithm>
+#include <bit>
+#include "board2048.h"
+#include "greedy2048.h"
+#include "rng2048.h"
+
+/**
+ * @brief The share of the games played by one worker, and what it measured.
+ */
+struct SimWorker {
+    int index;
+    qint64 games;
+    qint64 moves = 0;
+    qint64 maxTileCounts[Board2048::MaxExponent + 1] = {};
+    QVector<int> scores;
+};
+
+/**
+ * @brief Picks the move for the current position.
+ * @param board The position.
+ * @param greedy True to pick the move with the best heuristic value, false to pick a random legal move.
+ * @param rng The random generator.
+ * @param direction Receives the chosen direction.
+ * @return True if a legal move exists, false if the game is lost.
+ */
+static bool chooseMove(const Board2048 &board, bool greedy, Rng2048 &rng, Board2048::Direction &direction)
+{
+    if (greedy) {
+        Greedy2048::Move move;
+        if (!Greedy2048::choose(board.bits(), move)) {
+            return false;
+        }
+        direction = move.direction;
+        return true;
+    }
+
+    Board2048::Direction legal[4];
+    int legalCount = 0;
+    for (int d = 0; d < 4; ++d) {
+        int addedScore = 0;
+        if (Board2048::slide(board.bits(), static_cast<Board2048::Direction>(d), addedScore) != board.bits()) {
+            legal[legalCount++] = static_cast<Board2048::Direction>(d);
+        }
+    }
+    if (legalCount == 0) {
+        return false;
+    }
+    direction = legal[rng.bounded(legalCount)];
+    return true;
+}
+
+/**
+ * @brief Plays all the games of one worker.
+ * @param worker The worker.
+ * @param seed The base seed of the run.
+ * @param greedy True to use the greedy policy, false for random moves.
+ */
+static void runWorker(SimWorker &worker, quint64 seed, bool greedy)
+{
+    Rng2048 rng = Rng2048::stream(seed, worker.index);
+    worker.scores.reserve(static_cast<int>(worker.games));
+
+    for (qint64 game = 0; game < worker.games; ++game) {
+        Board2048 board;
+        board.spawnTile(rng);
+        board.spawnTile(rng);
+
+        int score = 0;
+        Board2048::Direction direction;
+        while (chooseMove(board, greedy, rng, direction)) {
+            int addedScore = 0;
+            board.move(direction, &addedScore);
+            score += addedScore;
+            board.spawnTile(rng);
+            ++worker.moves;
+        }
+
+        int maxTile = board.maxTile();
+        ++worker.maxTileCounts[maxTile == 0 ? 0 : std::countr_zero(static_cast<unsigned>(maxTile))];
+        worker.scores.append(score);
+    }
+}
+
+/**
+ * @brief Returns the score below which the given fraction of the games fall.
+ * @param sorted The sorted scores.
+ * @param fraction The fraction, between 0 and 1.
+ * @return The percentile.
+ */
+static int percentile(const QVector<int> &sorted, double fraction)
+{
+    qint64 index = static_cast<qint64>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[static_cast<int>(index)];
+}
+
+/**
+ * @brief Main function.
+ * @param argc Number of command line arguments.
+ * @param argv Array of command line arguments.
+ * @return Exit status.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("sim2048");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Plays 2048 games without a GUI and reports engine speed and game balance.");
+    parser.addHelpOption();
+    parser.addOption({ "games", "Number of games to play.", "count", "1000000" });
+    parser.addOption({ "threads", "Number of worker threads.", "threads", QString::number(QThread::idealThreadCount()) });
+    parser.addOption({ "seed", "Base seed of the random streams.", "seed", "2048" });
+    parser.addOption({ "policy", "Move policy: random or greedy.", "policy", "random" });
+    parser.process(app);
+
+    qint64 games = parser.value("games").toLongLong();
+    int threads = qMax(1, parser.value("threads").toInt());
+    quint64 seed = parser.value("seed").toULongLong();
+    bool greedy = parser.value("policy") == "greedy";
+    if (games <= 0) {
+        parser.showHelp(1);
+    }
+
+    QVector<SimWorker> workers;
+    for (int i = 0; i < threads; ++i) {
+        SimWorker worker;
+        worker.index = i;
+        worker.games = games / threads + (i < games % threads ? 1 : 0);
+        workers.append(worker);
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    QElapsedTimer timer;
+    timer.start();
+    QtConcurrent::blockingMap(&pool, workers, [seed, greedy](SimWorker &worker) {
+        runWorker(worker, seed, greedy);
+    });
+    double seconds = timer.nsecsElapsed() / 1e9;
+
+    // Merge the workers in index order
+    qint64 moves = 0;
+    qint64 maxTileCounts[Board2048::MaxExponent + 1] = {};
+    QVector<int> scores;
+    scores.reserve(static_cast<int>(games));
+    for (const SimWorker &worker : workers) {
+        moves += worker.moves;
+        for (int e = 0; e <= Board2048::MaxExponent; ++e) {
+            maxTileCounts[e] += worker.maxTileCounts[e];
+        }
+        scores += worker.scores;
+    }
+    std::sort(scores.begin(), scores.end());
+
+    QTextStream out(stdout);
+    out << games << " games, " << threads << " threads, " << (greedy ? "greedy" : "random") << " policy, seed " << seed << "\n";
+    out << QString("%1 s, %2 games/s, %3 moves/s, %4 moves/game\n")
+               .arg(seconds, 0, 'f', 2)
+               .arg(games / seconds, 0, 'f', 0)
+               .arg(moves / seconds, 0, 'f', 0)
+               .arg(static_cast<double>(moves) / games, 0, 'f', 1);
+
+    out << "\nmax tile      games        %\n";
+    for (int e = 1; e <= Board2048::MaxExponent; ++e) {
+        if (maxTileCounts[e] > 0) {
+            out << QString("%1 %2 %3\n")
+                       .arg(1 << e, 8)
+                       .arg(maxTileCounts[e], 10)
+                       .arg(100.0 * maxTileCounts[e] / games, 8, 'f', 3);
+        }
+    }
+
+    out << "\nscore percentiles\n";
+    const double fractions[] = { 0.0, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 1.0 };
+    for (double fraction : fractions) {
+        out << QString("p%1 %2\n").arg(fraction * 100.0, -4, 'f', 0).arg(percentile(scores, fraction), 8);
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file solve2048.cpp
+ * @brief Command-line exact solver for 2048 on boards of 2x2 to 3x3 cells.
+ *
+ * Solves every reachable position of the chosen board with ExactSolver2048 on all cores, writes
+ * the table that the game maps for perfect hints, and can check it by playing games with the
+ * optimal moves: their mean score should come close to the expected score of a new game.
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThread>
+#include "exactsolver2048.h"
+#include "rng2048.h"
+
+/**
+ * @brief Places a 2 (90%) or a 4 (10%) on a random empty cell of a packed position.
+ * @param solver The solver, which knows the board shape.
+ * @param state The packed position.
+ * @param rng The random generator.
+ * @return The position with the new tile.
+ */
+static uint64_t spawnTile(const ExactSolver2048 &solver, uint64_t state, Rng2048 &rng)
+{
+    int empty[ExactSolver2048::MaxSide * ExactSolver2048::MaxSide];
+    int emptyCount = 0;
+    for (int cell = 0; cell < solver.rows() * solver.columns(); ++cell) {
+        if (((state >> (4 * cell)) & 0xF) == 0) {
+            empty[emptyCount++] = cell;
+        }
+    }
+    uint64_t exponent = rng.bounded(10) == 0 ? 2 : 1;
+    return state | (exponent << (4 * empty[rng.bounded(emptyCount)]));
+}
+
+/**
+ * @brief Main function.
+ * @param argc Number of command line arguments.
+ * @param argv Array of command line arguments.
+ * @return Exit status.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("solve2048");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Solves 2048 exactly on a small board and writes the table of optimal moves.");
+    parser.addHelpOption();
+    parser.addOption({ "rows", "Number of rows, 2 or 3.", "rows", "3" });
+    parser.addOption({ "columns", "Number of columns, 2 or 3.", "columns", "3" });
+    parser.addOption({ "threads", "Number of worker threads.", "threads", QString::number(QThread::idealThreadCount()) });
+    parser.addOption({ "output", "Table file to write; defaults to solve2048-<rows>x<columns>.table.", "file" });
+    parser.addOption({ "games", "Number of games to play with the optimal moves afterwards.", "count", "0" });
+    parser.addOption({ "seed", "Seed of the games.", "seed", "2048" });
+    parser.process(app);
+
+    int rows = parser.value("rows").toInt();
+    int columns = parser.value("columns").toInt();
+    int threads = qMax(1, parser.value("threads").toInt());
+    qint64 games = parser.value("games").toLongLong();
+    if (rows < ExactSolver2048::MinSide || rows > ExactSolver2048::MaxSide || columns < ExactSolver2048::MinSide
+        || columns > ExactSolver2048::MaxSide || games < 0) {
+        parser.showHelp(1);
+    }
+    QString output = parser.value("output");
+    if (output.isEmpty()) {
+        output = QString("solve2048-%1x%2.table").arg(rows).arg(columns);
+    }
+
+    QTextStream out(stdout);
+    ExactSolver2048 solver(rows, columns);
+    QElapsedTimer timer;
+    timer.start();
+    solver.solve(threads);
+    double seconds = timer.nsecsElapsed() / 1e9;
+    out << rows << "x" << columns << ", " << threads << " threads: " << solver.stateCount() << " positions in "
+        << QString::number(seconds, 'f', 2) << " s\n";
+    out << "expected score of a new game: " << QString::number(solver.startValue(), 'f', 2) << "\n";
+    out.flush();
+
+    if (!solver.save(output)) {
+        out << "cannot write " << output << "\n";
+        return 1;
+    }
+    out << "table written to " << output << "\n";
+
+    if (games > 0) {
+        Rng2048 rng(parser.value("seed").toULongLong());
+        qint64 total = 0;
+        for (qint64 game = 0; game < games; ++game) {
+            uint64_t state = spawnTile(solver, spawnTile(solver, 0, rng), rng);
+            Board2048::Direction direction;
+            while (solver.bestMove(state, direction)) {
+                int addedScore = 0;
+                state = spawnTile(solver, solver.slide(state, direction, addedScore), rng);
+                total += addedScore;
+            }
+        }
+        out << games << " games with optimal moves: mean score "
+            << QString::number(static_cast<double>(total) / games, 'f', 2) << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,20 @@
+# Command-line exact solver for 2048 on boards of 2x2 to 3x3 cells.
+
+QT = core concurrent
+
+CONFIG += c++20 console
+CONFIG -= app_bundle
+
+TARGET = solve2048
+
+HEADERS += \
+    board2048.h \
+    gridboard2048.h \
+    exactsolver2048.h \
+    rng2048.h
+
+SOURCES += \
+    solve2048.cpp \
+    board2048.cpp \
+    gridboard2048.cpp \
+    exactsolver2048.cpp
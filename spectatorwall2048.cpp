@@ -0,0 +1,173 @@
+/**
+ * @file spectatorwall2048.cpp
+ * @brief Implementation of the SpectatorWall2048 window.
+ */
+#include "spectatorwall2048.h"
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <cmath>
+
+namespace {
+
+/**
+ * @brief Fill of each tile value in the atlas, from the empty cell to 32768.
+ */
+const QRgb TileColors[Board2048::MaxExponent + 1] = {
+    0xCDC1B4, 0xEEE4DA, 0xEDE0C8, 0xF2B179, 0xF59563, 0xF67C5F, 0xF65E3B, 0xEDCF72,
+    0xEDCC61, 0xEDC850, 0xEDC53F, 0xEDC22E, 0x3C3A32, 0x2F2D27, 0x23221D, 0x171613,
+};
+
+const int MinTextCell = 18;    ///< Smallest cell, in pixels, that still shows the tile values.
+
+} // namespace
+
+/**
+ * @brief Constructs the wall; the games run while it is shown.
+ * @param evaluator A trained network for the AI, or nullptr for the static heuristic.
+ * @param depth The search depth of the AI; 1 plays the greedy one-move policy.
+ * @param parent The parent widget.
+ */
+SpectatorWall2048::SpectatorWall2048(const NTuple2048 *evaluator, int depth, QWidget *parent)
+    : QWidget(parent), arena(Arena2048::DefaultGameCount, depth)
+{
+    setWindowFlag(Qt::Window);
+    setWindowTitle("2048 Spectator Wall");
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    arena.setEvaluator(evaluator);
+    columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(arena.gameCount()))));
+    fragments.reserve(static_cast<size_t>(arena.gameCount()) * Board2048::CellCount);
+
+    frameTimer.setTimerType(Qt::PreciseTimer);
+    frameTimer.setInterval(FrameInterval);
+    connect(&frameTimer, &QTimer::timeout, this, [this]() {
+        updateStatus();
+        update();
+    });
+}
+
+/**
+ * @brief Returns the preferred size, thumbnails of about 96 pixels.
+ * @return The size hint.
+ */
+QSize SpectatorWall2048::sizeHint() const
+{
+    int rows = (arena.gameCount() + columns - 1) / columns;
+    return QSize(columns * (96 + Spacing) + Spacing, StatusHeight + rows * (96 + Spacing) + Spacing);
+}
+
+/**
+ * @brief Paints every game from its latest snapshot in one batched call.
+ * @param event The paint event.
+ */
+void SpectatorWall2048::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(0xBB, 0xAD, 0xA0));
+
+    // Fragments are placed by their center
+    fragments.clear();
+    qreal half = cellSize / 2.0;
+    for (int game = 0; game < arena.gameCount(); ++game) {
+        uint64_t bits = arena.board(game);
+        qreal left = Spacing + (game % columns) * (boardSide + Spacing) + half;
+        qreal top = StatusHeight + Spacing + (game / columns) * (boardSide + Spacing) + half;
+        for (int cell = 0; cell < Board2048::CellCount; ++cell, bits >>= 4) {
+            QPointF center(left + (cell % Board2048::Size) * cellSize, top + (cell / Board2048::Size) * cellSize);
+            QRectF source(static_cast<qreal>(bits & 0xF) * cellSize, 0, cellSize, cellSize);
+            fragments.push_back(QPainter::PixmapFragment::create(center, source));
+        }
+    }
+    painter.drawPixmapFragments(fragments.data(), static_cast<int>(fragments.size()), atlas);
+
+    painter.setPen(Qt::white);
+    painter.drawText(QRect(Spacing, 0, width() - 2 * Spacing, StatusHeight), Qt::AlignLeft | Qt::AlignVCenter, statusText);
+}
+
+/**
+ * @brief Lays the thumbnails out again for the new size.
+ * @param event The resize event.
+ */
+void SpectatorWall2048::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    updateLayout();
+}
+
+/**
+ * @brief Starts the games and the repaints when the wall is shown.
+ * @param event The show event.
+ */
+void SpectatorWall2048::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    if (!arena.isRunning()) {
+        arena.start();
+        statusMoves = 0;
+        statusClock.start();
+    }
+    frameTimer.start();
+}
+
+/**
+ * @brief Stops the games and the repaints while the wall is hidden.
+ * @param event The hide event.
+ */
+void SpectatorWall2048::hideEvent(QHideEvent *event)
+{
+    frameTimer.stop();
+    arena.stop();
+    QWidget::hideEvent(event);
+}
+
+/**
+ * @brief Lays the thumbnails out for the widget size and renders the atlas for their cell size.
+ */
+void SpectatorWall2048::updateLayout()
+{
+    int rows = (arena.gameCount() + columns - 1) / columns;
+    int side = qMin((width() - Spacing) / columns, (height() - StatusHeight - Spacing) / rows) - Spacing;
+    cellSize = qMax(1, side / Board2048::Size);
+    boardSide = cellSize * Board2048::Size;
+
+    atlas = QPixmap(cellSize * (Board2048::MaxExponent + 1), cellSize);
+    atlas.fill(QColor(0xBB, 0xAD, 0xA0));
+    QPainter painter(&atlas);
+    painter.setRenderHint(QPainter::Antialiasing);
+    QFont font = this->font();
+    font.setBold(true);
+    qreal inset = qMax(0.5, cellSize / 16.0);
+    for (int e = 0; e <= Board2048::MaxExponent; ++e) {
+        QRectF tile(e * cellSize + inset, inset, cellSize - 2 * inset, cellSize - 2 * inset);
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(QColor(TileColors[e]));
+        painter.drawRoundedRect(tile, cellSize / 10.0, cellSize / 10.0);
+        if (e > 0 && cellSize >= MinTextCell) {
+            QString text = QString::number(1 << e);
+            font.setPixelSize(qMax(1, static_cast<int>(cellSize * (text.size() <= 2 ? 0.45 : 1.1 / text.size()))));
+            painter.setFont(font);
+            painter.setPen(e <= 2 ? QColor(0x77, 0x6E, 0x65) : QColor(Qt::white));
+            painter.drawText(tile, Qt::AlignCenter, text);
+        }
+    }
+}
+
+/**
+ * @brief Refreshes the status line once per second from the arena counters.
+ */
+void SpectatorWall2048::updateStatus()
+{
+    qint64 elapsed = statusClock.elapsed();
+    if (elapsed < 1000) {
+        return;
+    }
+    uint64_t moves = arena.moveCount();
+    double rate = 1000.0 * static_cast<double>(moves - statusMoves) / static_cast<double>(elapsed);
+    statusMoves = moves;
+    statusClock.restart();
+    statusText = QString("%1 games, %2 moves/s, %3 games finished, best tile %4")
+                     .arg(arena.gameCount())
+                     .arg(rate, 0, 'f', 0)
+                     .arg(arena.finishedCount())
+                     .arg(arena.bestTile());
+}
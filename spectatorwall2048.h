@@ -0,0 +1,90 @@
+/**
+ * @file spectatorwall2048.h
+ * @brief Declares the SpectatorWall2048 class, a window showing many AI games of 2048 at once.
+ */
+#ifndef SPECTATORWALL2048_H
+#define SPECTATORWALL2048_H
+
+#include <QElapsedTimer>
+#include <QPainter>
+#include <QPixmap>
+#include <QTimer>
+#include <QWidget>
+#include <vector>
+#include "arena2048.h"
+
+/**
+ * @class SpectatorWall2048
+ * @brief The SpectatorWall2048 class paints the games of an Arena2048 as a wall of thumbnails.
+ *
+ * Simulation and rendering only meet in the arena's atomic snapshots: the workers play as fast as
+ * they can while a 16 ms timer repaints the wall from whatever boards were last published, so a
+ * frame never waits for a move and a move never waits for a frame.
+ *
+ * Every tile value is rendered once into a shared atlas for the current thumbnail size. A frame
+ * then gathers one QPainter::PixmapFragment per cell of every game into a buffer that is kept from
+ * frame to frame, and hands them all to a single drawPixmapFragments() call.
+ */
+class SpectatorWall2048 : public QWidget {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs the wall; the games run while it is shown.
+     * @param evaluator A trained network for the AI, or nullptr for the static heuristic.
+     * @param depth The search depth of the AI; 1 plays the greedy one-move policy.
+     * @param parent The parent widget.
+     */
+    explicit SpectatorWall2048(const NTuple2048 *evaluator = nullptr, int depth = 1, QWidget *parent = nullptr);
+
+    QSize sizeHint() const override;
+
+protected:
+    /**
+     * @brief Paints every game from its latest snapshot in one batched call.
+     * @param event The paint event.
+     */
+    void paintEvent(QPaintEvent *event) override;
+    /**
+     * @brief Lays the thumbnails out again for the new size.
+     * @param event The resize event.
+     */
+    void resizeEvent(QResizeEvent *event) override;
+    /**
+     * @brief Starts the games and the repaints when the wall is shown.
+     * @param event The show event.
+     */
+    void showEvent(QShowEvent *event) override;
+    /**
+     * @brief Stops the games and the repaints while the wall is hidden.
+     * @param event The hide event.
+     */
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    static constexpr int FrameInterval = 16;    ///< Repaint period, in milliseconds.
+    static constexpr int Spacing = 8;           ///< Gap between two thumbnails, in pixels.
+    static constexpr int StatusHeight = 24;     ///< Height of the status line, in pixels.
+
+    /**
+     * @brief Lays the thumbnails out for the widget size and renders the atlas for their cell size.
+     */
+    void updateLayout();
+    /**
+     * @brief Refreshes the status line once per second from the arena counters.
+     */
+    void updateStatus();
+
+    Arena2048 arena;
+    int columns = 1;
+    int cellSize = 0;
+    int boardSide = 0;
+    QPixmap atlas;
+    std::vector<QPainter::PixmapFragment> fragments;
+    QTimer frameTimer;
+    QElapsedTimer statusClock;
+    uint64_t statusMoves = 0;
+    QString statusText;
+};
+
+#endif // SPECTATORWALL2048_H
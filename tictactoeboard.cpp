@@ -0,0 +1,103 @@
+/**
+ * @file tictactoeboard.cpp
+ * @brief Implementation of the TicTacToeBoard class and its win-line tables.
+ */
+#include "tictactoeboard.h"
+#include <algorithm>
+#include <array>
+
+namespace {
+
+/**
+ * @brief The winning lines of one grid size and the mask of its cells.
+ */
+struct LineTable {
+    uint64_t cells = 0;
+    uint64_t lines[TicTacToeBoard::MaxLines] = {};
+};
+
+/**
+ * @brief Builds the rows, columns and diagonals of every grid size.
+ * @return The tables, indexed by size.
+ */
+constexpr std::array<LineTable, TicTacToeBoard::MaxSize + 1> buildLineTables()
+{
+    std::array<LineTable, TicTacToeBoard::MaxSize + 1> tables{};
+    for (int size = TicTacToeBoard::MinSize; size <= TicTacToeBoard::MaxSize; ++size) {
+        LineTable &table = tables[size];
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                table.lines[i] |= uint64_t(1) << (i * TicTacToeBoard::MaxSize + j);
+                table.lines[size + i] |= uint64_t(1) << (j * TicTacToeBoard::MaxSize + i);
+            }
+            table.lines[2 * size] |= uint64_t(1) << (i * TicTacToeBoard::MaxSize + i);
+            table.lines[2 * size + 1] |= uint64_t(1) << (i * TicTacToeBoard::MaxSize + size - 1 - i);
+            table.cells |= table.lines[i];
+        }
+    }
+    return tables;
+}
+
+constexpr std::array<LineTable, TicTacToeBoard::MaxSize + 1> LineTables = buildLineTables();
+
+static_assert(LineTables[3].lines[0] == 0x7 && LineTables[3].lines[3] == 0x10101 && LineTables[3].lines[7] == 0x10204,
+              "the 3x3 rows, columns and diagonals must be laid out with a stride of MaxSize");
+
+} // namespace
+
+/**
+ * @brief Constructs an empty grid.
+ * @param size The number of rows and columns, clamped to [MinSize, MaxSize].
+ */
+TicTacToeBoard::TicTacToeBoard(int size)
+    : gridSize(std::clamp(size, MinSize, MaxSize)),
+      gridMask(LineTables[gridSize].cells),
+      lines(LineTables[gridSize].lines)
+{
+}
+
+/**
+ * @brief Returns the mark in a cell.
+ * @param row The row of the cell.
+ * @param col The column of the cell.
+ * @return The player whose mark is in the cell, or Player::NONE.
+ */
+Player TicTacToeBoard::at(int row, int col) const
+{
+    uint64_t bit = uint64_t(1) << cellIndex(row, col);
+    if (xMarks & bit) {
+        return Player::HUMAN;
+    }
+    return (oMarks & bit) ? Player::Machine : Player::NONE;
+}
+
+/**
+ * @brief Puts a player's mark in a cell, or empties it.
+ * @param row The row of the cell.
+ * @param col The column of the cell.
+ * @param player The player, or Player::NONE to empty the cell.
+ */
+void TicTacToeBoard::place(int row, int col, Player player)
+{
+    int cell = cellIndex(row, col);
+    undo(cell);
+    if (player != Player::NONE) {
+        play(cell, player);
+    }
+}
+
+/**
+ * @brief Checks whether a player has filled a row, a column or a diagonal.
+ * @param player The player to check.
+ * @return True if the player has won, false otherwise.
+ */
+bool TicTacToeBoard::checkWin(Player player) const
+{
+    uint64_t own = marks(player);
+    for (int i = 0; i < lineCount(); ++i) {
+        if ((own & lines[i]) == lines[i]) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,148 @@
+/**
+ * @file tictactoeboard.h
+ * @brief Declares the TicTacToeBoard class, a bitboard for Tic Tac Toe grids from 3x3 to 8x8.
+ *
+ * Each player's marks are one 64-bit word, cell (row, col) being bit row * MaxSize + col, so a grid
+ * of any supported size fits a single word per player. The rows, columns and both diagonals of
+ * every size are precomputed as masks, and a player has won as soon as one of them is covered:
+ * win detection is an AND and a compare per line, and copying or changing a board allocates nothing.
+ */
+#ifndef TICTACTOEBOARD_H
+#define TICTACTOEBOARD_H
+
+#include <bit>
+#include <cstdint>
+
+/**
+ * @brief The marks a cell can hold, as they are shown on the grid.
+ */
+enum Player  {
+    Machine = 'O',
+    HUMAN = 'X',
+    NONE  = ' '
+};
+
+/**
+ * @class TicTacToeBoard
+ * @brief The TicTacToeBoard class stores the marks of a square Tic Tac Toe grid as two bitboards.
+ *
+ * A player wins by filling a whole row, column or diagonal of the grid. Bits past the grid size
+ * are always zero.
+ */
+class TicTacToeBoard {
+public:
+    static constexpr int MinSize = 3;                      ///< Smallest supported number of rows and columns.
+    static constexpr int MaxSize = 8;                      ///< Largest supported number of rows and columns.
+    static constexpr int MaxLines = 2 * MaxSize + 2;       ///< Most winning lines of a grid.
+
+    /**
+     * @brief Constructs an empty grid.
+     * @param size The number of rows and columns, clamped to [MinSize, MaxSize].
+     */
+    explicit TicTacToeBoard(int size = MinSize);
+
+    /**
+     * @brief Returns the number of rows and columns.
+     * @return The grid size.
+     */
+    int size() const { return gridSize; }
+    /**
+     * @brief Returns the bit index of a cell.
+     * @param row The row of the cell.
+     * @param col The column of the cell.
+     * @return The cell index, row * MaxSize + col.
+     */
+    static constexpr int cellIndex(int row, int col) { return row * MaxSize + col; }
+
+    /**
+     * @brief Returns the mark in a cell.
+     * @param row The row of the cell.
+     * @param col The column of the cell.
+     * @return The player whose mark is in the cell, or Player::NONE.
+     */
+    Player at(int row, int col) const;
+    /**
+     * @brief Checks whether a cell holds no mark.
+     * @param row The row of the cell.
+     * @param col The column of the cell.
+     * @return True if the cell is empty, false otherwise.
+     */
+    bool isEmpty(int row, int col) const { return (emptyMask() >> cellIndex(row, col)) & 1; }
+    /**
+     * @brief Puts a player's mark in a cell, or empties it.
+     * @param row The row of the cell.
+     * @param col The column of the cell.
+     * @param player The player, or Player::NONE to empty the cell.
+     */
+    void place(int row, int col, Player player);
+    /**
+     * @brief Puts a player's mark in an empty cell.
+     * @param cell The cell index.
+     * @param player Player::HUMAN or Player::Machine.
+     */
+    void play(int cell, Player player) { (player == Player::Machine ? oMarks : xMarks) |= uint64_t(1) << cell; }
+    /**
+     * @brief Removes the mark in a cell, undoing play().
+     * @param cell The cell index.
+     */
+    void undo(int cell) { xMarks &= ~(uint64_t(1) << cell); oMarks &= ~(uint64_t(1) << cell); }
+    /**
+     * @brief Empties every cell of the grid.
+     */
+    void reset() { xMarks = 0; oMarks = 0; }
+
+    /**
+     * @brief Returns the cells holding a player's marks.
+     * @param player Player::HUMAN or Player::Machine.
+     * @return A mask with the bit of every marked cell set.
+     */
+    uint64_t marks(Player player) const { return player == Player::Machine ? oMarks : xMarks; }
+    /**
+     * @brief Returns the empty cells.
+     * @return A mask with the bit of every empty cell of the grid set.
+     */
+    uint64_t emptyMask() const { return gridMask & ~(xMarks | oMarks); }
+    /**
+     * @brief Counts the marks of both players.
+     * @return The number of marked cells.
+     */
+    int markCount() const { return std::popcount(xMarks | oMarks); }
+    /**
+     * @brief Checks whether every cell holds a mark.
+     * @return True if the grid is full, false otherwise.
+     */
+    bool isFull() const { return emptyMask() == 0; }
+
+    /**
+     * @brief Checks whether a player has filled a row, a column or a diagonal.
+     * @param player The player to check.
+     * @return True if the player has won, false otherwise.
+     */
+    bool checkWin(Player player) const;
+    /**
+     * @brief Checks whether a player has won or the grid is full.
+     * @return True if the game is over, false otherwise.
+     */
+    bool isGameOver() const { return isFull() || checkWin(Player::HUMAN) || checkWin(Player::Machine); }
+
+    /**
+     * @brief Returns the number of winning lines of the grid.
+     * @return The line count, 2 * size() + 2.
+     */
+    int lineCount() const { return 2 * gridSize + 2; }
+    /**
+     * @brief Returns a winning line of the grid.
+     * @param index The line, from 0 to lineCount() - 1: rows, then columns, then both diagonals.
+     * @return The mask of the cells of the line.
+     */
+    uint64_t line(int index) const { return lines[index]; }
+
+private:
+    int gridSize;
+    uint64_t gridMask;
+    const uint64_t *lines;
+    uint64_t xMarks = 0;
+    uint64_t oMarks = 0;
+};
+
+#endif // TICTACTOEBOARD_H
@@ -0,0 +1,142 @@
+/**
+ * @file tictactoeperfect.cpp
+ * @brief Implementation of the TicTacToePerfectPlay table, built at compile time.
+ */
+#include "tictactoeperfect.h"
+#include <array>
+#include <bit>
+#include <cstdint>
+
+namespace {
+
+constexpr int Cells = TicTacToePerfectPlay::Size * TicTacToePerfectPlay::Size;
+
+/**
+ * @brief The rows, columns and diagonals of the 3x3 grid, as digit indices.
+ */
+constexpr int Lines[8][3] = {
+    { 0, 1, 2 }, { 3, 4, 5 }, { 6, 7, 8 }, { 0, 3, 6 }, { 1, 4, 7 }, { 2, 5, 8 }, { 0, 4, 8 }, { 2, 4, 6 }
+};
+
+/**
+ * @brief The value and best move of a position, for the player whose turn it is.
+ */
+struct PerfectMove {
+    int8_t score;    ///< WinScore minus the plies to a forced win, its negation for a loss, 0 for a draw.
+    int8_t move;     ///< Digit index of the best move, or -1 if the game is over or the code unreachable.
+};
+
+/**
+ * @brief Solves every 3x3 position, from the full grids back to the empty one.
+ * @return The table, indexed by base-3 code.
+ */
+constexpr std::array<PerfectMove, TicTacToePerfectPlay::PositionCount> buildPerfectTable()
+{
+    std::array<PerfectMove, TicTacToePerfectPlay::PositionCount> table{};
+    int powers[Cells] = {};
+    int digits[Cells] = {};
+    for (int i = 0, power = 1; i < Cells; ++i, power *= 3) {
+        powers[i] = power;
+        digits[i] = 2;
+    }
+
+    // The digits and the mark counts follow the code as it counts down, like an odometer
+    int xCount = 0;
+    int oCount = Cells;
+    for (int code = TicTacToePerfectPlay::PositionCount - 1; code >= 0; --code) {
+        if (code != TicTacToePerfectPlay::PositionCount - 1) {
+            int i = 0;
+            for (; digits[i] == 0; ++i) {
+                digits[i] = 2;
+                ++oCount;
+            }
+            if (digits[i]-- == 2) {
+                --oCount;
+                ++xCount;
+            } else {
+                --xCount;
+            }
+        }
+        table[code] = { 0, -1 };
+        if (xCount != oCount && xCount != oCount + 1) {
+            continue;
+        }
+
+        // X moves first, so the counts tell whose turn it is
+        int side = xCount == oCount ? 1 : 2;
+        bool lost = false;
+        for (const auto &line : Lines) {
+            lost = lost || (digits[line[0]] == 3 - side && digits[line[1]] == 3 - side && digits[line[2]] == 3 - side);
+        }
+        if (lost) {
+            table[code].score = -TicTacToePerfectPlay::WinScore;
+            continue;
+        }
+        if (xCount + oCount == Cells) {
+            continue;
+        }
+
+        // Negamax over the children, which all have higher codes and are solved already
+        int best = -TicTacToePerfectPlay::WinScore - 1;
+        for (int cell = 0; cell < Cells; ++cell) {
+            if (digits[cell] != 0) {
+                continue;
+            }
+            int child = table[code + side * powers[cell]].score;
+            int value = child > 0 ? 1 - child : child < 0 ? -1 - child : 0;
+            if (value > best) {
+                best = value;
+                table[code].move = static_cast<int8_t>(cell);
+            }
+        }
+        table[code].score = static_cast<int8_t>(best);
+    }
+    return table;
+}
+
+constexpr std::array<PerfectMove, TicTacToePerfectPlay::PositionCount> PerfectTable = buildPerfectTable();
+
+static_assert(PerfectTable[0].score == 0, "3x3 Tic Tac Toe must be a draw with perfect play");
+static_assert(PerfectTable[1 + 2 * 3].score == TicTacToePerfectPlay::WinScore - 5,
+              "after X in a corner and O next to it, X must win in five plies");
+
+} // namespace
+
+/**
+ * @brief Returns the base-3 code of a 3x3 grid.
+ * @param board The position, 3x3.
+ * @return The code, from 0 to PositionCount - 1.
+ */
+int TicTacToePerfectPlay::code(const TicTacToeBoard &board)
+{
+    int result = 0;
+    for (int cell = Cells - 1; cell >= 0; --cell) {
+        Player player = board.at(cell / Size, cell % Size);
+        result = 3 * result + (player == Player::HUMAN ? 1 : player == Player::Machine ? 2 : 0);
+    }
+    return result;
+}
+
+/**
+ * @brief Looks up the perfect move of a position.
+ * @param board The position, 3x3.
+ * @param player The player to move.
+ * @param move Receives the cell index of the move, as TicTacToeBoard::cellIndex().
+ * @param score Receives the value for the player.
+ * @return True if the move was found, false if the game is over or it is not the player's turn.
+ */
+bool TicTacToePerfectPlay::lookup(const TicTacToeBoard &board, Player player, int &move, int &score)
+{
+    if (board.size() != Size) {
+        return false;
+    }
+    int xCount = std::popcount(board.marks(Player::HUMAN));
+    int oCount = std::popcount(board.marks(Player::Machine));
+    const PerfectMove &entry = PerfectTable[code(board)];
+    if (entry.move < 0 || (player == Player::HUMAN) != (xCount == oCount)) {
+        return false;
+    }
+    move = TicTacToeBoard::cellIndex(entry.move / Size, entry.move % Size);
+    score = entry.score;
+    return true;
+}
@@ -0,0 +1,47 @@
+/**
+ * @file tictactoeperfect.h
+ * @brief Declares the TicTacToePerfectPlay class, the perfect-play table of the 3x3 grid.
+ *
+ * A 3x3 grid has only 3^9 = 19683 fillings, so the value and the best move of every position are
+ * computed by the compiler and stored as a constant array indexed by the base-3 code of the grid:
+ * digit row * 3 + col is 0 for an empty cell, 1 for X and 2 for O. Adding a mark only raises the
+ * code, so the table is filled from the last code down in a single pass, every child being known
+ * before its parent. Hard mode and hints on 3x3 then cost one array lookup and no search.
+ */
+#ifndef TICTACTOEPERFECT_H
+#define TICTACTOEPERFECT_H
+
+#include "tictactoeboard.h"
+
+/**
+ * @class TicTacToePerfectPlay
+ * @brief The TicTacToePerfectPlay class looks up the perfect move of a 3x3 Tic Tac Toe position.
+ */
+class TicTacToePerfectPlay {
+public:
+    static constexpr int Size = 3;                  ///< Rows and columns of the grid.
+    static constexpr int PositionCount = 19683;     ///< Base-3 codes of the grid, 3^9.
+    static constexpr int WinScore = 10;             ///< Value of a win on the spot, minus one per ply.
+
+    /**
+     * @brief Returns the base-3 code of a 3x3 grid.
+     * @param board The position, 3x3.
+     * @return The code, from 0 to PositionCount - 1.
+     */
+    static int code(const TicTacToeBoard &board);
+    /**
+     * @brief Looks up the perfect move of a position.
+     *
+     * X is taken to move first, so only the player whose turn it is by the mark counts is found.
+     * Among equal moves the first cell in reading order is chosen.
+     * @param board The position, 3x3.
+     * @param player The player to move.
+     * @param move Receives the cell index of the move, as TicTacToeBoard::cellIndex().
+     * @param score Receives the value for the player: WinScore minus the plies to a forced win,
+     *              its negation for a forced loss, or 0 for a draw.
+     * @return True if the move was found, false if the game is over or it is not the player's turn.
+     */
+    static bool lookup(const TicTacToeBoard &board, Player player, int &move, int &score);
+};
+
+#endif // TICTACTOEPERFECT_H
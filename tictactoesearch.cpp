@@ -0,0 +1,463 @@
+/**
+ * @file tictactoesearch.cpp
+ * @brief Implementation of the TicTacToeSearch class.
+ */
+#include "tictactoesearch.h"
+#include "tictactoeperfect.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+constexpr int Infinity = INT_MAX;
+constexpr int HistoryCap = 1 << 20;        // History is halved when an entry reaches it
+constexpr int KillerBonus = 1 << 28;       // Ranks the killer moves before any other
+
+/**
+ * @brief Value of an open line holding 0 to 7 marks of one player.
+ */
+constexpr int LineWeights[TicTacToeBoard::MaxSize] = { 0, 1, 4, 16, 64, 256, 1024, 4096 };
+
+/**
+ * @brief Maps every cell of a grid through the 8 rotations and reflections, and back.
+ */
+struct SymmetryTable {
+    uint8_t forward[TicTacToeSearch::SymmetryCount][TicTacToeSearch::MaxCells] = {};
+    uint8_t inverse[TicTacToeSearch::SymmetryCount][TicTacToeSearch::MaxCells] = {};
+};
+
+/**
+ * @brief Builds the symmetry maps of every grid size.
+ * @return The tables, indexed by size.
+ */
+constexpr std::array<SymmetryTable, TicTacToeBoard::MaxSize + 1> buildSymmetryTables()
+{
+    std::array<SymmetryTable, TicTacToeBoard::MaxSize + 1> tables{};
+    for (int size = TicTacToeBoard::MinSize; size <= TicTacToeBoard::MaxSize; ++size) {
+        int n = size - 1;
+        for (int r = 0; r < size; ++r) {
+            for (int c = 0; c < size; ++c) {
+                // Identity, the three rotations, the two mirrors and the two diagonal flips
+                const int images[TicTacToeSearch::SymmetryCount][2] = {
+                    { r, c }, { c, n - r }, { n - r, n - c }, { n - c, r },
+                    { r, n - c }, { n - r, c }, { c, r }, { n - c, n - r }
+                };
+                int cell = TicTacToeBoard::cellIndex(r, c);
+                for (int s = 0; s < TicTacToeSearch::SymmetryCount; ++s) {
+                    int image = TicTacToeBoard::cellIndex(images[s][0], images[s][1]);
+                    tables[size].forward[s][cell] = static_cast<uint8_t>(image);
+                    tables[size].inverse[s][image] = static_cast<uint8_t>(cell);
+                }
+            }
+        }
+    }
+    return tables;
+}
+
+constexpr std::array<SymmetryTable, TicTacToeBoard::MaxSize + 1> SymmetryTables = buildSymmetryTables();
+
+/**
+ * @brief The random keys XOR-ed into the hash of a position.
+ */
+struct ZobristKeys {
+    uint64_t marks[2][TicTacToeSearch::MaxCells] = {};    ///< One per player and cell.
+    uint64_t sizes[TicTacToeBoard::MaxSize + 1] = {};     ///< One per grid size.
+    uint64_t machineToMove = 0;                           ///< Set when O is to move.
+};
+
+/**
+ * @brief Draws the Zobrist keys from a fixed SplitMix64 sequence, so every build hashes alike.
+ * @return The keys.
+ */
+constexpr ZobristKeys buildZobristKeys()
+{
+    ZobristKeys keys{};
+    uint64_t state = 0x5454540000000000ULL;
+    auto next = [&state]() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    };
+    for (auto &player : keys.marks) {
+        for (uint64_t &key : player) {
+            key = next();
+        }
+    }
+    for (uint64_t &key : keys.sizes) {
+        key = next();
+    }
+    keys.machineToMove = next();
+    return keys;
+}
+
+constexpr ZobristKeys Zobrist = buildZobristKeys();
+
+/**
+ * @brief Tells whether a value is a forced win or loss rather than a static score.
+ * @param value The value.
+ * @return True for a decided value.
+ */
+inline bool isDecided(int value)
+{
+    return std::abs(value) >= TicTacToeSearch::WinScore - 2 * TicTacToeSearch::MaxCells;
+}
+
+/**
+ * @brief Converts a decided value from distance to the root to distance to the node, for the table.
+ * @param value The value.
+ * @param ply The distance from the root to the node.
+ * @return The value to store.
+ */
+inline int toTable(int value, int ply)
+{
+    return isDecided(value) ? value + (value > 0 ? ply : -ply) : value;
+}
+
+/**
+ * @brief Converts a stored decided value back to distance to the root.
+ * @param value The stored value.
+ * @param ply The distance from the root to the node.
+ * @return The value for the search.
+ */
+inline int fromTable(int value, int ply)
+{
+    return isDecided(value) ? value - (value > 0 ? ply : -ply) : value;
+}
+
+/**
+ * @brief Returns the opponent of a player.
+ * @param player Player::HUMAN or Player::Machine.
+ * @return The other player.
+ */
+inline Player opponentOf(Player player)
+{
+    return player == Player::HUMAN ? Player::Machine : Player::HUMAN;
+}
+
+} // namespace
+
+/**
+ * @brief Finds the best move of a player, within a time limit.
+ * @param position The position.
+ * @param player The player to move.
+ * @param timeLimitMs The time limit, in milliseconds.
+ * @return The cell index of the move, or -1 if the game is over.
+ */
+int TicTacToeSearch::bestMove(const TicTacToeBoard &position, Player player, int timeLimitMs)
+{
+    board = position;
+    nodes = 0;
+    completedDepth = 0;
+    bestScore = 0;
+    stopping = false;
+    deadline = QDeadlineTimer(timeLimitMs, Qt::PreciseTimer);
+    std::memset(killers, -1, sizeof(killers));
+    std::memset(history, 0, sizeof(history));
+    std::memset(hashes, 0, sizeof(hashes));
+    for (uint64_t marks = board.marks(Player::HUMAN) | board.marks(Player::Machine); marks != 0; marks &= marks - 1) {
+        int cell = std::countr_zero(marks);
+        Player owner = board.at(cell / TicTacToeBoard::MaxSize, cell % TicTacToeBoard::MaxSize);
+        for (int s = 0; s < SymmetryCount; ++s) {
+            hashes[s] ^= Zobrist.marks[owner == Player::Machine][SymmetryTables[board.size()].forward[s][cell]];
+        }
+    }
+
+    if (board.isGameOver()) {
+        return -1;
+    }
+
+    // Every 3x3 position was solved at compile time
+    int perfectMove = -1;
+    int perfectScore = 0;
+    if (TicTacToePerfectPlay::lookup(board, player, perfectMove, perfectScore)) {
+        int plies = TicTacToePerfectPlay::WinScore - std::abs(perfectScore);
+        bestScore = perfectScore > 0 ? WinScore - plies : perfectScore < 0 ? plies - WinScore : 0;
+        completedDepth = std::popcount(board.emptyMask());
+        return perfectMove;
+    }
+
+    LineScan lines = scan(player);
+    if (lines.wins != 0) {
+        bestScore = WinScore - 1;
+        return std::countr_zero(lines.wins);
+    }
+
+    // A single threat must be blocked; against two, the block at least delays the loss
+    int moves[MaxCells];
+    int values[MaxCells];
+    int count = orderedMoves(lines.blocks != 0 ? lines.blocks : board.emptyMask(), 0, -1, moves);
+    int best = moves[0];
+    int emptyCells = std::popcount(board.emptyMask());
+    for (int depth = 1; depth <= emptyCells; ++depth) {
+        int alpha = -Infinity;
+        int bestIndex = 0;
+        for (int i = 0; i < count && !stopping; ++i) {
+            // A move cut off by alpha only gets an upper bound, which still ranks it behind the best
+            makeMove(moves[i], player);
+            values[i] = -negamax(opponentOf(player), depth - 1, 1, -Infinity, -alpha);
+            unmakeMove(moves[i], player);
+            if (values[i] > alpha) {
+                alpha = values[i];
+                bestIndex = i;
+            }
+        }
+        if (stopping) {
+            break;
+        }
+        best = moves[bestIndex];
+        bestScore = alpha;
+        completedDepth = depth;
+        // A forced result cannot change with more depth
+        if (std::abs(alpha) >= WinScore - MaxCells || deadline.hasExpired()) {
+            break;
+        }
+
+        // Search the best moves of this iteration first in the next one
+        for (int i = 1; i < count; ++i) {
+            int move = moves[i];
+            int value = values[i];
+            int j = i;
+            for (; j > 0 && values[j - 1] < value; --j) {
+                moves[j] = moves[j - 1];
+                values[j] = values[j - 1];
+            }
+            moves[j] = move;
+            values[j] = value;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Plays a move and updates the hashes of every symmetry.
+ * @param cell The cell index.
+ * @param player The player who moves.
+ */
+void TicTacToeSearch::makeMove(int cell, Player player)
+{
+    board.play(cell, player);
+    const SymmetryTable &symmetries = SymmetryTables[board.size()];
+    const uint64_t *keys = Zobrist.marks[player == Player::Machine];
+    for (int s = 0; s < SymmetryCount; ++s) {
+        hashes[s] ^= keys[symmetries.forward[s][cell]];
+    }
+}
+
+/**
+ * @brief Takes a move back and updates the hashes of every symmetry.
+ * @param cell The cell index.
+ * @param player The player who had moved.
+ */
+void TicTacToeSearch::unmakeMove(int cell, Player player)
+{
+    board.undo(cell);
+    const SymmetryTable &symmetries = SymmetryTables[board.size()];
+    const uint64_t *keys = Zobrist.marks[player == Player::Machine];
+    for (int s = 0; s < SymmetryCount; ++s) {
+        hashes[s] ^= keys[symmetries.forward[s][cell]];
+    }
+}
+
+/**
+ * @brief Returns the key of the position shared by all its symmetric images.
+ * @param player The player to move.
+ * @param symmetry Receives the symmetry that maps the grid onto the canonical image.
+ * @return The canonical Zobrist key.
+ */
+uint64_t TicTacToeSearch::canonicalKey(Player player, int &symmetry) const
+{
+    symmetry = 0;
+    for (int s = 1; s < SymmetryCount; ++s) {
+        if (hashes[s] < hashes[symmetry]) {
+            symmetry = s;
+        }
+    }
+    return hashes[symmetry] ^ Zobrist.sizes[board.size()] ^ (player == Player::Machine ? Zobrist.machineToMove : 0);
+}
+
+/**
+ * @brief Scans the lines of a position for threats and scores it by its open lines.
+ * @param player The player to move.
+ * @return The threats of both players and the static value.
+ */
+TicTacToeSearch::LineScan TicTacToeSearch::scan(Player player) const
+{
+    uint64_t own = board.marks(player);
+    uint64_t other = board.marks(opponentOf(player));
+    uint64_t empty = board.emptyMask();
+    int last = board.size() - 1;
+    LineScan result = { 0, 0, 0 };
+    for (int i = 0; i < board.lineCount(); ++i) {
+        uint64_t line = board.line(i);
+        int mine = std::popcount(own & line);
+        int theirs = std::popcount(other & line);
+        if (theirs == 0) {
+            result.value += LineWeights[mine];
+            if (mine == last) {
+                result.wins |= line & empty;
+            }
+        } else if (mine == 0) {
+            result.value -= LineWeights[theirs];
+            if (theirs == last) {
+                result.blocks |= line & empty;
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Orders moves best first by table move, killer moves, history and open lines through their cells.
+ * @param candidates The cells of the moves.
+ * @param ply The distance from the root, to look up the killer moves.
+ * @param tableMove The cell of the best move stored in the table, or -1.
+ * @param moves Receives the cell indices of the moves, best first.
+ * @return The number of moves.
+ */
+int TicTacToeSearch::orderedMoves(uint64_t candidates, int ply, int tableMove, int moves[MaxCells]) const
+{
+    // Every open line adds to its empty cells, more the fuller it is, so the center, which lies on
+    // the most lines, and the cells that build or stop a threat come first
+    int keys[MaxCells] = {};
+    uint64_t taken = ~board.emptyMask();
+    uint64_t xMarks = board.marks(Player::HUMAN);
+    uint64_t oMarks = board.marks(Player::Machine);
+    for (int i = 0; i < board.lineCount(); ++i) {
+        uint64_t line = board.line(i);
+        int x = std::popcount(xMarks & line);
+        int o = std::popcount(oMarks & line);
+        if (x != 0 && o != 0) {
+            continue;
+        }
+        int weight = 1 + LineWeights[x + o];
+        for (uint64_t cells = line & ~taken & candidates; cells != 0; cells &= cells - 1) {
+            keys[std::countr_zero(cells)] += weight;
+        }
+    }
+
+    int values[MaxCells];
+    int count = 0;
+    for (; candidates != 0; candidates &= candidates - 1) {
+        int cell = std::countr_zero(candidates);
+        int value = history[cell] + 16 * keys[cell];
+        if (cell == tableMove) {
+            value += 4 * KillerBonus;
+        } else if (cell == killers[ply][0]) {
+            value += 2 * KillerBonus;
+        } else if (cell == killers[ply][1]) {
+            value += KillerBonus;
+        }
+        int j = count++;
+        for (; j > 0 && values[j - 1] < value; --j) {
+            moves[j] = moves[j - 1];
+            values[j] = values[j - 1];
+        }
+        moves[j] = cell;
+        values[j] = value;
+    }
+    return count;
+}
+
+/**
+ * @brief Scores a position with negamax and alpha-beta pruning.
+ * @param player The player to move.
+ * @param depth The number of plies left to search.
+ * @param ply The distance from the root.
+ * @param alpha The value the player is already sure of.
+ * @param beta The value the opponent is already sure of.
+ * @return The value of the best move, from the player's view.
+ */
+int TicTacToeSearch::negamax(Player player, int depth, int ply, int alpha, int beta)
+{
+    // Depth 1 always completes, so there is a move to fall back on
+    if ((++nodes & 0x3FF) == 0 && completedDepth > 0 && deadline.hasExpired()) {
+        stopping = true;
+    }
+    if (stopping) {
+        return 0;
+    }
+
+    // The parent never plays past a win, so the opponent has not completed a line yet
+    LineScan lines = scan(player);
+    if (lines.wins != 0) {
+        return WinScore - (ply + 1);
+    }
+    uint64_t empty = board.emptyMask();
+    if (empty == 0) {
+        return 0;
+    }
+    if (lines.blocks & (lines.blocks - 1)) {
+        // Two threats cannot both be blocked
+        return -(WinScore - (ply + 2));
+    }
+    if (depth <= 0) {
+        return lines.value;
+    }
+
+    // A search that reaches the end of the game holds at any depth
+    int emptyCells = std::popcount(empty);
+    int symmetry = 0;
+    uint64_t key = canonicalKey(player, symmetry);
+    const SymmetryTable &symmetries = SymmetryTables[board.size()];
+    int tableMove = -1;
+    TicTacToeTable::Entry entry;
+    if (table.probe(key, entry)) {
+        if (entry.move >= 0) {
+            tableMove = symmetries.inverse[symmetry][entry.move];
+        }
+        if (entry.depth >= std::min(depth, emptyCells)) {
+            int value = fromTable(entry.value, ply);
+            if (entry.bound == TicTacToeTable::Exact
+                || (entry.bound == TicTacToeTable::Lower && value >= beta)
+                || (entry.bound == TicTacToeTable::Upper && value <= alpha)) {
+                return value;
+            }
+        }
+    }
+
+    int moves[MaxCells];
+    int count = orderedMoves(lines.blocks != 0 ? lines.blocks : empty, ply, tableMove, moves);
+    Player opponent = opponentOf(player);
+    int originalAlpha = alpha;
+    int best = -Infinity;
+    int bestMove = moves[0];
+    for (int i = 0; i < count; ++i) {
+        makeMove(moves[i], player);
+        int value = -negamax(opponent, depth - 1, ply + 1, -beta, -alpha);
+        unmakeMove(moves[i], player);
+        if (stopping) {
+            return 0;
+        }
+        if (value > best) {
+            best = value;
+            bestMove = moves[i];
+        }
+        alpha = std::max(alpha, value);
+        if (alpha >= beta) {
+            // Remember the refutation for the siblings and for the next iterations
+            if (killers[ply][0] != moves[i]) {
+                killers[ply][1] = killers[ply][0];
+                killers[ply][0] = moves[i];
+            }
+            history[moves[i]] += depth * depth;
+            if (history[moves[i]] >= HistoryCap) {
+                for (int &weight : history) {
+                    weight /= 2;
+                }
+            }
+            break;
+        }
+    }
+
+    TicTacToeTable::Bound bound = best <= originalAlpha ? TicTacToeTable::Upper
+                                  : best >= beta        ? TicTacToeTable::Lower
+                                                        : TicTacToeTable::Exact;
+    table.store(key, { toTable(best, ply), depth >= emptyCells ? MaxCells : depth, bound,
+                       symmetries.forward[symmetry][bestMove] });
+    return best;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file tictactoesearch.h
+ * @brief Declares the TicTacToeSearch class, the negamax alpha-beta search behind Hard mode and hints.
+ *
+ * The search plays on a TicTacToeBoard in place, so a node costs a few mask operations and no
+ * allocation. A win scores WinScore minus the number of plies it takes, so among won positions the
+ * search prefers the fastest win and among lost ones the slowest loss. Below the horizon a position
+ * is scored by its open lines: each line still free of the opponent's marks counts for its owner,
+ * four times more for every mark it holds.
+ *
+ * Alpha-beta only pays off when the best move is searched first, so the moves of a node are
+ * ordered: an immediate win ends the node, a single threat of the opponent forces the block, and
+ * the other moves follow the killer moves of the ply, the history of the moves that caused cutoffs
+ * and the open lines through each cell, which puts the center and the threats first. bestMove()
+ * deepens one ply at a time until a time limit and keeps the move of the deepest iteration that
+ * finished, so Hard mode plays 4x4 and 5x5 grids as strongly as the limit allows.
+ *
+ * Results are kept in a TicTacToeTable across iterations and moves. A position is keyed by its
+ * Zobrist hash under each of the 8 rotations and reflections of the grid, all updated incrementally
+ * with every move, and the smallest of them is its canonical key: symmetric positions share one
+ * entry, and the best move is stored in the canonical frame and mapped back on a hit. The table
+ * move is searched first, and a value searched to the end of the game is reused at any depth.
+ *
+ * 3x3 positions are not searched at all: they are looked up in the TicTacToePerfectPlay table.
+ */
+#ifndef TICTACTOESEARCH_H
+#define TICTACTOESEARCH_H
+
+#include "tictactoeboard.h"
+#include "tictactoetable.h"
+#include <QDeadlineTimer>
+#include <cstdint>
+
+/**
+ * @class TicTacToeSearch
+ * @brief The TicTacToeSearch class finds the best move of a Tic Tac Toe position within a time limit.
+ */
+class TicTacToeSearch {
+public:
+    static constexpr int DefaultTimeMs = 200;     ///< Time limit of a move.
+    static constexpr int WinScore = 1000000;      ///< Value of a win on the spot, minus one per ply.
+    static constexpr int MaxCells = TicTacToeBoard::MaxSize * TicTacToeBoard::MaxSize;    ///< Most cells of a grid.
+    static constexpr int SymmetryCount = 8;       ///< Rotations and reflections of a square grid.
+
+    /**
+     * @brief Finds the best move of a player, within a time limit.
+     *
+     * Depth 1 always completes, so a move is found however short the limit.
+     * @param board The position.
+     * @param player The player to move.
+     * @param timeLimitMs The time limit, in milliseconds.
+     * @return The cell index of the move, or -1 if the game is over.
+     */
+    int bestMove(const TicTacToeBoard &board, Player player, int timeLimitMs = DefaultTimeMs);
+    /**
+     * @brief Returns the value of the move found by the last search, for the player who moves.
+     * @return The value, WinScore minus the plies to the end for a forced win.
+     */
+    int score() const { return bestScore; }
+    /**
+     * @brief Returns the number of positions visited by the last search.
+     * @return The node count.
+     */
+    uint64_t nodeCount() const { return nodes; }
+    /**
+     * @brief Returns the depth of the deepest iteration the last search finished.
+     * @return The reached depth, in plies.
+     */
+    int reachedDepth() const { return completedDepth; }
+
+private:
+    /**
+     * @brief What a scan of the lines tells about a position.
+     */
+    struct LineScan {
+        uint64_t wins;      ///< Empty cells that complete a line of the player to move.
+        uint64_t blocks;    ///< Empty cells that complete a line of the opponent.
+        int value;          ///< Static value, from the view of the player to move.
+    };
+
+    /**
+     * @brief Plays a move and updates the hashes of every symmetry.
+     * @param cell The cell index.
+     * @param player The player who moves.
+     */
+    void makeMove(int cell, Player player);
+    /**
+     * @brief Takes a move back and updates the hashes of every symmetry.
+     * @param cell The cell index.
+     * @param player The player who had moved.
+     */
+    void unmakeMove(int cell, Player player);
+    /**
+     * @brief Returns the key of the position shared by all its symmetric images.
+     * @param player The player to move.
+     * @param symmetry Receives the symmetry that maps the grid onto the canonical image.
+     * @return The canonical Zobrist key.
+     */
+    uint64_t canonicalKey(Player player, int &symmetry) const;
+    /**
+     * @brief Scans the lines of a position for threats and scores it by its open lines.
+     * @param player The player to move.
+     * @return The threats of both players and the static value.
+     */
+    LineScan scan(Player player) const;
+    /**
+     * @brief Orders moves best first by table move, killer moves, history and open lines through their cells.
+     * @param candidates The cells of the moves.
+     * @param ply The distance from the root, to look up the killer moves.
+     * @param tableMove The cell of the best move stored in the table, or -1.
+     * @param moves Receives the cell indices of the moves, best first.
+     * @return The number of moves.
+     */
+    int orderedMoves(uint64_t candidates, int ply, int tableMove, int moves[MaxCells]) const;
+    /**
+     * @brief Scores a position with negamax and alpha-beta pruning.
+     * @param player The player to move.
+     * @param depth The number of plies left to search.
+     * @param ply The distance from the root.
+     * @param alpha The value the player is already sure of.
+     * @param beta The value the opponent is already sure of.
+     * @return The value of the best move, from the player's view.
+     */
+    int negamax(Player player, int depth, int ply, int alpha, int beta);
+
+    TicTacToeBoard board;
+    TicTacToeTable table;
+    uint64_t hashes[SymmetryCount];
+    int killers[MaxCells + 1][2];
+    int history[MaxCells];
+    int bestScore = 0;
+    int completedDepth = 0;
+    uint64_t nodes = 0;
+    bool stopping = false;
+    QDeadlineTimer deadline;
+};
+
+#endif // TICTACTOESEARCH_H
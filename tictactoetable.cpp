@@ -0,0 +1,63 @@
+/**
+ * @file tictactoetable.cpp
+ * @brief Implementation of the TicTacToeTable lock-free cache.
+ */
+#include "tictactoetable.h"
+
+/**
+ * @brief Constructs a table with 2^bits slots.
+ * @param bits The log2 of the number of slots.
+ */
+TicTacToeTable::TicTacToeTable(int bits)
+    : slots(new Slot[static_cast<size_t>(1) << bits]), mask((static_cast<uint64_t>(1) << bits) - 1)
+{
+    clear();
+}
+
+/**
+ * @brief Looks up a position.
+ * @param key The Zobrist key of the position.
+ * @param entry Receives the stored result on a hit.
+ * @return True on a hit, false otherwise.
+ */
+bool TicTacToeTable::probe(uint64_t key, Entry &entry) const
+{
+    const Slot &slot = slots[key & mask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != key || (data >> 56) == 0) {
+        return false;
+    }
+    entry.value = static_cast<int32_t>(static_cast<uint32_t>(data));
+    entry.depth = static_cast<int>((data >> 32) & 0xFF);
+    entry.bound = static_cast<Bound>((data >> 40) & 0x3);
+    entry.move = static_cast<int>((data >> 48) & 0xFF) - 1;
+    return true;
+}
+
+/**
+ * @brief Stores the result of a search, replacing whatever the slot held.
+ * @param key The Zobrist key of the position.
+ * @param entry The result.
+ */
+void TicTacToeTable::store(uint64_t key, const Entry &entry)
+{
+    Slot &slot = slots[key & mask];
+    uint64_t data = static_cast<uint32_t>(entry.value) | (static_cast<uint64_t>(entry.depth & 0xFF) << 32)
+                    | (static_cast<uint64_t>(entry.bound) << 40) | (static_cast<uint64_t>((entry.move + 1) & 0xFF) << 48)
+                    | (1ULL << 56);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Empties every slot.
+ */
+void TicTacToeTable::clear()
+{
+    // A zero entry never matches, since stored entries always carry bit 56
+    for (uint64_t i = 0; i <= mask; ++i) {
+        slots[i].check.store(0, std::memory_order_relaxed);
+        slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
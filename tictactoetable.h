@@ -0,0 +1,78 @@
+/**
+ * @file tictactoetable.h
+ * @brief Declares the TicTacToeTable class, a lock-free transposition table for the Tic Tac Toe search.
+ */
+#ifndef TICTACTOETABLE_H
+#define TICTACTOETABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @class TicTacToeTable
+ * @brief The TicTacToeTable class caches the value, bound, depth and best move of searched positions.
+ *
+ * Positions are keyed by a 64-bit Zobrist hash. Each slot holds two 64-bit words: the packed entry
+ * and the key XOR-ed with the entry, so a reader only accepts a slot whose two words decode back to
+ * the requested key and a slot torn by a concurrent writer is seen as a miss. No locks are taken.
+ */
+class TicTacToeTable {
+public:
+    /**
+     * @brief How a stored value relates to the true value of the position.
+     */
+    enum Bound {
+        Exact,     ///< The value is exact.
+        Lower,     ///< The search failed high: the true value is at least the stored one.
+        Upper      ///< The search failed low: the true value is at most the stored one.
+    };
+
+    /**
+     * @brief A search result read from the table.
+     */
+    struct Entry {
+        int value;     ///< Value of the position, from the view of the player to move.
+        int depth;     ///< Number of plies the value was searched to.
+        Bound bound;   ///< How the value bounds the true value.
+        int move;      ///< Cell index of the best move, or -1 if none was found.
+    };
+
+    /**
+     * @brief Constructs a table with 2^bits slots.
+     * @param bits The log2 of the number of slots.
+     */
+    explicit TicTacToeTable(int bits = 18);
+
+    /**
+     * @brief Looks up a position.
+     * @param key The Zobrist key of the position.
+     * @param entry Receives the stored result on a hit.
+     * @return True on a hit, false otherwise.
+     */
+    bool probe(uint64_t key, Entry &entry) const;
+    /**
+     * @brief Stores the result of a search, replacing whatever the slot held.
+     * @param key The Zobrist key of the position.
+     * @param entry The result; depth from 0 to 255, move from -1 to 254.
+     */
+    void store(uint64_t key, const Entry &entry);
+    /**
+     * @brief Empties every slot.
+     */
+    void clear();
+
+private:
+    /**
+     * @brief A slot of the table.
+     */
+    struct Slot {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    uint64_t mask;
+};
+
+#endif // TICTACTOETABLE_H
@@ -0,0 +1,181 @@
+/**
+ * @file train2048.cpp
+ * @brief Command-line temporal-difference trainer for the 2048 n-tuple network.
+ *
+ * Plays self-play games on all cores with the greedy policy of the network being trained and
+ * updates it after every move by TD(0) on afterstates: the value of the previous afterstate moves
+ * towards the score of the next move plus the value of the next afterstate. The workers share one
+ * network and update it without locks. Training runs in rounds; after each round the statistics of
+ * its games are printed and the weights are saved, so an interrupted run can be resumed.
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include <QtConcurrent>
+#include "board2048.h"
+#include "greedy2048.h"
+#include "ntuple2048.h"
+#include "rng2048.h"
+
+/**
+ * @brief One training thread: its random stream, its share of a round and what it measured.
+ */
+struct TrainWorker {
+    Rng2048 rng;
+    qint64 games = 0;
+    qint64 moves = 0;
+    qint64 scoreSum = 0;
+    int bestScore = 0;
+    qint64 reached2048 = 0;
+};
+
+/**
+ * @brief Plays and learns from the games of one worker in the current round.
+ * @param network The shared network.
+ * @param worker The worker.
+ * @param alpha The learning rate.
+ */
+static void runWorker(NTuple2048 &network, TrainWorker &worker, float alpha)
+{
+    worker.moves = 0;
+    worker.scoreSum = 0;
+    worker.bestScore = 0;
+    worker.reached2048 = 0;
+
+    for (qint64 game = 0; game < worker.games; ++game) {
+        Board2048 board;
+        board.spawnTile(worker.rng);
+        board.spawnTile(worker.rng);
+
+        int score = 0;
+        bool hasPrevious = false;
+        uint64_t previous = 0;
+        Greedy2048::Move move;
+        while (Greedy2048::choose(board.bits(), move, &network)) {
+            if (hasPrevious) {
+                float target = move.addedScore + network.evaluate(move.afterstate);
+                network.update(previous, alpha * (target - network.evaluate(previous)));
+            }
+            hasPrevious = true;
+            previous = move.afterstate;
+
+            board = Board2048(move.afterstate);
+            board.spawnTile(worker.rng);
+            score += move.addedScore;
+            ++worker.moves;
+        }
+        // Nothing more can be gained from the last afterstate
+        if (hasPrevious) {
+            network.update(previous, -alpha * network.evaluate(previous));
+        }
+
+        worker.scoreSum += score;
+        worker.bestScore = qMax(worker.bestScore, score);
+        if (board.maxTile() >= 2048) {
+            ++worker.reached2048;
+        }
+    }
+}
+
+/**
+ * @brief Main function.
+ * @param argc Number of command line arguments.
+ * @param argv Array of command line arguments.
+ * @return Exit status.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("train2048");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Trains the 2048 n-tuple network by self-play and saves its weights file.");
+    parser.addHelpOption();
+    parser.addOption({ "games", "Number of games to play.", "count", "200000" });
+    parser.addOption({ "round", "Games per round; progress is printed and the weights saved after each.", "count", "10000" });
+    parser.addOption({ "threads", "Number of worker threads.", "threads", QString::number(QThread::idealThreadCount()) });
+    parser.addOption({ "seed", "Base seed of the random streams.", "seed", "2048" });
+    parser.addOption({ "alpha", "Learning rate of a whole position.", "alpha", "0.1" });
+    parser.addOption({ "output", "Weights file to write.", "file", "ntuple2048.weights" });
+    parser.addOption({ "resume", "Continue training from the weights already in the output file." });
+    parser.process(app);
+
+    qint64 games = parser.value("games").toLongLong();
+    qint64 roundGames = parser.value("round").toLongLong();
+    int threads = qMax(1, parser.value("threads").toInt());
+    quint64 seed = parser.value("seed").toULongLong();
+    float alpha = parser.value("alpha").toFloat();
+    QString output = parser.value("output");
+    if (games <= 0 || roundGames <= 0 || alpha <= 0.0f) {
+        parser.showHelp(1);
+    }
+
+    QTextStream out(stdout);
+    NTuple2048 network;
+    if (parser.isSet("resume")) {
+        if (!network.loadForTraining(output)) {
+            out << "cannot resume from " << output << "\n";
+            return 1;
+        }
+    } else {
+        network.allocate();
+    }
+
+    // The games already in the weights shift the seed, so a resumed run does not replay the games of
+    // the rounds it resumes after
+    quint64 trained = network.trainedGames();
+    QVector<TrainWorker> workers(threads);
+    for (int i = 0; i < threads; ++i) {
+        workers[i].rng = Rng2048::stream(seed + trained, i);
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    out << games << " games, " << threads << " threads, alpha " << alpha << ", seed " << seed << "\n";
+    out << "     games   mean score   best score   2048 %    moves/s\n";
+    out.flush();
+
+    for (qint64 played = 0; played < games; ) {
+        qint64 round = qMin(roundGames, games - played);
+        for (int i = 0; i < threads; ++i) {
+            workers[i].games = round / threads + (i < round % threads ? 1 : 0);
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        QtConcurrent::blockingMap(&pool, workers, [&network, alpha](TrainWorker &worker) {
+            runWorker(network, worker, alpha);
+        });
+        double seconds = timer.nsecsElapsed() / 1e9;
+        played += round;
+        network.setTrainedGames(trained + static_cast<quint64>(played));
+
+        qint64 moves = 0;
+        qint64 scoreSum = 0;
+        int bestScore = 0;
+        qint64 reached2048 = 0;
+        for (const TrainWorker &worker : workers) {
+            moves += worker.moves;
+            scoreSum += worker.scoreSum;
+            bestScore = qMax(bestScore, worker.bestScore);
+            reached2048 += worker.reached2048;
+        }
+        out << QString("%1 %2 %3 %4 %5\n")
+                   .arg(static_cast<qint64>(trained) + played, 10)
+                   .arg(static_cast<double>(scoreSum) / round, 12, 'f', 0)
+                   .arg(bestScore, 12)
+                   .arg(100.0 * reached2048 / round, 8, 'f', 2)
+                   .arg(moves / seconds, 10, 'f', 0);
+        out.flush();
+
+        if (!network.save(output)) {
+            out << "cannot write " << output << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
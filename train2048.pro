@@ -0,0 +1,22 @@
+# Command-line temporal-difference trainer for the 2048 n-tuple network.
+
+QT = core concurrent
+
+CONFIG += c++20 console
+CONFIG -= app_bundle
+
+TARGET = train2048
+
+HEADERS += \
+    board2048.h \
+    greedy2048.h \
+    heuristic2048.h \
+    ntuple2048.h \
+    rng2048.h
+
+SOURCES += \
+    train2048.cpp \
+    board2048.cpp \
+    greedy2048.cpp \
+    heuristic2048.cpp \
+    ntuple2048.cpp
@@ -0,0 +1,99 @@
+/**
+ * @file transpositiontable2048.cpp
+ * @brief Implementation of the TranspositionTable2048 lock-free cache.
+ */
+#include "transpositiontable2048.h"
+#include <cstring>
+
+namespace {
+
+/**
+ * @brief Packs a value with the depth and budget it was computed for.
+ * @param depth The remaining search depth.
+ * @param budget The remaining probability budget.
+ * @param value The value.
+ * @return The packed payload.
+ */
+inline uint64_t packData(int depth, int budget, float value)
+{
+    uint32_t valueBits;
+    std::memcpy(&valueBits, &value, sizeof(valueBits));
+    return valueBits | (static_cast<uint64_t>(depth & 0xFF) << 32) | (static_cast<uint64_t>(budget & 0xFF) << 40)
+           | (1ULL << 48);
+}
+
+} // namespace
+
+/**
+ * @brief Constructs a table with 2^bits slots.
+ * @param bits The log2 of the number of slots.
+ */
+TranspositionTable2048::TranspositionTable2048(int bits)
+    : slots(new Slot[static_cast<size_t>(1) << bits]), mask((static_cast<uint64_t>(1) << bits) - 1)
+{
+    clear();
+}
+
+/**
+ * @brief Looks up the value of a chance node.
+ * @param board The packed board.
+ * @param depth The remaining search depth.
+ * @param budget The remaining probability budget.
+ * @param value Receives the cached value on a hit.
+ * @return True on a hit, false otherwise.
+ */
+bool TranspositionTable2048::probe(uint64_t board, int depth, int budget, float &value) const
+{
+    const Slot &slot = slotFor(board, depth, budget);
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != board || (data >> 32) != (packData(depth, budget, 0.0f) >> 32)) {
+        return false;
+    }
+    uint32_t valueBits = static_cast<uint32_t>(data);
+    std::memcpy(&value, &valueBits, sizeof(value));
+    return true;
+}
+
+/**
+ * @brief Stores the value of a chance node, replacing whatever the slot held.
+ * @param board The packed board.
+ * @param depth The remaining search depth.
+ * @param budget The remaining probability budget.
+ * @param value The value to store.
+ */
+void TranspositionTable2048::store(uint64_t board, int depth, int budget, float value)
+{
+    Slot &slot = slotFor(board, depth, budget);
+    uint64_t data = packData(depth, budget, value);
+    slot.check.store(board ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Empties every slot.
+ */
+void TranspositionTable2048::clear()
+{
+    // A zero payload never matches, since stored payloads always carry bit 48
+    for (uint64_t i = 0; i <= mask; ++i) {
+        slots[i].check.store(0, std::memory_order_relaxed);
+        slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Returns the slot a key maps to.
+ * @param board The packed board.
+ * @param depth The remaining search depth.
+ * @param budget The remaining probability budget.
+ * @return The slot.
+ */
+TranspositionTable2048::Slot &TranspositionTable2048::slotFor(uint64_t board, int depth, int budget) const
+{
+    uint64_t h = board ^ (static_cast<uint64_t>(depth) << 56) ^ (static_cast<uint64_t>(budget) << 48);
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    return slots[h & mask];
+}
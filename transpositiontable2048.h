@@ -0,0 +1,72 @@
+/**
+ * @file transpositiontable2048.h
+ * @brief Declares the TranspositionTable2048 class, a lock-free cache of 2048 search results.
+ */
+#ifndef TRANSPOSITIONTABLE2048_H
+#define TRANSPOSITIONTABLE2048_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @class TranspositionTable2048
+ * @brief The TranspositionTable2048 class caches chance-node values shared by all search threads.
+ *
+ * Each slot holds two 64-bit words: the packed payload and the board XOR-ed with the payload.
+ * A reader only accepts a slot whose two words decode back to the requested board, so a slot torn
+ * by a concurrent writer is seen as a miss instead of a wrong value. No locks are taken.
+ */
+class TranspositionTable2048 {
+public:
+    /**
+     * @brief Constructs a table with 2^bits slots.
+     * @param bits The log2 of the number of slots.
+     */
+    explicit TranspositionTable2048(int bits = 20);
+
+    /**
+     * @brief Looks up the value of a chance node.
+     * @param board The packed board.
+     * @param depth The remaining search depth.
+     * @param budget The remaining probability budget.
+     * @param value Receives the cached value on a hit.
+     * @return True on a hit, false otherwise.
+     */
+    bool probe(uint64_t board, int depth, int budget, float &value) const;
+    /**
+     * @brief Stores the value of a chance node, replacing whatever the slot held.
+     * @param board The packed board.
+     * @param depth The remaining search depth.
+     * @param budget The remaining probability budget.
+     * @param value The value to store.
+     */
+    void store(uint64_t board, int depth, int budget, float value);
+    /**
+     * @brief Empties every slot.
+     */
+    void clear();
+
+private:
+    /**
+     * @brief A slot of the table.
+     */
+    struct Slot {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+
+    /**
+     * @brief Returns the slot a key maps to.
+     * @param board The packed board.
+     * @param depth The remaining search depth.
+     * @param budget The remaining probability budget.
+     * @return The slot.
+     */
+    Slot &slotFor(uint64_t board, int depth, int budget) const;
+
+    std::unique_ptr<Slot[]> slots;
+    uint64_t mask;
+};
+
+#endif // TRANSPOSITIONTABLE2048_H
@@ -0,0 +1,457 @@
+/**
+ * @file tst_bench2048.cpp
+ * @brief Qt Test benchmarks for the 2048 engine hot path.
+ *
+ * Every benchmark runs one operation over a fixed corpus of boards recorded from self-play games,
+ * repeated until exactly OpsPerIteration operations have been done. The "msecs per iteration"
+ * printed by QTest therefore reads directly as nanoseconds per operation.
+ *
+ * Run headless with QT_QPA_PLATFORM=offscreen ./bench2048, or through make check.
+ */
+#include <QtTest>
+#include "batch2048.h"
+#include "board2048.h"
+#include "gridboard2048.h"
+#include "lineboard2048.h"
+#include "rng2048.h"
+
+namespace {
+
+/**
+ * @brief 4x4 positions recorded from 20 seeded corner-strategy games, ten per game spread evenly
+ * up to the final position, in packed Board2048 form.
+ */
+const uint64_t RecordedBoards[] = {
+    0x0000002001240125ULL, 0x0021102303411236ULL, 0x0012012523422356ULL, 0x0003115104210457ULL,
+    0x1022153112352367ULL, 0x0012201404351348ULL, 0x1041023423561428ULL, 0x0123003115470358ULL,
+    0x2014203121673558ULL, 0x1242235132471378ULL, 0x1000300012101310ULL, 0x0000200301241242ULL,
+    0x0123003302341242ULL, 0x0001000302253452ULL, 0x0113123112353452ULL, 0x1241012323453452ULL,
+    0x0141023432451362ULL, 0x0112035203162462ULL, 0x2241125224162462ULL, 0x2134125324163562ULL,
+    0x0121001201130033ULL, 0x1000000002041345ULL, 0x0012000302341236ULL, 0x0011012100452346ULL,
+    0x0123012312452356ULL, 0x2345124523560100ULL, 0x1300262143702313ULL, 0x1241123064703513ULL,
+    0x0241123526473513ULL, 0x1231234536574513ULL, 0x0000000110131031ULL, 0x0001000201340032ULL,
+    0x0023100202420142ULL, 0x1212123112120253ULL, 0x0023124123123531ULL, 0x0102024124144531ULL,
+    0x1123034234144531ULL, 0x0014123205640132ULL, 0x0214124226415232ULL, 0x1234241256511232ULL,
+    0x0212001200230041ULL, 0x0010002211351341ULL, 0x0002011400362412ULL, 0x0123024202361353ULL,
+    0x0224013101362463ULL, 0x1001002212514574ULL, 0x0011012523514574ULL, 0x1012012623514574ULL,
+    0x1023126434524574ULL, 0x1234236534524574ULL, 0x0100000300241231ULL, 0x0013021210351241ULL,
+    0x2013002402451251ULL, 0x0021001301262461ULL, 0x0122013413462461ULL, 0x0012022534563461ULL,
+    0x0023024513362471ULL, 0x3010120013572471ULL, 0x0234103414573721ULL, 0x1234234514574721ULL,
+    0x0010001200020124ULL, 0x0001002310141234ULL, 0x0001011402240145ULL, 0x0012001301241246ULL,
+    0x0014004112341346ULL, 0x1024002103542156ULL, 0x0214002201251147ULL, 0x0112043400451247ULL,
+    0x2123234134351571ULL, 0x1234235234351571ULL, 0x1000120031012510ULL, 0x0001013102511354ULL,
+    0x1012023215322364ULL, 0x1224123415433464ULL, 0x1133131602633464ULL, 0x0133125613133574ULL,
+    0x0041125612513674ULL, 0x0023046414830125ULL, 0x1010632226833126ULL, 0x2121146526833461ULL,
+    0x1002000300010133ULL, 0x0012000300031125ULL, 0x0112003101341235ULL, 0x0100022301312346ULL,
+    0x0113042402312346ULL, 0x0341142413510136ULL, 0x2421232412613136ULL, 0x0131012623613136ULL,
+    0x1331234623613136ULL, 0x1231235634614136ULL, 0x0002020300230124ULL, 0x0031101200251235ULL,
+    0x0012222313411346ULL, 0x0012125113412456ULL, 0x0000102401541447ULL, 0x1133224103650107ULL,
+    0x0013125102720317ULL, 0x1014025124733417ULL, 0x2141005203734617ULL, 0x1231235234754617ULL,
+    0x0011000200130123ULL, 0x0002001210240234ULL, 0x1002001201241245ULL, 0x0012014305312252ULL,
+    0x1003121515412352ULL, 0x1241131525412452ULL, 0x1221012516412162ULL, 0x0001124526513162ULL,
+    0x1001142337161243ULL, 0x2321123537161243ULL, 0x0000000120130142ULL, 0x0000210030102352ULL,
+    0x0000001200261232ULL, 0x1001002402612412ULL, 0x0002124303610125ULL, 0x0131024313611345ULL,
+    0x0032124323622326ULL, 0x0232114312624526ULL, 0x1231015315621526ULL, 0x1231235334621626ULL,
+    0x0013002300130004ULL, 0x0012102300341235ULL, 0x0001000101332356ULL, 0x0001010223513456ULL,
+    0x0011000200343457ULL, 0x1131001423253457ULL, 0x0012001310461467ULL, 0x1134123123462467ULL,
+    0x1134131335614567ULL, 0x1241235334214682ULL, 0x0010000201220244ULL, 0x0000013521111252ULL,
+    0x0021112412452353ULL, 0x1131134112413563ULL, 0x0143225136311262ULL, 0x0223242124631272ULL,
+    0x1133325215631272ULL, 0x1130145525641472ULL, 0x0113124136241482ULL, 0x1232245336242482ULL,
+    0x0001002101020024ULL, 0x0001000300231025ULL, 0x0101000302342351ULL, 0x0101022102452351ULL,
+    0x0012011301262451ULL, 0x0102023213463451ULL, 0x2142124423563411ULL, 0x1242016113561413ULL,
+    0x2422126633530511ULL, 0x1231234734231262ULL, 0x0012000100021133ULL, 0x0010001400320224ULL,
+    0x0003011412321251ULL, 0x1022003413422351ULL, 0x1013012413241362ULL, 0x1331012412352462ULL,
+    0x0102123113462462ULL, 0x0024123113563462ULL, 0x1223135123563462ULL, 0x1341213213473462ULL,
+    0x0002000101130033ULL, 0x0001101201241234ULL, 0x0012002301321345ULL, 0x0212242412322145ULL,
+    0x0123011434322316ULL, 0x0221012502522416ULL, 0x1133123523522416ULL, 0x0024114523523516ULL,
+    0x1231012624524516ULL, 0x1231234634524516ULL, 0x1212000301230134ULL, 0x0100001302240236ULL,
+    0x0123213212522346ULL, 0x0003010412151147ULL, 0x1423112500160017ULL, 0x1012032601561317ULL,
+    0x1240232123533418ULL, 0x0002101434634518ULL, 0x1123123424634618ULL, 0x1212232134734618ULL,
+    0x0001010302411231ULL, 0x0223001211341352ULL, 0x2002000200352463ULL, 0x0103001435342464ULL,
+    0x1010022211553247ULL, 0x0024013123461057ULL, 0x2140123123463267ULL, 0x0112003403411628ULL,
+    0x1014123513413628ULL, 0x1234214514514628ULL, 0x0112000100010023ULL, 0x0102000001310124ULL,
+    0x1000001402311124ULL, 0x0112002401210035ULL, 0x0123013400310235ULL, 0x1021002431214514ULL,
+    0x2023123431214514ULL, 0x0221124531214514ULL, 0x1221025531214514ULL, 0x2132124631214514ULL
+};
+
+constexpr int CorpusSize = sizeof(RecordedBoards) / sizeof(RecordedBoards[0]);
+constexpr int OpsPerIteration = 1000000;
+constexpr int Passes = OpsPerIteration / CorpusSize;
+
+static_assert(OpsPerIteration % CorpusSize == 0, "the corpus size must divide OpsPerIteration");
+
+} // namespace
+
+/**
+ * @class Bench2048
+ * @brief The Bench2048 class benchmarks moves, merges, game-state checks and spawns.
+ */
+class Bench2048 : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void move_data();
+    void move();
+    void batchMove_data();
+    void batchMove();
+    void mergeRow_data();
+    void mergeRow();
+    void hasAdjacentDuplicates();
+    void checkLose();
+    void spawnTile();
+    void gridMove_data();
+    void gridMove();
+    void lineMove_data();
+    void lineMove();
+
+    void cleanupTestCase();
+
+private:
+    QVector<GridBoard2048> gridCorpus;
+    QVector<LineBoard2048> lineCorpus;
+    uint64_t sink = 0;
+};
+
+/**
+ * @brief Records the boards of every size used by gridMove() and of every shape used by lineMove().
+ */
+void Bench2048::initTestCase()
+{
+    // Larger boards are recorded the same way at startup, from a fixed seed
+    Rng2048 rng(2048);
+    for (int size = GridBoard2048::MinSize; size <= GridBoard2048::MaxSize; ++size) {
+        for (int game = 0; game < 4; ++game) {
+            GridBoard2048 board(size);
+            board.spawnTile(rng);
+            board.spawnTile(rng);
+            for (int step = 0; step < 50 * size * size && !board.checkLose(); ++step) {
+                if (board.move(static_cast<Board2048::Direction>(rng.bounded(4)))) {
+                    board.spawnTile(rng);
+                }
+                if (step % (5 * size * size) == 0) {
+                    gridCorpus.append(board);
+                }
+            }
+        }
+    }
+    for (const LineBoard2048::Shape *shape : { &LineBoard2048::Shape::cube(), &LineBoard2048::Shape::hexagon() }) {
+        for (int game = 0; game < 4; ++game) {
+            LineBoard2048 board(*shape);
+            board.spawnTile(rng);
+            board.spawnTile(rng);
+            for (int step = 0; step < 50 * shape->cellCount() && !board.checkLose(); ++step) {
+                if (board.move(rng.bounded(shape->directionCount()))) {
+                    board.spawnTile(rng);
+                }
+                if (step % (5 * shape->cellCount()) == 0) {
+                    lineCorpus.append(board);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Provides one row per move direction.
+ */
+void Bench2048::move_data()
+{
+    QTest::addColumn<int>("direction");
+    QTest::newRow("up") << static_cast<int>(Board2048::Up);
+    QTest::newRow("down") << static_cast<int>(Board2048::Down);
+    QTest::newRow("left") << static_cast<int>(Board2048::Left);
+    QTest::newRow("right") << static_cast<int>(Board2048::Right);
+}
+
+/**
+ * @brief Benchmarks Board2048::slide(), which moves and merges a whole board in one direction.
+ */
+void Bench2048::move()
+{
+    QFETCH(int, direction);
+    Board2048::Direction d = static_cast<Board2048::Direction>(direction);
+    QBENCHMARK {
+        for (int pass = 0; pass < Passes; ++pass) {
+            for (uint64_t bits : RecordedBoards) {
+                int addedScore = 0;
+                sink += Board2048::slide(bits, d, addedScore) + static_cast<uint64_t>(addedScore);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Provides one row per move direction and batch kernel.
+ */
+void Bench2048::batchMove_data()
+{
+    QTest::addColumn<int>("direction");
+    QTest::addColumn<bool>("vectorized");
+    const char *names[] = { "up", "down", "left", "right" };
+    for (int d = 0; d < 4; ++d) {
+        QTest::addRow("%s/scalar", names[d]) << d << false;
+        QTest::addRow("%s/avx2", names[d]) << d << true;
+    }
+}
+
+/**
+ * @brief Benchmarks Batch2048::move() and Batch2048::moveScalar(), counting one operation per board moved.
+ *
+ * Both kernels are first checked against Board2048::slide() on the whole corpus, board by board,
+ * including the moved and merged masks and the scores.
+ *
+ * The corpus is cut into batches of Batch2048::Width boards, wrapping around at its end, and every
+ * batch is moved in place. A board moved twice the same way no longer slides, so each batch goes
+ * back and forth between the row's direction and the opposite one, and the tiles keep moving.
+ */
+void Bench2048::batchMove()
+{
+    QFETCH(int, direction);
+    QFETCH(bool, vectorized);
+    if (vectorized && !Batch2048::isVectorized()) {
+        QSKIP("the AVX2 kernel is not available on this CPU or compiler");
+    }
+    // Up and Down, Left and Right are paired in Direction order
+    const Board2048::Direction ways[2] = { static_cast<Board2048::Direction>(direction),
+                                           static_cast<Board2048::Direction>(direction ^ 1) };
+    QVector<Batch2048> batches;
+    for (int first = 0; first < CorpusSize; first += Batch2048::Width) {
+        uint64_t boards[Batch2048::Width];
+        for (int b = 0; b < Batch2048::Width; ++b) {
+            boards[b] = RecordedBoards[(first + b) % CorpusSize];
+        }
+        Batch2048 batch;
+        batch.load(boards, Batch2048::Width);
+        batches.append(batch);
+    }
+    const int batchMoves = OpsPerIteration / Batch2048::Width;
+    QCOMPARE(batchMoves * Batch2048::Width, OpsPerIteration);
+
+    // Both kernels must follow the rules of Board2048::slide() on every board of the corpus
+    for (const Batch2048 &batch : batches) {
+        uint64_t before[Batch2048::Width];
+        batch.store(before, Batch2048::Width);
+        for (bool dispatched : { false, true }) {
+            Batch2048 next = batch;
+            Batch2048::MoveResult result;
+            if (dispatched) {
+                next.move(ways[0], result);
+            } else {
+                next.moveScalar(ways[0], result);
+            }
+            uint64_t after[Batch2048::Width];
+            next.store(after, Batch2048::Width);
+            for (int b = 0; b < Batch2048::Width; ++b) {
+                int addedScore = 0;
+                uint64_t expected = Board2048::slide(before[b], ways[0], addedScore);
+                QCOMPARE(static_cast<quint64>(after[b]), static_cast<quint64>(expected));
+                QCOMPARE(((result.moved >> b) & 1) != 0, expected != before[b]);
+                QCOMPARE(((result.merged >> b) & 1) != 0, addedScore != 0);
+                QCOMPARE(result.scores[b], addedScore);
+            }
+        }
+    }
+
+    int way = 0;
+    QBENCHMARK {
+        int index = 0;
+        for (int op = 0; op < batchMoves; ++op) {
+            Batch2048::MoveResult result;
+            if (vectorized) {
+                batches[index].move(ways[way], result);
+            } else {
+                batches[index].moveScalar(ways[way], result);
+            }
+            sink += result.moved + static_cast<uint64_t>(result.scores[op % Batch2048::Width]);
+            if (++index == batches.size()) {
+                index = 0;
+                way ^= 1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Provides one row per row kernel.
+ */
+void Bench2048::mergeRow_data()
+{
+    QTest::addColumn<bool>("vectorized");
+    QTest::newRow("scalar") << false;
+    QTest::newRow("ssse3") << true;
+}
+
+/**
+ * @brief Benchmarks the merge step alone, on the rows of the recorded boards.
+ *
+ * Merging is fused into the move kernels, so this measures GridBoard2048::slideRow() and
+ * GridBoard2048::slideRowScalar(), the generic compact-merge-compact row kernels, on the same rows
+ * the 4x4 tables see.
+ */
+void Bench2048::mergeRow()
+{
+    QFETCH(bool, vectorized);
+    if (vectorized && !GridBoard2048::isVectorized()) {
+        QSKIP("the SSSE3 kernel is not available on this CPU or compiler");
+    }
+    QVector<uint64_t> rows;
+    for (uint64_t bits : RecordedBoards) {
+        GridBoard2048 board{Board2048(bits)};
+        for (int r = 0; r < Board2048::Size; ++r) {
+            rows.append(board.row(r));
+        }
+    }
+    const int rowCount = static_cast<int>(rows.size());
+    const int rowPasses = OpsPerIteration / rowCount;
+    QCOMPARE(rowPasses * rowCount, OpsPerIteration);
+
+    QBENCHMARK {
+        for (int pass = 0; pass < rowPasses; ++pass) {
+            for (uint64_t row : rows) {
+                int addedScore = 0;
+                uint64_t slid = vectorized ? GridBoard2048::slideRow(row, addedScore)
+                                           : GridBoard2048::slideRowScalar(row, addedScore);
+                sink += slid + static_cast<uint64_t>(addedScore);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Benchmarks Board2048::hasAdjacentDuplicates().
+ */
+void Bench2048::hasAdjacentDuplicates()
+{
+    QBENCHMARK {
+        for (int pass = 0; pass < Passes; ++pass) {
+            for (uint64_t bits : RecordedBoards) {
+                sink += Board2048(bits).hasAdjacentDuplicates();
+            }
+        }
+    }
+}
+
+/**
+ * @brief Benchmarks Board2048::checkLose().
+ */
+void Bench2048::checkLose()
+{
+    QBENCHMARK {
+        for (int pass = 0; pass < Passes; ++pass) {
+            for (uint64_t bits : RecordedBoards) {
+                sink += Board2048(bits).checkLose();
+            }
+        }
+    }
+}
+
+/**
+ * @brief Benchmarks Board2048::spawnTile(), the engine behind the game's generateRandomNumber().
+ */
+void Bench2048::spawnTile()
+{
+    Rng2048 rng(1);
+    QBENCHMARK {
+        for (int pass = 0; pass < Passes; ++pass) {
+            for (uint64_t bits : RecordedBoards) {
+                Board2048 board(bits);
+                board.spawnTile(rng);
+                sink += board.bits();
+            }
+        }
+    }
+}
+
+/**
+ * @brief Provides one row per board size.
+ */
+void Bench2048::gridMove_data()
+{
+    QTest::addColumn<int>("size");
+    for (int size = GridBoard2048::MinSize; size <= GridBoard2048::MaxSize; ++size) {
+        QTest::newRow(qPrintable(QString("%1x%1").arg(size))) << size;
+    }
+}
+
+/**
+ * @brief Benchmarks GridBoard2048::move() in all four directions on the boards of one size.
+ */
+void Bench2048::gridMove()
+{
+    QFETCH(int, size);
+    QVector<GridBoard2048> boards;
+    for (const GridBoard2048 &board : gridCorpus) {
+        if (board.size() == size) {
+            boards.append(board);
+        }
+    }
+    QVERIFY(!boards.isEmpty());
+
+    // Cycle through the boards and directions until OpsPerIteration moves have been made
+    QBENCHMARK {
+        int index = 0;
+        for (int op = 0; op < OpsPerIteration; ++op) {
+            GridBoard2048 board = boards[index];
+            int addedScore = 0;
+            sink += board.move(static_cast<Board2048::Direction>(op & 3), &addedScore) + static_cast<uint64_t>(addedScore);
+            if (++index == boards.size()) {
+                index = 0;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Provides one row per LineBoard2048 shape.
+ */
+void Bench2048::lineMove_data()
+{
+    QTest::addColumn<bool>("hexagonal");
+    QTest::newRow("cube") << false;
+    QTest::newRow("hexagon") << true;
+}
+
+/**
+ * @brief Benchmarks LineBoard2048::move() in all six directions on the boards of one shape.
+ */
+void Bench2048::lineMove()
+{
+    QFETCH(bool, hexagonal);
+    QVector<LineBoard2048> boards;
+    for (const LineBoard2048 &board : lineCorpus) {
+        if (board.shape().isHexagonal() == hexagonal) {
+            boards.append(board);
+        }
+    }
+    QVERIFY(!boards.isEmpty());
+
+    QBENCHMARK {
+        int index = 0;
+        int direction = 0;
+        for (int op = 0; op < OpsPerIteration; ++op) {
+            LineBoard2048 board = boards[index];
+            int addedScore = 0;
+            sink += board.move(direction, &addedScore) + static_cast<uint64_t>(addedScore);
+            if (++direction == LineBoard2048::MaxDirections) {
+                direction = 0;
+            }
+            if (++index == boards.size()) {
+                index = 0;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Keeps the benchmark results alive so that the compiler cannot drop the measured code.
+ */
+void Bench2048::cleanupTestCase()
+{
+    QVERIFY(sink != 0);
+}
+
+QTEST_APPLESS_MAIN(Bench2048)
+
+#include "tst_bench2048.moc"
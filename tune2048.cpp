@@ -0,0 +1,553 @@
+/**
+ * @file tune2048.cpp
+ * @brief Command-line CMA-ES tuner for the weights of the 2048 AI heuristic.
+ *
+ * Searches the weights of Heuristic2048 with the covariance matrix adaptation evolution strategy
+ * (CMA-ES). Every generation samples a population of weight vectors around the current mean, plays
+ * the same seeded games with each of them on all cores and moves the mean and the shape of the
+ * sampling distribution towards the vectors that scored best. The mean itself is played on the
+ * same games too, and the best mean so far is written to the weights file that the game loads for
+ * its hints and autoplay.
+ *
+ * The whole state of the search is saved to a checkpoint after every generation, and --resume
+ * continues from it with the settings it was started with. Each generation draws from a random
+ * stream of its own, so a resumed run goes on exactly as if it had never stopped.
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include <QtConcurrent>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "board2048.h"
+#include "expectimax2048.h"
+#include "greedy2048.h"
+#include "heuristic2048.h"
+#include "rng2048.h"
+
+namespace {
+
+const char Magic[8] = { 'C', 'M', 'A', 'E', '2', '0', '4', '8' };
+const uint32_t FileVersion = 1;
+
+/**
+ * @brief A weight searched by the tuner.
+ *
+ * The search runs on offsets from the default weights in units of scale, so that every coordinate
+ * starts at 0 and one step of the initial sigma means about the same for each of them.
+ */
+struct TunedWeight {
+    const char *name;
+    float Heuristic2048::Weights::*member;
+    float scale;
+    float minimum;
+};
+
+const TunedWeight TunedWeights[] = {
+    { "MonotonicityPower", &Heuristic2048::Weights::monotonicityPower, 1.0f, 1.0f },
+    { "MonotonicityWeight", &Heuristic2048::Weights::monotonicityWeight, 20.0f, 0.0f },
+    { "SumPower", &Heuristic2048::Weights::sumPower, 1.0f, 1.0f },
+    { "SumWeight", &Heuristic2048::Weights::sumWeight, 5.0f, 0.0f },
+    { "MergesWeight", &Heuristic2048::Weights::mergesWeight, 300.0f, 0.0f },
+    { "EmptyWeight", &Heuristic2048::Weights::emptyWeight, 120.0f, 0.0f },
+    { "CornerWeight", &Heuristic2048::Weights::cornerWeight, 20.0f, std::numeric_limits<float>::lowest() },
+};
+
+constexpr int Dimension = sizeof(TunedWeights) / sizeof(TunedWeights[0]);
+
+/**
+ * @brief State of the search, saved as is to the checkpoint file.
+ */
+struct Checkpoint {
+    char magic[8];                             ///< "CMAE2048".
+    uint32_t version;                          ///< Format version, currently 1.
+    uint32_t dimension;                        ///< Number of tuned weights.
+    uint32_t population;                       ///< Candidates per generation.
+    uint32_t depth;                            ///< Search depth of the games.
+    uint64_t seed;                             ///< Base seed of the run.
+    uint64_t games;                            ///< Games per candidate.
+    uint64_t generation;                       ///< Generations finished.
+    double sigma;                              ///< Step size.
+    double mean[Dimension];                    ///< Mean of the sampling distribution.
+    double covariance[Dimension][Dimension];   ///< Shape of the sampling distribution.
+    double pathC[Dimension];                   ///< Evolution path of the covariance.
+    double pathSigma[Dimension];               ///< Evolution path of the step size.
+    double bestScore;                          ///< Best mean score of the distribution mean, or -1.
+    double best[Dimension];                    ///< Mean that scored it.
+};
+
+/**
+ * @brief Constants of the CMA-ES update, derived from the dimension and the population.
+ */
+struct Strategy {
+    int mu;                  ///< Number of candidates the mean is moved towards.
+    QVector<double> weights; ///< Recombination weight of the mu best candidates.
+    double muEff;            ///< Variance-effective selection mass.
+    double cc;               ///< Learning rate of the covariance path.
+    double cs;               ///< Learning rate of the step-size path.
+    double c1;               ///< Learning rate of the rank-one update.
+    double cmu;              ///< Learning rate of the rank-mu update.
+    double damps;            ///< Damping of the step size.
+    double chiN;             ///< Expected length of a standard normal vector.
+
+    explicit Strategy(int population)
+    {
+        const double n = Dimension;
+        mu = population / 2;
+        double sum = 0.0;
+        double squares = 0.0;
+        for (int i = 0; i < mu; ++i) {
+            weights.append(std::log(mu + 0.5) - std::log(i + 1.0));
+            sum += weights[i];
+        }
+        for (double &w : weights) {
+            w /= sum;
+            squares += w * w;
+        }
+        muEff = 1.0 / squares;
+        cc = (4.0 + muEff / n) / (n + 4.0 + 2.0 * muEff / n);
+        cs = (muEff + 2.0) / (n + muEff + 5.0);
+        c1 = 2.0 / ((n + 1.3) * (n + 1.3) + muEff);
+        cmu = std::min(1.0 - c1, 2.0 * (muEff - 2.0 + 1.0 / muEff) / ((n + 2.0) * (n + 2.0) + muEff));
+        damps = 1.0 + 2.0 * std::max(0.0, std::sqrt((muEff - 1.0) / (n + 1.0)) - 1.0) + cs;
+        chiN = std::sqrt(n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+    }
+};
+
+/**
+ * @brief One playing thread: its own search, used from depth 2 up.
+ */
+struct TuneWorker {
+    Expectimax2048 *search = nullptr;    ///< Owned by main(), null at depth 1.
+};
+
+} // namespace
+
+/**
+ * @brief Turns a point of the search space into heuristic weights.
+ * @param x The offsets from the default weights, in units of each weight's scale.
+ * @return The weights.
+ */
+static Heuristic2048::Weights weightsAt(const double x[Dimension])
+{
+    Heuristic2048::Weights weights;
+    for (int i = 0; i < Dimension; ++i) {
+        const TunedWeight &tuned = TunedWeights[i];
+        float value = weights.*tuned.member + static_cast<float>(x[i]) * tuned.scale;
+        weights.*tuned.member = std::max(value, tuned.minimum);
+    }
+    return weights;
+}
+
+/**
+ * @brief Computes the eigenvectors and eigenvalues of the covariance with Jacobi rotations.
+ * @param covariance The symmetric matrix.
+ * @param vectors Receives the eigenvectors, one per column.
+ * @param values Receives the eigenvalues.
+ */
+static void eigenDecompose(const double covariance[Dimension][Dimension], double vectors[Dimension][Dimension],
+                           double values[Dimension])
+{
+    double a[Dimension][Dimension];
+    std::memcpy(a, covariance, sizeof(a));
+    for (int i = 0; i < Dimension; ++i) {
+        for (int j = 0; j < Dimension; ++j) {
+            vectors[i][j] = i == j ? 1.0 : 0.0;
+        }
+    }
+
+    for (int sweep = 0; sweep < 64; ++sweep) {
+        double off = 0.0;
+        for (int p = 0; p < Dimension; ++p) {
+            for (int q = p + 1; q < Dimension; ++q) {
+                off += a[p][q] * a[p][q];
+            }
+        }
+        if (off < 1e-30) {
+            break;
+        }
+        for (int p = 0; p < Dimension; ++p) {
+            for (int q = p + 1; q < Dimension; ++q) {
+                if (a[p][q] == 0.0) {
+                    continue;
+                }
+                // Rotate rows and columns p and q so that a[p][q] becomes 0
+                double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+                double c = 1.0 / std::sqrt(t * t + 1.0);
+                double s = t * c;
+                for (int k = 0; k < Dimension; ++k) {
+                    double akp = a[k][p];
+                    double akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < Dimension; ++k) {
+                    double apk = a[p][k];
+                    double aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < Dimension; ++k) {
+                    double vkp = vectors[k][p];
+                    double vkq = vectors[k][q];
+                    vectors[k][p] = c * vkp - s * vkq;
+                    vectors[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < Dimension; ++i) {
+        values[i] = std::max(a[i][i], 1e-20);
+    }
+}
+
+/**
+ * @brief Draws a standard normal number.
+ * @param rng The random generator.
+ * @return The number.
+ */
+static double normal(Rng2048 &rng)
+{
+    // Box-Muller on two uniform numbers in (0, 1]
+    double u = ((rng.next() >> 11) + 1) * (1.0 / 9007199254740992.0);
+    double v = (rng.next() >> 11) * (1.0 / 9007199254740992.0);
+    return std::sqrt(-2.0 * std::log(u)) * std::cos(6.283185307179586 * v);
+}
+
+/**
+ * @brief Plays one game with a heuristic.
+ * @param heuristic The heuristic.
+ * @param worker The playing thread; its search is used from depth 2 up.
+ * @param seed The seed of the game.
+ * @return The final score.
+ */
+static int playGame(const Heuristic2048 &heuristic, TuneWorker &worker, uint64_t seed)
+{
+    Rng2048 rng(seed);
+    Board2048 board;
+    board.spawnTile(rng);
+    board.spawnTile(rng);
+    int score = 0;
+    while (true) {
+        Board2048::Direction direction = Board2048::Up;
+        bool found = false;
+        if (worker.search != nullptr) {
+            found = worker.search->bestMove(board, direction);
+        } else {
+            Greedy2048::Move move;
+            found = Greedy2048::choose(board.bits(), move, nullptr, heuristic);
+            direction = move.direction;
+        }
+        if (!found) {
+            return score;
+        }
+        int addedScore = 0;
+        board.move(direction, &addedScore);
+        score += addedScore;
+        board.spawnTile(rng);
+    }
+}
+
+/**
+ * @brief Plays the games of a generation with every candidate, spread over the workers.
+ * @param pool The thread pool.
+ * @param workers The playing threads.
+ * @param candidates The heuristics to play with.
+ * @param games The number of games per candidate.
+ * @param firstSeed The seed of the first game; each candidate plays the same games.
+ * @return The mean score of each candidate.
+ */
+static QVector<double> playGeneration(QThreadPool &pool, QVector<TuneWorker> &workers,
+                                      const QVector<Heuristic2048> &candidates, qint64 games, uint64_t firstSeed)
+{
+    const qint64 total = games * candidates.size();
+    QVector<int> results(total);
+    std::atomic<qint64> nextGame{ 0 };
+    QtConcurrent::blockingMap(&pool, workers, [&](TuneWorker &worker) {
+        // Workers take games one at a time, so a slow candidate does not hold up the others
+        for (qint64 task = nextGame.fetch_add(1); task < total; task = nextGame.fetch_add(1)) {
+            const Heuristic2048 &heuristic = candidates[static_cast<int>(task / games)];
+            if (worker.search != nullptr) {
+                worker.search->setHeuristic(&heuristic);
+            }
+            results[task] = playGame(heuristic, worker, firstSeed + static_cast<uint64_t>(task % games));
+        }
+    });
+    QVector<double> means(candidates.size(), 0.0);
+    for (qint64 task = 0; task < total; ++task) {
+        means[static_cast<int>(task / games)] += results[task];
+    }
+    for (double &mean : means) {
+        mean /= games;
+    }
+    return means;
+}
+
+/**
+ * @brief Writes the checkpoint, replacing the old one only once the new one is complete.
+ * @param path The checkpoint file.
+ * @param state The state of the search.
+ * @return True on success, false otherwise.
+ */
+static bool saveCheckpoint(const QString &path, const Checkpoint &state)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    if (file.write(reinterpret_cast<const char *>(&state), sizeof(state)) != sizeof(state)) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+/**
+ * @brief Reads a checkpoint written by saveCheckpoint().
+ * @param path The checkpoint file.
+ * @param state Receives the state of the search.
+ * @return True if the file holds a checkpoint of this tuner, false otherwise.
+ */
+static bool loadCheckpoint(const QString &path, Checkpoint &state)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() != sizeof(state)
+        || file.read(reinterpret_cast<char *>(&state), sizeof(state)) != sizeof(state)) {
+        return false;
+    }
+    return std::memcmp(state.magic, Magic, sizeof(Magic)) == 0 && state.version == FileVersion
+           && state.dimension == Dimension;
+}
+
+/**
+ * @brief Moves the distribution towards the best candidates of a generation.
+ * @param state The state of the search.
+ * @param strategy The update constants.
+ * @param samples The candidates, as points of the search space.
+ * @param scores The mean score of each candidate.
+ */
+static void update(Checkpoint &state, const Strategy &strategy, const QVector<QVector<double>> &samples,
+                   const QVector<double> &scores)
+{
+    const int population = static_cast<int>(samples.size());
+    QVector<int> ranking(population);
+    for (int i = 0; i < population; ++i) {
+        ranking[i] = i;
+    }
+    std::stable_sort(ranking.begin(), ranking.end(), [&scores](int a, int b) { return scores[a] > scores[b]; });
+
+    double oldMean[Dimension];
+    std::memcpy(oldMean, state.mean, sizeof(oldMean));
+    double step[Dimension] = {};
+    for (int k = 0; k < strategy.mu; ++k) {
+        for (int i = 0; i < Dimension; ++i) {
+            step[i] += strategy.weights[k] * (samples[ranking[k]][i] - oldMean[i]) / state.sigma;
+        }
+    }
+    for (int i = 0; i < Dimension; ++i) {
+        state.mean[i] = oldMean[i] + state.sigma * step[i];
+    }
+
+    // Step-size path, in the coordinates where the distribution is round: B D^-1 B^T step
+    double vectors[Dimension][Dimension];
+    double values[Dimension];
+    eigenDecompose(state.covariance, vectors, values);
+    double rotated[Dimension] = {};
+    for (int j = 0; j < Dimension; ++j) {
+        double dot = 0.0;
+        for (int i = 0; i < Dimension; ++i) {
+            dot += vectors[i][j] * step[i];
+        }
+        dot /= std::sqrt(values[j]);
+        for (int i = 0; i < Dimension; ++i) {
+            rotated[i] += vectors[i][j] * dot;
+        }
+    }
+    double pathLength = 0.0;
+    for (int i = 0; i < Dimension; ++i) {
+        state.pathSigma[i] = (1.0 - strategy.cs) * state.pathSigma[i]
+                             + std::sqrt(strategy.cs * (2.0 - strategy.cs) * strategy.muEff) * rotated[i];
+        pathLength += state.pathSigma[i] * state.pathSigma[i];
+    }
+    pathLength = std::sqrt(pathLength);
+
+    // Stall the covariance path while the step size is still growing fast
+    double generations = static_cast<double>(state.generation + 1);
+    bool stalled = pathLength / std::sqrt(1.0 - std::pow(1.0 - strategy.cs, 2.0 * generations)) / strategy.chiN
+                   >= 1.4 + 2.0 / (Dimension + 1.0);
+    double hsig = stalled ? 0.0 : 1.0;
+    for (int i = 0; i < Dimension; ++i) {
+        state.pathC[i] = (1.0 - strategy.cc) * state.pathC[i]
+                         + hsig * std::sqrt(strategy.cc * (2.0 - strategy.cc) * strategy.muEff) * step[i];
+    }
+
+    double keep = 1.0 - strategy.c1 - strategy.cmu + (1.0 - hsig) * strategy.c1 * strategy.cc * (2.0 - strategy.cc);
+    for (int i = 0; i < Dimension; ++i) {
+        for (int j = 0; j < Dimension; ++j) {
+            double rankMu = 0.0;
+            for (int k = 0; k < strategy.mu; ++k) {
+                const QVector<double> &x = samples[ranking[k]];
+                rankMu += strategy.weights[k] * (x[i] - oldMean[i]) * (x[j] - oldMean[j]);
+            }
+            state.covariance[i][j] = keep * state.covariance[i][j]
+                                     + strategy.c1 * state.pathC[i] * state.pathC[j]
+                                     + strategy.cmu * rankMu / (state.sigma * state.sigma);
+        }
+    }
+    state.sigma *= std::exp((strategy.cs / strategy.damps) * (pathLength / strategy.chiN - 1.0));
+    ++state.generation;
+}
+
+/**
+ * @brief Main function.
+ * @param argc Number of command line arguments.
+ * @param argv Array of command line arguments.
+ * @return Exit status.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("tune2048");
+
+    const int defaultPopulation = 4 + static_cast<int>(3.0 * std::log(static_cast<double>(Dimension)));
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Tunes the weights of the 2048 AI heuristic with CMA-ES and writes them for the game.");
+    parser.addHelpOption();
+    parser.addOption({ "generations", "Number of generations to reach.", "count", "100" });
+    parser.addOption({ "population", "Candidates per generation.", "count", QString::number(defaultPopulation) });
+    parser.addOption({ "games", "Games played by each candidate.", "count", "200" });
+    parser.addOption({ "depth", "Search depth of the games; 1 plays the greedy one-move policy.", "depth", "1" });
+    parser.addOption({ "sigma", "Initial step size, in units of each weight's scale.", "sigma", "0.5" });
+    parser.addOption({ "threads", "Number of worker threads.", "threads", QString::number(QThread::idealThreadCount()) });
+    parser.addOption({ "seed", "Base seed of the games and samples.", "seed", "2048" });
+    parser.addOption({ "output", "Weights file to write.", "file", "heuristic2048.weights" });
+    parser.addOption({ "checkpoint", "Checkpoint file, written after every generation.", "file", "tune2048.checkpoint" });
+    parser.addOption({ "resume", "Continue from the checkpoint file with the settings it was started with." });
+    parser.process(app);
+
+    qint64 generations = parser.value("generations").toLongLong();
+    int threads = qMax(1, parser.value("threads").toInt());
+    QString output = parser.value("output");
+    QString checkpointPath = parser.value("checkpoint");
+
+    QTextStream out(stdout);
+    Checkpoint state;
+    if (parser.isSet("resume")) {
+        if (!loadCheckpoint(checkpointPath, state)) {
+            out << "cannot resume from " << checkpointPath << "\n";
+            return 1;
+        }
+    } else {
+        std::memset(&state, 0, sizeof(state));
+        std::memcpy(state.magic, Magic, sizeof(Magic));
+        state.version = FileVersion;
+        state.dimension = Dimension;
+        state.population = parser.value("population").toUInt();
+        state.depth = parser.value("depth").toUInt();
+        state.seed = parser.value("seed").toULongLong();
+        state.games = parser.value("games").toULongLong();
+        state.sigma = parser.value("sigma").toDouble();
+        for (int i = 0; i < Dimension; ++i) {
+            state.covariance[i][i] = 1.0;
+        }
+        state.bestScore = -1.0;
+    }
+    if (generations <= 0 || state.population < 4 || state.depth < 1 || state.depth > 8 || state.games == 0
+        || !(state.sigma > 0.0)) {
+        parser.showHelp(1);
+    }
+
+    const int population = static_cast<int>(state.population);
+    const qint64 games = static_cast<qint64>(state.games);
+    Strategy strategy(population);
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    QVector<TuneWorker> workers(threads);
+    std::vector<std::unique_ptr<Expectimax2048>> searches;
+    if (state.depth > 1) {
+        for (TuneWorker &worker : workers) {
+            searches.push_back(std::make_unique<Expectimax2048>(static_cast<int>(state.depth), 1));
+            worker.search = searches.back().get();
+        }
+    }
+
+    out << "generation " << state.generation << " of " << generations << ", " << population << " candidates x " << games
+        << " games, depth " << state.depth << ", " << threads << " threads, seed " << state.seed << "\n";
+    out << "generation      sigma   best candidate   mean weights   best mean    seconds\n";
+    out.flush();
+
+    while (state.generation < static_cast<uint64_t>(generations)) {
+        QElapsedTimer timer;
+        timer.start();
+
+        // x = mean + sigma * B D z for every candidate, with z standard normal
+        double vectors[Dimension][Dimension];
+        double values[Dimension];
+        eigenDecompose(state.covariance, vectors, values);
+        Rng2048 rng(state.seed ^ (0x9E3779B97F4A7C15ULL * (state.generation + 1)));
+        QVector<QVector<double>> samples(population, QVector<double>(Dimension));
+        QVector<Heuristic2048> candidates;
+        candidates.reserve(population + 1);
+        for (QVector<double> &x : samples) {
+            double z[Dimension];
+            for (double &value : z) {
+                value = normal(rng);
+            }
+            for (int i = 0; i < Dimension; ++i) {
+                double y = 0.0;
+                for (int j = 0; j < Dimension; ++j) {
+                    y += vectors[i][j] * std::sqrt(values[j]) * z[j];
+                }
+                x[i] = state.mean[i] + state.sigma * y;
+            }
+            candidates.append(Heuristic2048(weightsAt(x.constData())));
+        }
+        // The mean plays the same games, to tell whether the distribution itself got better
+        candidates.append(Heuristic2048(weightsAt(state.mean)));
+
+        uint64_t firstSeed = state.seed + state.generation * state.games;
+        QVector<double> scores = playGeneration(pool, workers, candidates, games, firstSeed);
+        double meanScore = scores.takeLast();
+        if (meanScore > state.bestScore) {
+            state.bestScore = meanScore;
+            std::memcpy(state.best, state.mean, sizeof(state.best));
+            if (!Heuristic2048::saveWeights(output, weightsAt(state.best))) {
+                out << "cannot write " << output << "\n";
+                return 1;
+            }
+        }
+        update(state, strategy, samples, scores);
+        if (!saveCheckpoint(checkpointPath, state)) {
+            out << "cannot write " << checkpointPath << "\n";
+            return 1;
+        }
+
+        out << QString("%1 %2 %3 %4 %5 %6\n")
+                   .arg(state.generation, 10)
+                   .arg(state.sigma, 10, 'f', 4)
+                   .arg(*std::max_element(scores.begin(), scores.end()), 16, 'f', 1)
+                   .arg(meanScore, 14, 'f', 1)
+                   .arg(state.bestScore, 11, 'f', 1)
+                   .arg(timer.nsecsElapsed() / 1e9, 10, 'f', 1);
+        out.flush();
+    }
+
+    Heuristic2048::Weights best = weightsAt(state.best);
+    out << "best weights (" << output << "):\n";
+    for (const TunedWeight &tuned : TunedWeights) {
+        out << "  " << tuned.name << " = " << best.*tuned.member << "\n";
+    }
+    return 0;
+}
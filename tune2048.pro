@@ -0,0 +1,26 @@
+# Command-line CMA-ES tuner for the weights of the 2048 AI heuristic.
+
+QT = core concurrent
+
+CONFIG += c++20 console
+CONFIG -= app_bundle
+
+TARGET = tune2048
+
+HEADERS += \
+    board2048.h \
+    rng2048.h \
+    expectimax2048.h \
+    heuristic2048.h \
+    greedy2048.h \
+    ntuple2048.h \
+    transpositiontable2048.h
+
+SOURCES += \
+    tune2048.cpp \
+    board2048.cpp \
+    expectimax2048.cpp \
+    heuristic2048.cpp \
+    greedy2048.cpp \
+    ntuple2048.cpp \
+    transpositiontable2048.cpp
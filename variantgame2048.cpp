@@ -0,0 +1,188 @@
+/**
+ * @file variantgame2048.cpp
+ * @brief Implementation of the VariantGame2048 window.
+ */
+#include "variantgame2048.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <QRandomGenerator>
+#include <QtMath>
+
+namespace {
+
+const QColor BackgroundColor(0xBB, 0xAD, 0xA0);
+const QColor TileColor(0xD4, 0x99, 0x87);
+const QColor TextColor(0x8E, 0x75, 0x3D);
+
+} // namespace
+
+/**
+ * @brief Constructs the window and starts a game.
+ * @param shape The shape of the board.
+ * @param parent The parent widget.
+ */
+VariantGame2048::VariantGame2048(const LineBoard2048::Shape &shape, QWidget *parent)
+    : QWidget(parent), board(shape), rng(QRandomGenerator::global()->generate64())
+{
+    setWindowFlag(Qt::Window);
+    setWindowTitle(shape.isHexagonal() ? "2048 Hexagon" : "2048 Cube");
+    setFocusPolicy(Qt::StrongFocus);
+    newGame();
+}
+
+/**
+ * @brief Returns the preferred size, with larger cells for the hexagon.
+ * @return The size hint.
+ */
+QSize VariantGame2048::sizeHint() const
+{
+    const int cell = board.shape().isHexagonal() ? 96 : 56;
+    return QSize(static_cast<int>(board.shape().width() * cell) + 16,
+                 static_cast<int>(board.shape().height() * cell) + HeaderHeight + 16);
+}
+
+/**
+ * @brief Plays the move of a direction key, or starts a new game on N.
+ * @param event The key event.
+ */
+void VariantGame2048::keyPressEvent(QKeyEvent *event)
+{
+    if (event->key() == Qt::Key_N) {
+        newGame();
+        return;
+    }
+    int direction = 0;
+    if (!directionForKey(event->key(), direction)) {
+        QWidget::keyPressEvent(event);
+        return;
+    }
+    if (lost) {
+        return;
+    }
+
+    int addedScore = 0;
+    if (board.move(direction, &addedScore)) {
+        score += addedScore;
+        board.spawnTile(rng);
+        won = won || board.checkWin();
+        lost = board.checkLose();
+        update();
+    }
+}
+
+/**
+ * @brief Paints the score line and every cell of the board.
+ * @param event The paint event.
+ */
+void VariantGame2048::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    const LineBoard2048::Shape &shape = board.shape();
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.fillRect(rect(), BackgroundColor);
+
+    QString status = QString("Score: %1").arg(score);
+    if (lost) {
+        status += "   Game over! Press N for a new game";
+    } else if (won) {
+        status += "   You reached 2048!";
+    }
+    painter.setPen(Qt::white);
+    painter.drawText(QRect(8, 0, width() - 16, HeaderHeight), Qt::AlignLeft | Qt::AlignVCenter, status);
+
+    // Fit the layout in the space below the score line, centered
+    qreal cell = qMin((width() - 16) / shape.width(), (height() - HeaderHeight - 16) / shape.height());
+    QPointF origin((width() - cell * shape.width()) / 2.0,
+                   HeaderHeight + (height() - HeaderHeight - cell * shape.height()) / 2.0);
+
+    QPainterPath tilePath;
+    if (shape.isHexagonal()) {
+        qreal radius = cell * 0.48;
+        for (int corner = 0; corner < 6; ++corner) {
+            QPointF vertex(radius * qCos(corner * M_PI / 3.0), radius * qSin(corner * M_PI / 3.0));
+            if (corner == 0) {
+                tilePath.moveTo(vertex);
+            } else {
+                tilePath.lineTo(vertex);
+            }
+        }
+        tilePath.closeSubpath();
+    } else {
+        qreal half = cell * 0.45;
+        tilePath.addRoundedRect(QRectF(-half, -half, 2 * half, 2 * half), cell / 12.0, cell / 12.0);
+    }
+
+    QFont font = this->font();
+    font.setBold(true);
+    for (int i = 0; i < shape.cellCount(); ++i) {
+        QPointF center = origin + QPointF(shape.cellX(i), shape.cellY(i)) * cell;
+        int exponent = board.exponent(i);
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(exponent > 0 ? TileColor : TileColor.lighter(125));
+        painter.drawPath(tilePath.translated(center));
+        if (exponent > 0) {
+            QString text = QString::number(1 << exponent);
+            font.setPixelSize(qMax(1, static_cast<int>(cell * (text.size() <= 2 ? 0.4 : 1.0 / text.size()))));
+            painter.setFont(font);
+            painter.setPen(TextColor);
+            painter.drawText(QRectF(center.x() - cell / 2, center.y() - cell / 2, cell, cell), Qt::AlignCenter, text);
+        }
+    }
+}
+
+/**
+ * @brief Starts a new game with two tiles.
+ */
+void VariantGame2048::newGame()
+{
+    board.clear();
+    board.spawnTile(rng);
+    board.spawnTile(rng);
+    score = 0;
+    won = false;
+    lost = false;
+    update();
+}
+
+/**
+ * @brief Maps a key to the direction it plays on this shape.
+ * @param key The Qt key code.
+ * @param direction Receives the direction.
+ * @return True if the key plays a move, false otherwise.
+ */
+bool VariantGame2048::directionForKey(int key, int &direction) const
+{
+    // Cube: Up, Down, Left, Right, Front, Back. Hexagon: Up, Down, Up-Left, Down-Right, Up-Right, Down-Left.
+    bool hexagonal = board.shape().isHexagonal();
+    switch (key) {
+    case Qt::Key_W:
+    case Qt::Key_Up:
+        direction = 0;
+        return true;
+    case Qt::Key_S:
+    case Qt::Key_Down:
+        direction = 1;
+        return true;
+    case Qt::Key_Q:
+        direction = hexagonal ? 2 : 4;
+        return true;
+    case Qt::Key_E:
+        direction = hexagonal ? 4 : 5;
+        return true;
+    case Qt::Key_A:
+        direction = hexagonal ? 5 : 2;
+        return true;
+    case Qt::Key_D:
+        direction = 3;
+        return true;
+    case Qt::Key_Left:
+        direction = 2;
+        return !hexagonal;
+    case Qt::Key_Right:
+        direction = 3;
+        return !hexagonal;
+    default:
+        return false;
+    }
+}
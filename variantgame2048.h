@@ -0,0 +1,68 @@
+/**
+ * @file variantgame2048.h
+ * @brief Declares the VariantGame2048 class, a window playing 2048 on a cube or a hexagon.
+ */
+#ifndef VARIANTGAME2048_H
+#define VARIANTGAME2048_H
+
+#include <QWidget>
+#include <QKeyEvent>
+#include "lineboard2048.h"
+#include "rng2048.h"
+
+/**
+ * @class VariantGame2048
+ * @brief The VariantGame2048 class plays a game of 2048 on any LineBoard2048 shape.
+ *
+ * The cells are painted at the positions given by the shape, as squares or as hexagons. The six
+ * directions of both shapes are played with the keys Q, W, E, A, S and D; the arrow keys also
+ * move within the layers of the cube. N starts a new game.
+ */
+class VariantGame2048 : public QWidget {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs the window and starts a game.
+     * @param shape The shape of the board; it must outlive the window.
+     * @param parent The parent widget.
+     */
+    explicit VariantGame2048(const LineBoard2048::Shape &shape, QWidget *parent = nullptr);
+
+    QSize sizeHint() const override;
+
+protected:
+    /**
+     * @brief Plays the move of a direction key, or starts a new game on N.
+     * @param event The key event.
+     */
+    void keyPressEvent(QKeyEvent *event) override;
+    /**
+     * @brief Paints the score line and every cell of the board.
+     * @param event The paint event.
+     */
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    static constexpr int HeaderHeight = 32;    ///< Height of the score line, in pixels.
+
+    /**
+     * @brief Starts a new game with two tiles.
+     */
+    void newGame();
+    /**
+     * @brief Maps a key to the direction it plays on this shape.
+     * @param key The Qt key code.
+     * @param direction Receives the direction.
+     * @return True if the key plays a move, false otherwise.
+     */
+    bool directionForKey(int key, int &direction) const;
+
+    LineBoard2048 board;
+    Rng2048 rng;
+    int score = 0;
+    bool won = false;
+    bool lost = false;
+};
+
+#endif // VARIANTGAME2048_H
@@ -0,0 +1,234 @@
+/**
+ * @file winestimator2048.cpp
+ * @brief Implementation of the WinEstimator2048 Monte Carlo estimator.
+ */
+#include "winestimator2048.h"
+#include "greedy2048.h"
+#include <QThread>
+#include <bit>
+
+namespace {
+
+const uint64_t RngSeed = 0x2048;    ///< Base seed of the worker streams.
+
+} // namespace
+
+/**
+ * @brief Constructs an idle estimator and starts its workers.
+ * @param threads The number of worker threads, or 0 for one per core.
+ */
+WinEstimator2048::WinEstimator2048(int threads)
+    : workerCount(threads > 0 ? threads : QThread::idealThreadCount())
+{
+    for (std::atomic<uint64_t> &counter : counters) {
+        counter.store(tag(0), std::memory_order_relaxed);
+    }
+    pool.setMaxThreadCount(workerCount);
+    // The rollouts never end on their own, so let the GUI thread and the AI search preempt them
+    pool.setThreadPriority(QThread::LowPriority);
+    for (int worker = 0; worker < workerCount; ++worker) {
+        pool.start([this, worker]() { work(worker); });
+    }
+}
+
+/**
+ * @brief Stops and joins the workers.
+ */
+WinEstimator2048::~WinEstimator2048()
+{
+    quitting.store(true, std::memory_order_relaxed);
+    generation.fetch_add(1, std::memory_order_release);
+    wake.release(workerCount);
+    pool.waitForDone();
+}
+
+/**
+ * @brief Makes the rollouts pick moves with a trained network instead of the static heuristic.
+ * @param evaluator The network, or nullptr for the heuristic.
+ */
+void WinEstimator2048::setEvaluator(const NTuple2048 *evaluator)
+{
+    network = evaluator != nullptr && evaluator->isLoaded() ? evaluator : nullptr;
+}
+
+/**
+ * @brief Drops the counts and starts estimating a new position.
+ * @param board The position, with the player to move.
+ */
+void WinEstimator2048::start(const Board2048 &board)
+{
+    // A worker reads the generation before the position, so it never plays a position older than
+    // the generation it counts for
+    uint32_t next = generation.load(std::memory_order_relaxed) + 1;
+    position.store(board.bits(), std::memory_order_relaxed);
+    active.store(true, std::memory_order_relaxed);
+    for (std::atomic<uint64_t> &counter : counters) {
+        counter.store(tag(next), std::memory_order_relaxed);
+    }
+    generation.store(next, std::memory_order_release);
+    wake.release(workerCount);
+}
+
+/**
+ * @brief Drops the counts and lets the workers sleep.
+ */
+void WinEstimator2048::stop()
+{
+    uint32_t next = generation.load(std::memory_order_relaxed) + 1;
+    active.store(false, std::memory_order_relaxed);
+    for (std::atomic<uint64_t> &counter : counters) {
+        counter.store(tag(next), std::memory_order_relaxed);
+    }
+    generation.store(next, std::memory_order_release);
+}
+
+/**
+ * @brief Lets the workers sleep, keeping the counts, or wakes them again.
+ * @param pause True to pause the rollouts, false to resume them.
+ */
+void WinEstimator2048::setPaused(bool pause)
+{
+    if (paused.exchange(pause, std::memory_order_relaxed) && !pause) {
+        wake.release(workerCount);
+    }
+}
+
+/**
+ * @brief Returns the counts gathered so far for the current position.
+ * @return The counts, all 0 while stopped.
+ */
+WinEstimator2048::Estimate WinEstimator2048::estimate() const
+{
+    Estimate counts;
+    if (!read(generation.load(std::memory_order_acquire), counts)) {
+        return Estimate();
+    }
+    return counts;
+}
+
+/**
+ * @brief Runs rollouts whenever there is a position to estimate, until the estimator is destroyed.
+ * @param worker The index of the worker.
+ */
+void WinEstimator2048::work(int worker)
+{
+    Rng2048 rng = Rng2048::stream(RngSeed, worker);
+
+    while (true) {
+        wake.acquire();
+        while (!quitting.load(std::memory_order_relaxed)) {
+            uint32_t current = generation.load(std::memory_order_acquire);
+            Estimate counts;
+            if (!active.load(std::memory_order_relaxed) || paused.load(std::memory_order_relaxed) || !read(current, counts)
+                || counts.rollouts >= MaxRollouts) {
+                break;
+            }
+            uint64_t bits = position.load(std::memory_order_relaxed);
+
+            Estimate batch;
+            bool finished = true;
+            for (int i = 0; i < BatchSize && finished; ++i) {
+                bool reached[TargetCount];
+                finished = rollout(bits, current, rng, reached);
+                if (finished) {
+                    ++batch.rollouts;
+                    for (int t = 0; t < TargetCount; ++t) {
+                        batch.reached[t] += reached[t] ? 1 : 0;
+                    }
+                }
+            }
+            if (finished) {
+                publish(current, batch);
+            }
+        }
+        if (quitting.load(std::memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Plays a position out with the greedy policy.
+ * @param bits The packed position.
+ * @param current The generation of the position; the rollout is abandoned when it changes.
+ * @param rng The worker's random generator.
+ * @param reached Receives true for each target tile the rollout reached.
+ * @return True if the rollout finished, false if it was abandoned.
+ */
+bool WinEstimator2048::rollout(uint64_t bits, uint32_t current, Rng2048 &rng, bool reached[TargetCount]) const
+{
+    const int lastTarget = FirstTargetExponent + TargetCount - 1;
+    Board2048 board(bits);
+    int maxExponent = std::countr_zero(static_cast<unsigned>(board.maxTile()) | 1);
+    while (maxExponent < lastTarget) {
+        if (generation.load(std::memory_order_relaxed) != current) {
+            return false;
+        }
+
+        Greedy2048::Move move;
+        if (!Greedy2048::choose(bits, move, network)) {
+            break;
+        }
+
+        // A new largest tile scores at least its own value, so most moves skip the scan
+        if (move.addedScore >= (2 << maxExponent)) {
+            maxExponent = std::max(maxExponent, std::countr_zero(static_cast<unsigned>(Board2048(move.afterstate).maxTile()) | 1));
+        }
+        board = Board2048(move.afterstate);
+        board.spawnTile(rng);
+        bits = board.bits();
+    }
+
+    for (int t = 0; t < TargetCount; ++t) {
+        reached[t] = maxExponent >= FirstTargetExponent + t;
+    }
+    return true;
+}
+
+/**
+ * @brief Adds the counts of a batch to the shared counters.
+ * @param forGeneration The generation the batch was played for.
+ * @param batch The counts of the batch.
+ * @return True if the counts were added, false if the position changed meanwhile.
+ */
+bool WinEstimator2048::publish(uint32_t forGeneration, const Estimate &batch)
+{
+    // Rollouts first, so a reader that sees a target count also sees the rollouts behind it
+    qint64 amounts[CounterCount] = { batch.rollouts };
+    for (int t = 0; t < TargetCount; ++t) {
+        amounts[1 + t] = batch.reached[t];
+    }
+    for (int c = 0; c < CounterCount; ++c) {
+        uint64_t value = counters[c].load(std::memory_order_relaxed);
+        do {
+            if ((value >> CountBits) != (tag(forGeneration) >> CountBits)) {
+                return false;
+            }
+        } while (!counters[c].compare_exchange_weak(value, value + static_cast<uint64_t>(amounts[c]),
+                                                    std::memory_order_release, std::memory_order_relaxed));
+    }
+    return true;
+}
+
+/**
+ * @brief Reads the shared counters if they belong to a generation.
+ * @param forGeneration The generation.
+ * @param counts Receives the counts.
+ * @return True if the counters belong to that generation, false otherwise.
+ */
+bool WinEstimator2048::read(uint32_t forGeneration, Estimate &counts) const
+{
+    const uint64_t countMask = (1ULL << CountBits) - 1;
+    uint64_t values[CounterCount];
+    for (int c = CounterCount - 1; c >= 0; --c) {
+        values[c] = counters[c].load(std::memory_order_acquire);
+        if ((values[c] >> CountBits) != (tag(forGeneration) >> CountBits)) {
+            return false;
+        }
+    }
+    counts.rollouts = static_cast<qint64>(values[0] & countMask);
+    for (int t = 0; t < TargetCount; ++t) {
+        counts.reached[t] = static_cast<qint64>(values[1 + t] & countMask);
+    }
+    return true;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file winestimator2048.h
+ * @brief Declares the WinEstimator2048 class, a background Monte Carlo estimate of the chance to win.
+ *
+ * Worker threads play the current position out again and again with the AI's one-move greedy
+ * policy and count how many rollouts reach a 2048 and a 4096 tile. The workers are started once
+ * and sleep on a semaphore while there is nothing to do, so a new position costs the GUI thread a
+ * few atomic stores and no allocation. The workers run at low priority so the GUI preempts them, and
+ * setPaused() lets them sleep without dropping the counts while the AI needs the cores.
+ *
+ * Every position gets a new generation number. The shared counters carry the generation in their
+ * top bits, so a worker still playing an old position can never add to the counts of the new one:
+ * its compare-and-swap fails and the stale work is dropped.
+ */
+#ifndef WINESTIMATOR2048_H
+#define WINESTIMATOR2048_H
+
+#include <QSemaphore>
+#include <QThreadPool>
+#include <atomic>
+#include <cstdint>
+#include "board2048.h"
+#include "ntuple2048.h"
+#include "rng2048.h"
+
+/**
+ * @class WinEstimator2048
+ * @brief The WinEstimator2048 class estimates the chance to reach 2048 and 4096 from a position.
+ */
+class WinEstimator2048 {
+public:
+    static constexpr int TargetCount = 2;              ///< Number of tiles tracked.
+    static constexpr int FirstTargetExponent = 11;     ///< 2048, then each next target doubles.
+    static constexpr qint64 MaxRollouts = 1 << 16;     ///< Rollouts after which a position is done.
+
+    /**
+     * @brief Counts gathered for the current position.
+     */
+    struct Estimate {
+        qint64 rollouts = 0;                       ///< Finished rollouts.
+        qint64 reached[TargetCount] = {};          ///< Rollouts that reached each target tile.
+    };
+
+    /**
+     * @brief Constructs an idle estimator and starts its workers.
+     * @param threads The number of worker threads, or 0 for one per core.
+     */
+    explicit WinEstimator2048(int threads = 0);
+    /**
+     * @brief Stops and joins the workers.
+     */
+    ~WinEstimator2048();
+    WinEstimator2048(const WinEstimator2048 &) = delete;
+    WinEstimator2048 &operator=(const WinEstimator2048 &) = delete;
+
+    /**
+     * @brief Makes the rollouts pick moves with a trained network instead of the static heuristic.
+     *
+     * Must be called before the first start(). The network must outlive the estimator.
+     * @param evaluator The network, or nullptr for the heuristic.
+     */
+    void setEvaluator(const NTuple2048 *evaluator);
+    /**
+     * @brief Drops the counts and starts estimating a new position.
+     * @param board The position, with the player to move.
+     */
+    void start(const Board2048 &board);
+    /**
+     * @brief Drops the counts and lets the workers sleep.
+     */
+    void stop();
+    /**
+     * @brief Lets the workers sleep, keeping the counts, or wakes them again.
+     * @param pause True to pause the rollouts, false to resume them.
+     */
+    void setPaused(bool pause);
+    /**
+     * @brief Returns the counts gathered so far for the current position.
+     *
+     * Never waits for the workers; a count never exceeds the rollouts it is reported with.
+     * @return The counts, all 0 while stopped.
+     */
+    Estimate estimate() const;
+
+private:
+    static constexpr int CounterCount = 1 + TargetCount;    ///< Rollouts, then each target.
+    static constexpr int CountBits = 40;                    ///< Low bits of a counter holding the count.
+    static constexpr int BatchSize = 16;                    ///< Rollouts between two publishes.
+
+    /**
+     * @brief Tags an empty counter with a generation.
+     * @param generation The generation.
+     * @return The counter value.
+     */
+    static uint64_t tag(uint32_t generation) { return static_cast<uint64_t>(generation) << CountBits; }
+    /**
+     * @brief Runs rollouts whenever there is a position to estimate, until the estimator is destroyed.
+     * @param worker The index of the worker.
+     */
+    void work(int worker);
+    /**
+     * @brief Plays a position out with the greedy policy.
+     * @param bits The packed position.
+     * @param current The generation of the position; the rollout is abandoned when it changes.
+     * @param rng The worker's random generator.
+     * @param reached Receives true for each target tile the rollout reached.
+     * @return True if the rollout finished, false if it was abandoned.
+     */
+    bool rollout(uint64_t bits, uint32_t current, Rng2048 &rng, bool reached[TargetCount]) const;
+    /**
+     * @brief Adds the counts of a batch to the shared counters.
+     * @param forGeneration The generation the batch was played for.
+     * @param batch The counts of the batch.
+     * @return True if the counts were added, false if the position changed meanwhile.
+     */
+    bool publish(uint32_t forGeneration, const Estimate &batch);
+    /**
+     * @brief Reads the shared counters if they belong to a generation.
+     * @param forGeneration The generation.
+     * @param counts Receives the counts.
+     * @return True if the counters belong to that generation, false otherwise.
+     */
+    bool read(uint32_t forGeneration, Estimate &counts) const;
+
+    int workerCount;
+    const NTuple2048 *network = nullptr;
+    std::atomic<uint64_t> position{ 0 };
+    std::atomic<uint32_t> generation{ 0 };
+    std::atomic<bool> active{ false };
+    std::atomic<bool> paused{ false };
+    std::atomic<bool> quitting{ false };
+    std::atomic<uint64_t> counters[CounterCount];
+    QSemaphore wake;
+    QThreadPool pool;
+};
+
+#endif // WINESTIMATOR2048_H